@@ -0,0 +1,186 @@
+//
+// A simple container of columns (a structure of vectors) with joint iterators over its rows.
+//
+
+#ifndef JOINT_COLUMNS_HPP
+#define JOINT_COLUMNS_HPP
+
+#include <cstddef>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "joint_iterator.hpp"
+#include "joint_scratch.hpp"
+
+namespace joint
+{
+
+    namespace detail
+    {
+
+        // Functors applied to the tuple of column vectors.
+
+        struct vector_reserver
+        {
+            template<typename V> void operator()(V & v, std::size_t n) { v.reserve(n); }
+        };
+
+        struct vector_resizer
+        {
+            template<typename V> void operator()(V & v, std::size_t n) { v.resize(n); }
+        };
+
+        struct vector_clearer
+        {
+            template<typename V> void operator()(V & v) { v.clear(); }
+        };
+
+        template<typename T, typename F, size_t... Is>
+        auto make_iterators_impl(T & t, F f, sequence<Is...>)
+        -> decltype(std::make_tuple(f(std::get<Is>(t))...))
+        {
+            return std::make_tuple(f(std::get<Is>(t))...);
+        }
+
+        struct vector_begin
+        {
+            template<typename V> auto operator()(V & v) -> decltype(v.begin()) { return v.begin(); }
+        };
+
+        struct vector_end
+        {
+            template<typename V> auto operator()(V & v) -> decltype(v.end()) { return v.end(); }
+        };
+
+        template<typename V, typename... Args, size_t... Is>
+        void emplace_back_impl(V & vectors, sequence<Is...>, Args &&... args)
+        {
+            auto l = {(std::get<Is>(vectors).emplace_back(std::forward<Args>(args)), 0)...};
+            (void) l;
+        }
+
+    }
+
+    //! A container of equally long columns stored as separate vectors allocated by `Allocator<T>`.
+    //!
+    //! The rows can be traversed (and e.g. sorted) by the joint iterators returned by `begin()` and `end()`. Use
+    //! `columns<Ts...>` for the standard allocator and `resource_columns<Ts...>` for a memory resource (e.g., a
+    //! `huge_page_resource` for very large columns).
+    template<template<typename> class Allocator, typename... Ts>
+    class basic_columns
+    {
+        public:
+            typedef std::tuple<std::vector<Ts, Allocator<Ts>>...>                            vectors_type;
+            typedef joint::iterator<typename std::vector<Ts, Allocator<Ts>>::iterator...>    iterator;
+            typedef joint::iterator<typename std::vector<Ts, Allocator<Ts>>::const_iterator...>
+                                                                                            const_iterator;
+            typedef typename iterator::value_type                                            value_type;
+            typedef typename iterator::reference                                             reference;
+            typedef std::size_t                                                              size_type;
+
+        public:
+
+            //! Create empty columns.
+            basic_columns() = default;
+
+            //! Create `n` default initialized rows.
+            explicit basic_columns(size_type n) { resize(n); }
+
+            //! Create empty columns whose allocators are made of `allocator` (e.g., a memory resource).
+            template<typename A,
+                     typename = typename std::enable_if<!std::is_convertible<A, size_type>::value>::type>
+            explicit basic_columns(A const & allocator)
+                    : m_vectors(std::vector<Ts, Allocator<Ts>>(Allocator<Ts>(allocator))...) { }
+
+            //! Create `n` default initialized rows whose allocators are made of `allocator`.
+            template<typename A>
+            basic_columns(size_type n, A const & allocator)
+                    : basic_columns(allocator)
+            {
+                resize(n);
+            }
+
+            //! Create the columns from vectors (all of the same size).
+            explicit basic_columns(std::vector<Ts, Allocator<Ts>>... vectors)
+                    : m_vectors(std::move(vectors)...) { }
+
+            //! Number of rows.
+            size_type size() const { return std::get<0>(m_vectors).size(); }
+
+            //! Check whether there are no rows.
+            bool empty() const { return size() == 0; }
+
+            //! Reserve the storage for `n` rows in each column.
+            void reserve(size_type n) { detail::for_each_one_tuple(m_vectors, detail::vector_reserver(), n); }
+
+            //! Resize each column to `n` rows.
+            void resize(size_type n) { detail::for_each_one_tuple(m_vectors, detail::vector_resizer(), n); }
+
+            //! Remove all the rows.
+            void clear() { detail::for_each_one_tuple(m_vectors, detail::vector_clearer()); }
+
+            //! Append a row given by one value per column.
+            template<typename... Args>
+            void emplace_back(Args &&... args)
+            {
+                static_assert(sizeof...(Args) == sizeof...(Ts), "One value per column is required.");
+                detail::emplace_back_impl(m_vectors, detail::generate_sequence<sizeof...(Ts)>(),
+                                          std::forward<Args>(args)...);
+            }
+
+            //! Joint iterator to the first row.
+            iterator begin()
+            {
+                return iterator(detail::make_iterators_impl(m_vectors, detail::vector_begin(),
+                                                            detail::generate_sequence<sizeof...(Ts)>()));
+            }
+
+            //! Joint iterator past the last row.
+            iterator end()
+            {
+                return iterator(detail::make_iterators_impl(m_vectors, detail::vector_end(),
+                                                            detail::generate_sequence<sizeof...(Ts)>()));
+            }
+
+            //! Joint iterator to the first row.
+            const_iterator begin() const
+            {
+                return const_iterator(detail::make_iterators_impl(m_vectors, detail::vector_begin(),
+                                                                  detail::generate_sequence<sizeof...(Ts)>()));
+            }
+
+            //! Joint iterator past the last row.
+            const_iterator end() const
+            {
+                return const_iterator(detail::make_iterators_impl(m_vectors, detail::vector_end(),
+                                                                  detail::generate_sequence<sizeof...(Ts)>()));
+            }
+
+            //! Reference to the `i`-th row.
+            reference operator[](size_type i) { return * (begin() + i); }
+
+            //! Get the I-th column.
+            template<size_t I>
+            typename std::tuple_element<I, vectors_type>::type & get() { return std::get<I>(m_vectors); }
+
+            //! Get the I-th column.
+            template<size_t I>
+            typename std::tuple_element<I, vectors_type>::type const & get() const { return std::get<I>(m_vectors); }
+
+        private:
+            vectors_type m_vectors;
+    };
+
+    //! Columns allocated by the standard allocator.
+    template<typename... Ts>
+    using columns = basic_columns<std::allocator, Ts...>;
+
+    //! Columns allocated from a memory resource (given to the constructor).
+    template<typename... Ts>
+    using resource_columns = basic_columns<scratch_allocator, Ts...>;
+
+} // namespace joint
+
+#endif //JOINT_COLUMNS_HPP
@@ -0,0 +1,325 @@
+//
+// Concurrent appending of rows into columns by multiple producer threads.
+//
+
+#ifndef JOINT_CONCURRENT_HPP
+#define JOINT_CONCURRENT_HPP
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "joint_iterator.hpp"
+#include "joint_parallel.hpp"
+#include "joint_scratch.hpp"
+
+namespace joint
+{
+
+    namespace detail
+    {
+
+        //! Number of rows per chunk of the storage faulted in (constructed) by one task.
+        constexpr std::size_t fault_grain = 65536;
+
+        template<typename Ts, typename... Args, size_t... Is>
+        void store_row_impl(Ts const & data, std::size_t row, sequence<Is...>, Args &&... args)
+        {
+            auto l = {(std::get<Is>(data)[row] = std::forward<Args>(args), 0)...};
+            (void) l;
+        }
+
+        //! Destroy the elements `[b, e)` of an array.
+        template<typename T>
+        void destroy_range(T * data, std::size_t b, std::size_t e)
+        {
+            for (std::size_t i = b; i < e; ++i) data[i].~T();
+        }
+
+        //! Value initialize the elements `[b, e)` of an uninitialized array (none of them if a constructor throws).
+        template<typename T>
+        void construct_range(T * data, std::size_t b, std::size_t e)
+        {
+            std::size_t i = b;
+            try
+            {
+                for (; i < e; ++i) ::new (static_cast<void *>(data + i)) T();
+            }
+            catch (...)
+            {
+                destroy_range(data, b, i);
+                throw;
+            }
+        }
+
+        template<typename Ts, typename Iterator, size_t... Is>
+        void copy_row_impl(Ts const & data, std::size_t row, Iterator const & it, sequence<Is...>)
+        {
+            auto l = {(std::get<Is>(data)[row] = * it.template get<Is>(), 0)...};
+            (void) l;
+        }
+
+    }
+
+    //! Columns of a fixed capacity appended by many producer threads at once.
+    //!
+    //! A producer claims a range of consecutive rows by a single atomic `fetch_add` on the row counter and then
+    //! writes the columns of its rows directly (no lock is taken and no two producers share a row). The storage of
+    //! each column is allocated for the whole capacity and constructed (thus faulted in) chunk by chunk according
+    //! to the policy of the constructor, so it never moves while being written (the pages are faulted in by the
+    //! threads of the policy, not by the producers which write the rows later). Once all the producers are done,
+    //! `seal()` makes the claimed rows a joint range of raw pointers which the other algorithms (e.g., `sort()`)
+    //! work on in place.
+    template<typename... Ts>
+    class concurrent_columns
+    {
+        public:
+            typedef joint::iterator<Ts *...>          iterator;
+            typedef joint::iterator<Ts const *...>    const_iterator;
+            typedef typename iterator::value_type     value_type;
+            typedef typename iterator::reference      reference;
+            typedef std::size_t                       size_type;
+
+            //! Returned by `claim()` if the rows do not fit into the capacity.
+            static constexpr size_type npos = static_cast<size_type>(-1);
+
+        public:
+
+            //! Create the columns of `capacity` value initialized rows (initialized in parallel).
+            explicit concurrent_columns(size_type capacity, memory_resource * resource = default_resource())
+                    : concurrent_columns(par, capacity, resource) { }
+
+            //! Create the columns of `capacity` value initialized rows (initialized according to the policy).
+            //!
+            //! If a constructor of the elements throws, the constructed elements are destroyed and the storage is
+            //! released before the exception is rethrown.
+            template<typename Policy>
+            concurrent_columns(Policy const & policy, size_type capacity,
+                               memory_resource * resource = default_resource())
+                    : m_resource(resource), m_capacity(capacity), m_claimed(0), m_limit(capacity), m_size(0),
+                      m_sealed(false)
+            {
+                allocate(detail::generate_sequence<sizeof...(Ts)>());
+
+                // The chunks constructed completely (a failing chunk destroys its own elements).
+                std::size_t const             chunks = detail::chunk_count(policy, capacity, detail::fault_grain);
+                scratch_vector<unsigned char> constructed{scratch_allocator<unsigned char>(resource)};
+                try
+                {
+                    constructed.resize(chunks, 0);
+                    detail::for_each_chunk(policy, chunks, [&](std::size_t c)
+                    {
+                        construct(detail::chunk_begin(c, chunks, capacity),
+                                  detail::chunk_begin(c + 1, chunks, capacity),
+                                  detail::generate_sequence<sizeof...(Ts)>());
+                        constructed[c] = 1;
+                    });
+                }
+                catch (...)
+                {
+                    for (std::size_t c = 0; c < constructed.size(); ++c)
+                        if (constructed[c])
+                            destroy(detail::chunk_begin(c, chunks, capacity),
+                                    detail::chunk_begin(c + 1, chunks, capacity),
+                                    detail::generate_sequence<sizeof...(Ts)>());
+                    release(detail::generate_sequence<sizeof...(Ts)>());
+                    throw;
+                }
+            }
+
+            concurrent_columns(concurrent_columns const &) = delete;
+            concurrent_columns & operator=(concurrent_columns const &) = delete;
+
+            ~concurrent_columns()
+            {
+                destroy(0, m_capacity, detail::generate_sequence<sizeof...(Ts)>());
+                release(detail::generate_sequence<sizeof...(Ts)>());
+            }
+
+            //! Maximal number of rows.
+            size_type capacity() const { return m_capacity; }
+
+            //! Claim `n` consecutive rows for the calling thread and return the index of the first one (or `npos`
+            //! if they do not fit, the claims fitting into the capacity are not affected). The rows are written
+            //! through `data<I>()` or `at()`.
+            size_type claim(size_type n)
+            {
+                assert(!m_sealed);
+
+                size_type const first = m_claimed.fetch_add(n, std::memory_order_relaxed);
+                if (first + n <= m_capacity) return first;
+
+                // The later claims start past this one, hence the rows before it are the only ones claimed.
+                size_type limit = m_limit.load(std::memory_order_relaxed);
+                while (first < limit && !m_limit.compare_exchange_weak(limit, first, std::memory_order_relaxed)) { }
+                return npos;
+            }
+
+            //! Append a row given by one value per column (returns its index or `npos` if the columns are full).
+            template<typename... Args>
+            size_type push_back(Args &&... args)
+            {
+                static_assert(sizeof...(Args) == sizeof...(Ts), "One value per column is required.");
+
+                size_type const row = claim(1);
+                if (row != npos)
+                    detail::store_row_impl(m_data, row, detail::generate_sequence<sizeof...(Ts)>(),
+                                            std::forward<Args>(args)...);
+                return row;
+            }
+
+            //! Append the rows of a joint range (returns the index of the first one or `npos` if they do not fit).
+            template<typename... Iterators>
+            size_type append(joint::iterator<Iterators...> first, joint::iterator<Iterators...> last)
+            {
+                static_assert(sizeof...(Iterators) == sizeof...(Ts), "One iterator per column is required.");
+
+                size_type const n = last - first, row = claim(n);
+                if (row == npos) return npos;
+
+                for (size_type i = 0; i < n; ++i, ++first)
+                    detail::copy_row_impl(m_data, row + i, first, detail::generate_sequence<sizeof...(Ts)>());
+                return row;
+            }
+
+            //! The I-th column (of `capacity()` rows).
+            template<size_t I>
+            typename std::tuple_element<I, std::tuple<Ts *...>>::type data() const { return std::get<I>(m_data); }
+
+            //! Joint iterator to the `i`-th row (for writing the claimed rows).
+            iterator at(size_type i) const
+            {
+                iterator it(m_data);
+                return it + i;
+            }
+
+            //! Finish the appending and return the number of the claimed rows.
+            //!
+            //! It must be called after all the producers finished writing their rows (e.g., after joining their
+            //! threads, which makes the rows visible to the calling thread), no rows can be claimed afterwards.
+            size_type seal()
+            {
+                if (!m_sealed)
+                {
+                    size_type const claimed = m_claimed.load(std::memory_order_relaxed);
+                    size_type const limit   = m_limit.load(std::memory_order_relaxed);
+                    m_size   = claimed < limit ? claimed : limit;
+                    m_sealed = true;
+                }
+                return m_size;
+            }
+
+            //! Check whether the columns have been sealed.
+            bool sealed() const { return m_sealed; }
+
+            //! Number of the rows (once sealed).
+            size_type size() const
+            {
+                assert(m_sealed);
+                return m_size;
+            }
+
+            //! Joint iterator to the first row (once sealed).
+            iterator begin()
+            {
+                assert(m_sealed);
+                return iterator(m_data);
+            }
+
+            //! Joint iterator past the last row (once sealed).
+            iterator end()
+            {
+                assert(m_sealed);
+                return at(m_size);
+            }
+
+            //! Joint iterator to the first row (once sealed).
+            const_iterator begin() const
+            {
+                assert(m_sealed);
+                return const_iterator(std::tuple<Ts const *...>(m_data));
+            }
+
+            //! Joint iterator past the last row (once sealed).
+            const_iterator end() const
+            {
+                assert(m_sealed);
+                const_iterator it = begin();
+                return it + m_size;
+            }
+
+        private:
+
+            //! Allocate the storage of the columns (releasing the allocated columns if an allocation fails).
+            template<size_t... Is>
+            void allocate(detail::sequence<Is...>)
+            {
+                auto n = {(std::get<Is>(m_data) = nullptr, 0)...};
+                (void) n;
+                try
+                {
+                    auto l = {(std::get<Is>(m_data) = static_cast<Ts *>(
+                            m_resource->allocate(m_capacity * sizeof(Ts), alignof(Ts))), 0)...};
+                    (void) l;
+                }
+                catch (...)
+                {
+                    release(detail::sequence<Is...>());
+                    throw;
+                }
+            }
+
+            //! Construct the rows `[b, e)` of the columns (none of them if a constructor throws).
+            template<size_t... Is>
+            void construct(std::size_t b, std::size_t e, detail::sequence<Is...>)
+            {
+                std::size_t columns = 0;
+                try
+                {
+                    auto l = {(detail::construct_range(std::get<Is>(m_data), b, e), ++columns)...};
+                    (void) l;
+                }
+                catch (...)
+                {
+                    auto l = {(Is < columns ? detail::destroy_range(std::get<Is>(m_data), b, e) : void(), 0)...};
+                    (void) l;
+                    throw;
+                }
+            }
+
+            //! Destroy the rows `[b, e)` of the columns.
+            template<size_t... Is>
+            void destroy(std::size_t b, std::size_t e, detail::sequence<Is...>)
+            {
+                auto l = {(detail::destroy_range(std::get<Is>(m_data), b, e), 0)...};
+                (void) l;
+            }
+
+            //! Release the storage of the allocated columns.
+            template<size_t... Is>
+            void release(detail::sequence<Is...>)
+            {
+                auto l = {(std::get<Is>(m_data) ? m_resource->deallocate(std::get<Is>(m_data), m_capacity * sizeof(Ts),
+                                                                          alignof(Ts)) : void(), 0)...};
+                (void) l;
+            }
+
+            memory_resource        * m_resource;
+            std::tuple<Ts *...>      m_data;
+            size_type                m_capacity;
+            std::atomic<size_type>   m_claimed;
+            std::atomic<size_type>   m_limit;   // the first row of the first claim not fitting into the capacity
+            size_type                m_size;
+            bool                     m_sealed;
+    };
+
+    template<typename... Ts>
+    constexpr typename concurrent_columns<Ts...>::size_type concurrent_columns<Ts...>::npos;
+
+} // namespace joint
+
+#endif //JOINT_CONCURRENT_HPP
@@ -0,0 +1,614 @@
+//
+// Joint ranges of columns whose types are known at runtime only.
+//
+
+#ifndef JOINT_DYNAMIC_HPP
+#define JOINT_DYNAMIC_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "joint_iterator.hpp"
+#include "joint_observer.hpp"
+#include "joint_scratch.hpp"
+
+namespace joint
+{
+
+    namespace detail
+    {
+
+        template<typename T, typename = void>
+        struct is_less_comparable : std::false_type
+        {
+        };
+
+        template<typename T>
+        struct is_less_comparable<T, decltype(void(std::declval<T const &>() < std::declval<T const &>()))>
+                : std::true_type
+        {
+        };
+
+        // The operations of the column types on untyped pointers.
+
+        template<typename T> void move_construct_thunk(void * p, void * q)
+        {
+            ::new (p) T(std::move(* static_cast<T *>(q)));
+        }
+
+        template<typename T> void move_assign_thunk(void * p, void * q)
+        {
+            * static_cast<T *>(p) = std::move(* static_cast<T *>(q));
+        }
+
+        template<typename T> void destroy_thunk(void * p) { static_cast<T *>(p)->~T(); }
+
+        template<typename T> void copy_construct_thunk(void * p, void const * q)
+        {
+            ::new (p) T(* static_cast<T const *>(q));
+        }
+
+        template<typename T>
+        void (* copy_construct_of(std::true_type))(void *, void const *) { return & copy_construct_thunk<T>; }
+
+        template<typename T>
+        void (* copy_construct_of(std::false_type))(void *, void const *) { return nullptr; }
+
+        //! Stable sort of the indices `[first, last)` by the keys they point to.
+        template<typename T>
+        void sort_indices_thunk(void const * keys, std::size_t * first, std::size_t * last)
+        {
+            T const * k = static_cast<T const *>(keys);
+            std::stable_sort(first, last, [k](std::size_t a, std::size_t b) { return k[a] < k[b]; });
+        }
+
+        template<typename T>
+        void (* sort_indices_of(std::true_type))(void const *, std::size_t *, std::size_t *)
+        {
+            return & sort_indices_thunk<T>;
+        }
+
+        template<typename T>
+        void (* sort_indices_of(std::false_type))(void const *, std::size_t *, std::size_t *) { return nullptr; }
+
+    }
+
+    //! A runtime description of the type of the entries of a column.
+    //!
+    //! Besides the size and the alignment, it holds the operations needed to move, copy and order the entries
+    //! through untyped pointers. The copy and the ordering are null if the type is not copyable or comparable
+    //! by `<`, respectively. The trivially copyable entries are moved by `std::memcpy` instead, as are the trivially
+    //! relocatable ones when the storage grows or is permuted.
+    struct column_type
+    {
+        std::size_t size;
+        std::size_t alignment;
+        bool        trivial;
+        bool        relocatable;
+
+        void (* move_construct)(void * target, void * source);
+        void (* move_assign)(void * target, void * source);
+        void (* destroy)(void * p);
+        void (* copy_construct)(void * target, void const * source);
+
+        //! Stable sort of the indices by the keys they point to (in the array of the entries at `keys`).
+        void (* sort_indices)(void const * keys, std::size_t * first, std::size_t * last);
+
+        //! The description of the type `T` (there is a single instance per type).
+        template<typename T>
+        static column_type const * of()
+        {
+            static column_type const type = {
+                    sizeof(T), alignof(T), std::is_trivially_copyable<T>::value, is_trivially_relocatable<T>::value,
+                    & detail::move_construct_thunk<T>, & detail::move_assign_thunk<T>, & detail::destroy_thunk<T>,
+                    detail::copy_construct_of<T>(std::is_copy_constructible<T>()),
+                    detail::sort_indices_of<T>(detail::is_less_comparable<T>())
+            };
+            return & type;
+        }
+    };
+
+    //! A column of entries of a type known at runtime (see `column_type`) in a contiguous storage.
+    class dynamic_column
+    {
+        public:
+
+            //! Create an empty column of the given type (the storage is taken from `resource`).
+            explicit dynamic_column(column_type const * type, memory_resource * resource = default_resource())
+                    : m_type(type), m_resource(resource), m_data(nullptr), m_size(0), m_capacity(0) { }
+
+            dynamic_column(dynamic_column && other) noexcept
+                    : m_type(other.m_type), m_resource(other.m_resource), m_data(other.m_data),
+                      m_size(other.m_size), m_capacity(other.m_capacity)
+            {
+                other.m_data     = nullptr;
+                other.m_size     = 0;
+                other.m_capacity = 0;
+            }
+
+            dynamic_column(dynamic_column const &) = delete;
+            dynamic_column & operator=(dynamic_column const &) = delete;
+            dynamic_column & operator=(dynamic_column &&) = delete;
+
+            ~dynamic_column()
+            {
+                clear();
+                if (m_data) m_resource->deallocate(m_data, m_capacity * m_type->size, m_type->alignment);
+            }
+
+            //! Type of the entries.
+            column_type const * type() const { return m_type; }
+
+            //! Number of the entries.
+            std::size_t size() const { return m_size; }
+
+            //! Address of the `i`-th entry.
+            void * at(std::size_t i) { return m_data + i * m_type->size; }
+
+            //! Address of the `i`-th entry.
+            void const * at(std::size_t i) const { return m_data + i * m_type->size; }
+
+            //! The entries as an array of `T` (which must be the type of the column).
+            template<typename T> T * data()
+            {
+                assert(m_type == column_type::of<T>());
+                return reinterpret_cast<T *>(m_data);
+            }
+
+            //! The entries as an array of `T` (which must be the type of the column).
+            template<typename T> T const * data() const
+            {
+                assert(m_type == column_type::of<T>());
+                return reinterpret_cast<T const *>(m_data);
+            }
+
+            //! Reserve the storage for `n` entries (the column keeps its storage if a move throws).
+            void reserve(std::size_t n)
+            {
+                if (n <= m_capacity) return;
+
+                char * data = static_cast<char *>(m_resource->allocate(n * m_type->size, m_type->alignment));
+                try
+                {
+                    relocate(data, m_data, m_size);
+                }
+                catch (...)
+                {
+                    m_resource->deallocate(data, n * m_type->size, m_type->alignment);
+                    throw;
+                }
+                if (m_data) m_resource->deallocate(m_data, m_capacity * m_type->size, m_type->alignment);
+
+                m_data     = data;
+                m_capacity = n;
+            }
+
+            //! Append an entry (of the type of the column).
+            template<typename T>
+            void push_back(T && value)
+            {
+                typedef typename std::decay<T>::type type;
+                assert(m_type == column_type::of<type>());
+
+                if (m_size == m_capacity) reserve(std::max<std::size_t>(2 * m_capacity, 16));
+                ::new (at(m_size)) type(std::forward<T>(value));
+                ++m_size;
+            }
+
+            //! Append a copy of an entry given by its address.
+            void push_back_copy(void const * value)
+            {
+                assert(m_type->copy_construct);
+
+                if (m_size == m_capacity) reserve(std::max<std::size_t>(2 * m_capacity, 16));
+                if (m_type->trivial) std::memcpy(at(m_size), value, m_type->size);
+                else m_type->copy_construct(at(m_size), value);
+                ++m_size;
+            }
+
+            //! Append `n` uninitialized entries (of a trivially copyable type) and return the address of the first one.
+            void * append_trivial(std::size_t n)
+            {
+                assert(m_type->trivial);
+
+                if (m_size + n > m_capacity) reserve(std::max<std::size_t>(2 * m_capacity, m_size + n));
+                void * p = at(m_size);
+                m_size += n;
+                return p;
+            }
+
+            //! Remove all the entries.
+            void clear()
+            {
+                if (!m_type->trivial)
+                    for (std::size_t i = 0; i < m_size; ++i) m_type->destroy(at(i));
+                m_size = 0;
+            }
+
+            //! Move the `n` entries at `source` into the uninitialized storage at `target`.
+            //!
+            //! The source entries are destroyed once all of them are moved. If a move throws, the entries moved to
+            //! the target are destroyed and the source entries are left (valid, but some of them moved from).
+            void relocate(void * target, void * source, std::size_t n) const
+            {
+                if (n == 0) return;
+                if (m_type->relocatable)
+                {
+                    std::memcpy(target, source, n * m_type->size);
+                    return;
+                }
+
+                char * const      t = static_cast<char *>(target);
+                char * const      u = static_cast<char *>(source);
+                std::size_t const s = m_type->size;
+                std::size_t       i = 0;
+                try
+                {
+                    for (; i < n; ++i) m_type->move_construct(t + i * s, u + i * s);
+                }
+                catch (...)
+                {
+                    for (std::size_t j = 0; j < i; ++j) m_type->destroy(t + j * s);
+                    throw;
+                }
+                for (i = 0; i < n; ++i) m_type->destroy(u + i * s);
+            }
+
+            //! Memory resource of the storage.
+            memory_resource * resource() const { return m_resource; }
+
+        private:
+            column_type const * m_type;
+            memory_resource   * m_resource;
+            char              * m_data;
+            std::size_t         m_size;
+            std::size_t         m_capacity;
+    };
+
+    //! A table of columns of the types known at runtime only (e.g., given by a configuration).
+    //!
+    //! Unlike `joint::columns<Ts...>`, the number and the types of the columns are not template arguments, hence
+    //! the algorithms below are instantiated once for all the schemas. They work column by column through the
+    //! entry sizes (trivially copyable entries of 1, 2, 4, 8 and 16 bytes are moved as such) and the operations of
+    //! `column_type`.
+    class dynamic_columns
+    {
+        public:
+
+            //! A row of the table (a proxy to the entries).
+            class reference
+            {
+                public:
+                    reference(dynamic_columns * table, std::size_t row)
+                            : m_table(table), m_row(row) { }
+
+                    //! The entry in the given column (of the type `T`).
+                    template<typename T>
+                    T & get(std::size_t column) const { return m_table->column(column).data<T>()[m_row]; }
+
+                    //! Index of the row.
+                    std::size_t row() const { return m_row; }
+
+                private:
+                    dynamic_columns * m_table;
+                    std::size_t       m_row;
+            };
+
+            //! Random access iterator over the rows (a proxy delimiting the ranges for the algorithms below).
+            class iterator
+            {
+                public:
+                    typedef std::random_access_iterator_tag iterator_category;
+                    typedef void                            value_type;
+                    typedef std::ptrdiff_t                  difference_type;
+                    typedef void                            pointer;
+                    typedef dynamic_columns::reference      reference;
+
+                    iterator()
+                            : m_table(nullptr), m_row(0) { }
+
+                    iterator(dynamic_columns * table, std::size_t row)
+                            : m_table(table), m_row(row) { }
+
+                    reference operator*() const { return reference(m_table, m_row); }
+                    reference operator[](difference_type n) const { return reference(m_table, m_row + n); }
+
+                    iterator & operator++()
+                    {
+                        ++m_row;
+                        return * this;
+                    }
+
+                    iterator & operator--()
+                    {
+                        --m_row;
+                        return * this;
+                    }
+
+                    iterator operator++(int) { return iterator(m_table, m_row++); }
+                    iterator operator--(int) { return iterator(m_table, m_row--); }
+
+                    iterator & operator+=(difference_type n)
+                    {
+                        m_row += n;
+                        return * this;
+                    }
+
+                    iterator & operator-=(difference_type n)
+                    {
+                        m_row -= n;
+                        return * this;
+                    }
+
+                    iterator operator+(difference_type n) const { return iterator(m_table, m_row + n); }
+                    iterator operator-(difference_type n) const { return iterator(m_table, m_row - n); }
+
+                    difference_type operator-(iterator const & other) const
+                    {
+                        return static_cast<difference_type>(m_row) - static_cast<difference_type>(other.m_row);
+                    }
+
+                    bool operator==(iterator const & other) const { return m_row == other.m_row; }
+                    bool operator!=(iterator const & other) const { return m_row != other.m_row; }
+                    bool operator<(iterator const & other) const { return m_row < other.m_row; }
+                    bool operator>(iterator const & other) const { return m_row > other.m_row; }
+                    bool operator<=(iterator const & other) const { return m_row <= other.m_row; }
+                    bool operator>=(iterator const & other) const { return m_row >= other.m_row; }
+
+                    //! The table of the rows.
+                    dynamic_columns * table() const { return m_table; }
+
+                    //! Index of the row.
+                    std::size_t row() const { return m_row; }
+
+                private:
+                    dynamic_columns * m_table;
+                    std::size_t       m_row;
+            };
+
+        public:
+
+            //! Create an empty table without columns (the storage is taken from `resource`).
+            explicit dynamic_columns(memory_resource * resource = default_resource())
+                    : m_resource(resource) { }
+
+            //! Create an empty table with columns of the given types.
+            explicit dynamic_columns(std::vector<column_type const *> const & types,
+                                     memory_resource * resource = default_resource())
+                    : m_resource(resource)
+            {
+                for (auto type : types) add_column(type);
+            }
+
+            //! Add a column of the given type (the table must be empty).
+            void add_column(column_type const * type)
+            {
+                assert(size() == 0);
+                m_columns.push_back(dynamic_column(type, m_resource));
+            }
+
+            //! Add a column of the type `T` (the table must be empty).
+            template<typename T> void add_column() { add_column(column_type::of<T>()); }
+
+            //! Number of the columns.
+            std::size_t column_count() const { return m_columns.size(); }
+
+            //! The `i`-th column.
+            dynamic_column & column(std::size_t i) { return m_columns[i]; }
+
+            //! The `i`-th column.
+            dynamic_column const & column(std::size_t i) const { return m_columns[i]; }
+
+            //! Types of the columns.
+            std::vector<column_type const *> types() const
+            {
+                std::vector<column_type const *> types;
+                for (auto & c : m_columns) types.push_back(c.type());
+                return types;
+            }
+
+            //! Number of rows (all the columns must be of the same size).
+            std::size_t size() const { return m_columns.empty() ? 0 : m_columns.front().size(); }
+
+            //! Check whether there are no rows.
+            bool empty() const { return size() == 0; }
+
+            //! Reserve the storage for `n` rows in each column.
+            void reserve(std::size_t n) { for (auto & c : m_columns) c.reserve(n); }
+
+            //! Remove all the rows.
+            void clear() { for (auto & c : m_columns) c.clear(); }
+
+            //! Iterator to the first row.
+            iterator begin() { return iterator(this, 0); }
+
+            //! Iterator past the last row.
+            iterator end() { return iterator(this, size()); }
+
+            //! The `i`-th row.
+            reference operator[](std::size_t i) { return reference(this, i); }
+
+            //! Memory resource of the columns.
+            memory_resource * resource() const { return m_resource; }
+
+        private:
+            memory_resource           * m_resource;
+            std::vector<dynamic_column> m_columns;
+    };
+
+    namespace detail
+    {
+
+        //! Gather the entries of the fixed size `W` bytewise.
+        template<std::size_t W, typename IndexIterator>
+        void gather_fixed(char * target, char const * source, IndexIterator indices, std::size_t n)
+        {
+            for (std::size_t i = 0; i < n; ++i) std::memcpy(target + i * W, source + indices[i] * W, W);
+        }
+
+        //! Gather the entries `target[i] = source[indices[i]]` bytewise (of `width` bytes each).
+        template<typename IndexIterator>
+        void gather_trivial(char * target, char const * source, std::size_t width, IndexIterator indices,
+                            std::size_t n)
+        {
+            switch (width)
+            {
+                case 1:  gather_fixed<1>(target, source, indices, n); break;
+                case 2:  gather_fixed<2>(target, source, indices, n); break;
+                case 4:  gather_fixed<4>(target, source, indices, n); break;
+                case 8:  gather_fixed<8>(target, source, indices, n); break;
+                case 16: gather_fixed<16>(target, source, indices, n); break;
+                default:
+                    for (std::size_t i = 0; i < n; ++i)
+                        std::memcpy(target + i * width, source + indices[i] * width, width);
+            }
+        }
+
+        //! Permute the `n` entries of a column from the row `offset` (the `i`-th becomes the `permutation[i]`-th one).
+        //!
+        //! If a move throws, the buffered entries are destroyed and the buffer is released (the entries of the column
+        //! are left valid, but in an unspecified order and some of them moved from).
+        template<typename IndexIterator>
+        void permute_column(dynamic_column & column, std::size_t offset, std::size_t n, IndexIterator permutation,
+                            memory_resource * resource)
+        {
+            column_type const & type   = * column.type();
+            std::size_t const   s      = type.size;
+            char              * data   = static_cast<char *>(column.at(offset));
+            char              * buffer = static_cast<char *>(resource->allocate(n * s, type.alignment));
+
+            if (type.relocatable)
+            {
+                gather_trivial(buffer, data, s, permutation, n);
+                std::memcpy(data, buffer, n * s);
+            }
+            else
+            {
+                std::size_t built = 0;
+                try
+                {
+                    for (; built < n; ++built) type.move_construct(buffer + built * s, data + permutation[built] * s);
+                    for (std::size_t i = 0; i < n; ++i) type.move_assign(data + i * s, buffer + i * s);
+                }
+                catch (...)
+                {
+                    for (std::size_t i = 0; i < built; ++i) type.destroy(buffer + i * s);
+                    resource->deallocate(buffer, n * s, type.alignment);
+                    throw;
+                }
+                for (std::size_t i = 0; i < n; ++i) type.destroy(buffer + i * s);
+            }
+
+            resource->deallocate(buffer, n * s, type.alignment);
+        }
+
+        //! Number of bytes of a row of the table.
+        inline std::size_t table_row_bytes(dynamic_columns const & table)
+        {
+            std::size_t bytes = 0;
+            for (std::size_t c = 0; c < table.column_count(); ++c) bytes += table.column(c).type()->size;
+            return bytes;
+        }
+
+    }
+
+    //! Permute the rows of a dynamic range such that the `i`-th row becomes the `permutation[i]`-th original one.
+    template<typename IndexIterator>
+    void permute(dynamic_columns::iterator first, dynamic_columns::iterator last, IndexIterator permutation,
+                 memory_resource * resource = default_resource())
+    {
+        dynamic_columns & table = * first.table();
+        phase_timer       timer(phase::permutation, last - first, (last - first) * detail::table_row_bytes(table));
+
+        for (std::size_t c = 0; c < table.column_count(); ++c)
+            detail::permute_column(table.column(c), first.row(), last - first, permutation, resource);
+    }
+
+    //! Sort a dynamic range according to the given column (stable).
+    //!
+    //! The type of the key column must be comparable by `<`. The indices of the rows are sorted by a single call
+    //! through the type of the column (hence the comparisons are not type-erased) and the rows are permuted
+    //! afterwards column by column.
+    inline void sort_by(dynamic_columns::iterator first, dynamic_columns::iterator last, std::size_t key,
+                        memory_resource * resource = default_resource())
+    {
+        std::size_t const n = last - first;
+        if (n < 2) return;
+
+        dynamic_column & column = first.table()->column(key);
+        assert(column.type()->sort_indices);
+
+        scratch_vector<std::size_t> permutation(n, 0, scratch_allocator<std::size_t>(resource));
+        for (std::size_t i = 0; i < n; ++i) permutation[i] = i;
+
+        {
+            phase_timer timer(phase::sort, n);
+            column.type()->sort_indices(column.at(first.row()), permutation.data(), permutation.data() + n);
+        }
+        permute(first, last, permutation.begin(), resource);
+    }
+
+    //! Sort a dynamic range according to the given column of the type `Key` by a comparator (stable).
+    template<typename Key, typename Compare = less>
+    void sort_by(dynamic_columns::iterator first, dynamic_columns::iterator last, std::size_t key,
+                 Compare comp = Compare(), memory_resource * resource = default_resource())
+    {
+        std::size_t const n = last - first;
+        if (n < 2) return;
+
+        Key const * keys = first.table()->column(key).template data<Key>() + first.row();
+
+        scratch_vector<std::size_t> permutation(n, 0, scratch_allocator<std::size_t>(resource));
+        for (std::size_t i = 0; i < n; ++i) permutation[i] = i;
+
+        {
+            phase_timer timer(phase::sort, n);
+            std::stable_sort(permutation.begin(), permutation.end(),
+                             [&](std::size_t a, std::size_t b) { return comp(keys[a], keys[b]); });
+        }
+        permute(first, last, permutation.begin(), resource);
+    }
+
+    //! Append copies of the rows `first[indices[k]]` for `k = 0, ..., n - 1` to the output table.
+    //!
+    //! The output must have the same column types (or no columns at all, in which case they are added). The column
+    //! types must be copyable.
+    template<typename IndexIterator>
+    void gather(dynamic_columns::iterator first, IndexIterator indices, std::size_t n, dynamic_columns & output)
+    {
+        dynamic_columns & table = * first.table();
+        if (output.column_count() == 0)
+            for (std::size_t c = 0; c < table.column_count(); ++c) output.add_column(table.column(c).type());
+        assert(output.types() == table.types());
+
+        phase_timer       timer(phase::gather, n, n * detail::table_row_bytes(table));
+        std::size_t const size = output.size();
+        for (std::size_t c = 0; c < table.column_count(); ++c)
+        {
+            dynamic_column & source = table.column(c);
+            dynamic_column & target = output.column(c);
+            target.reserve(size + n);
+
+            if (source.type()->trivial)
+            {
+                detail::gather_trivial(static_cast<char *>(target.append_trivial(n)),
+                                       static_cast<char const *>(source.at(first.row())), source.type()->size,
+                                       indices, n);
+            }
+            else
+            {
+                for (std::size_t k = 0; k < n; ++k) target.push_back_copy(source.at(first.row() + indices[k]));
+            }
+        }
+    }
+
+} // namespace joint
+
+#endif //JOINT_DYNAMIC_HPP
@@ -0,0 +1,214 @@
+//
+// Memory backed by huge pages for large columns and scratch buffers.
+//
+
+#ifndef JOINT_HUGE_PAGES_HPP
+#define JOINT_HUGE_PAGES_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#if defined(__linux__) && !defined(JOINT_NO_HUGE_PAGES)
+#include <sys/mman.h>
+#define JOINT_HAS_HUGE_PAGES 1
+#endif
+
+#include "joint_parallel.hpp"
+#include "joint_scratch.hpp"
+
+namespace joint
+{
+
+    namespace detail
+    {
+
+        //! Size of a (transparent) huge page on the common hardware (x86-64 and ARM64 with 4 KiB base pages).
+        //!
+        //! The size is fixed: the reserved huge pages are requested of this size explicitly (see below), whatever
+        //! the default size of the system (`Hugepagesize` in /proc/meminfo, e.g., 1 GiB) is.
+        constexpr std::size_t huge_page_size = std::size_t(2) << 20;
+
+#ifdef JOINT_HAS_HUGE_PAGES
+        //! The `mmap` flags of the reserved huge pages of `huge_page_size` bytes (log2 of the size in the bits from
+        //! `MAP_HUGE_SHIFT`; the default size of the system with the headers not knowing the flag).
+        constexpr int hugetlb_flags =
+#ifdef MAP_HUGE_SHIFT
+                MAP_HUGETLB | (21 << MAP_HUGE_SHIFT);
+#else
+                MAP_HUGETLB;
+#endif
+#endif
+
+        //! Size of a base page assumed by the prefaulting (touching more often is harmless).
+        constexpr std::size_t base_page_size = 4096;
+
+        //! Number of bytes prefaulted by one task.
+        constexpr std::size_t prefault_grain = std::size_t(64) << 20;
+
+        //! Round the size up to a multiple of the huge page size.
+        inline std::size_t huge_page_bytes(std::size_t bytes)
+        {
+            return (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+        }
+
+    }
+
+    //! A memory resource backing large allocations by huge pages (Linux only).
+    //!
+    //! Large random gathers over large columns (e.g., applying a permutation to 10^8 rows) miss the data TLB on
+    //! almost every access with 4 KiB pages; a 2 MiB page covers 512 times more memory per TLB entry. The
+    //! allocations of at least `threshold` bytes (a huge page by default) are mapped by `mmap` with `MAP_HUGETLB`
+    //! for the 2 MiB pages first, which succeeds only if they are reserved (`vm.nr_hugepages` with the default size
+    //! of 2 MiB, or /sys/kernel/mm/hugepages/hugepages-2048kB/nr_hugepages). Otherwise, the memory is
+    //! mapped aligned to the huge pages and `madvise(MADV_HUGEPAGE)` asks for the transparent huge pages. The
+    //! smaller allocations (and all of them elsewhere than on Linux) are passed to the upstream resource.
+    //!
+    //! The mapped memory may be prefaulted (touched page by page) by the allocation, in parallel if requested, so
+    //! that the page faults (and the zeroing of the pages by the kernel) are not paid by the first pass of an
+    //! algorithm in a single thread. The resource is thread safe if the upstream resource is.
+    class huge_page_resource : public memory_resource
+    {
+        public:
+            //! Create the resource without prefaulting.
+            explicit huge_page_resource(memory_resource * upstream = new_delete_resource(),
+                                        std::size_t threshold = detail::huge_page_size)
+                    : m_upstream(upstream), m_threshold(threshold), m_prefault(false), m_parallel(false),
+                      m_mapped_bytes(0), m_hugetlb_allocations(0) { }
+
+            //! Create the resource prefaulting the mapped memory sequentially.
+            huge_page_resource(sequential_policy, memory_resource * upstream = new_delete_resource(),
+                               std::size_t threshold = detail::huge_page_size)
+                    : m_upstream(upstream), m_threshold(threshold), m_prefault(true), m_parallel(false),
+                      m_mapped_bytes(0), m_hugetlb_allocations(0) { }
+
+            //! Create the resource prefaulting the mapped memory in parallel.
+            huge_page_resource(parallel_policy const & policy, memory_resource * upstream = new_delete_resource(),
+                               std::size_t threshold = detail::huge_page_size)
+                    : m_upstream(upstream), m_threshold(threshold), m_prefault(true), m_parallel(true),
+                      m_policy(policy), m_mapped_bytes(0), m_hugetlb_allocations(0) { }
+
+            huge_page_resource(huge_page_resource const &) = delete;
+            huge_page_resource & operator=(huge_page_resource const &) = delete;
+
+            //! Number of the bytes currently mapped by the resource (the allocations rounded up to the huge pages).
+            std::size_t mapped_bytes() const { return m_mapped_bytes.load(std::memory_order_relaxed); }
+
+            //! Number of the allocations so far backed by the reserved huge pages (`MAP_HUGETLB`).
+            std::size_t hugetlb_allocations() const
+            {
+                return m_hugetlb_allocations.load(std::memory_order_relaxed);
+            }
+
+        private:
+            bool mapped(std::size_t bytes, std::size_t alignment) const
+            {
+#ifdef JOINT_HAS_HUGE_PAGES
+                return bytes >= m_threshold && bytes > 0 && alignment <= detail::huge_page_size;
+#else
+                (void) bytes;
+                (void) alignment;
+                return false;
+#endif
+            }
+
+            void * do_allocate(std::size_t bytes, std::size_t alignment) override
+            {
+                if (!mapped(bytes, alignment)) return m_upstream->allocate(bytes, alignment);
+
+#ifdef JOINT_HAS_HUGE_PAGES
+                std::size_t const size = detail::huge_page_bytes(bytes);
+
+                void * p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                                  MAP_PRIVATE | MAP_ANONYMOUS | detail::hugetlb_flags, -1, 0);
+                if (p != MAP_FAILED)
+                    m_hugetlb_allocations.fetch_add(1, std::memory_order_relaxed);
+                else
+                    p = map_aligned(size);
+                m_mapped_bytes.fetch_add(size, std::memory_order_relaxed);
+
+                if (m_prefault) prefault(static_cast<char *>(p), size);
+                return p;
+#else
+                return nullptr;
+#endif
+            }
+
+            void do_deallocate(void * p, std::size_t bytes, std::size_t alignment) override
+            {
+                if (!mapped(bytes, alignment))
+                {
+                    m_upstream->deallocate(p, bytes, alignment);
+                    return;
+                }
+
+#ifdef JOINT_HAS_HUGE_PAGES
+                // Both kinds of the mappings are whole huge pages, hence they are unmapped alike.
+                std::size_t const size = detail::huge_page_bytes(bytes);
+                m_mapped_bytes.fetch_sub(size, std::memory_order_relaxed);
+                ::munmap(p, size);
+#endif
+            }
+
+#ifdef JOINT_HAS_HUGE_PAGES
+            //! Map the memory aligned to the huge pages and advise the kernel to back it by them.
+            static void * map_aligned(std::size_t size)
+            {
+                std::size_t const extended = size + detail::huge_page_size;
+
+                void * p = ::mmap(nullptr, extended, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (p == MAP_FAILED) throw std::bad_alloc();
+
+                std::uintptr_t const begin   = reinterpret_cast<std::uintptr_t>(p);
+                std::uintptr_t const aligned = (begin + detail::huge_page_size - 1) / detail::huge_page_size
+                                               * detail::huge_page_size;
+                if (aligned > begin) ::munmap(p, aligned - begin);
+                if (aligned + size < begin + extended) ::munmap(reinterpret_cast<void *>(aligned + size),
+                                                                begin + extended - aligned - size);
+
+                void * q = reinterpret_cast<void *>(aligned);
+#ifdef MADV_HUGEPAGE
+                ::madvise(q, size, MADV_HUGEPAGE);
+#endif
+                return q;
+            }
+#endif
+
+            //! Touch each page of the memory (in parallel if requested).
+            void prefault(char * p, std::size_t size) const
+            {
+                auto touch = [p](std::size_t b, std::size_t e)
+                {
+                    for (std::size_t i = b; i < e; i += detail::base_page_size)
+                        static_cast<char volatile *>(p)[i] = 0;
+                };
+
+                if (!m_parallel)
+                {
+                    touch(0, size);
+                    return;
+                }
+
+                std::size_t const chunks = detail::chunk_count(m_policy, size / detail::base_page_size,
+                                                               detail::prefault_grain / detail::base_page_size);
+                detail::for_each_chunk(m_policy, chunks, [&](std::size_t c)
+                {
+                    std::size_t const pages = size / detail::base_page_size;
+                    touch(detail::chunk_begin(c, chunks, pages) * detail::base_page_size,
+                          detail::chunk_begin(c + 1, chunks, pages) * detail::base_page_size);
+                });
+            }
+
+            memory_resource          * m_upstream;
+            std::size_t                m_threshold;
+            bool                       m_prefault;
+            bool                       m_parallel;
+            parallel_policy            m_policy;
+            std::atomic<std::size_t>   m_mapped_bytes;
+            std::atomic<std::size_t>   m_hugetlb_allocations;
+    };
+
+} // namespace joint
+
+#endif //JOINT_HUGE_PAGES_HPP
@@ -0,0 +1,214 @@
+//
+// Incremental (lazy) sorting of joint ranges.
+//
+
+#ifndef JOINT_INCREMENTAL_SORT_HPP
+#define JOINT_INCREMENTAL_SORT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "joint_iterator.hpp"
+#include "joint_parallel.hpp"
+#include "joint_partition.hpp"
+#include "joint_scratch.hpp"
+#include "joint_sort.hpp"
+
+namespace joint
+{
+
+    namespace detail
+    {
+
+        //! Maximal size of the blocks sorted by the insertion sort at once.
+        constexpr std::size_t incremental_block = 32;
+
+    }
+
+    //! Sort a joint range according to the I-th column lazily.
+    //!
+    //! The rows are put into their sorted positions on demand from the front of the range (in the style of the
+    //! incremental quicksort): the unsorted part is kept as a stack of blocks, each of them holding keys not greater
+    //! than those of the blocks below it. To get the next row, the top block is partitioned (three-way, column by
+    //! column) around the median of three keys until it is small enough to be sorted by the insertion sort. Getting
+    //! the first `k` rows therefore costs expected `O(N + k log k)` comparisons. The sort is not stable.
+    template<size_t I, typename Iterator, typename Compare>
+    class incremental_sorter
+    {
+        public:
+            typedef typename std::iterator_traits<Iterator>::value_type value_type;
+            typedef typename std::iterator_traits<Iterator>::reference  reference;
+
+            //! Input iterator over the rows in the sorted order.
+            class input_iterator
+            {
+                public:
+                    typedef std::input_iterator_tag                                  iterator_category;
+                    typedef typename incremental_sorter::value_type                  value_type;
+                    typedef typename incremental_sorter::reference                   reference;
+                    typedef typename std::iterator_traits<Iterator>::difference_type difference_type;
+                    typedef void                                                     pointer;
+
+                    input_iterator(incremental_sorter * sorter, std::size_t position)
+                            : m_sorter(sorter), m_position(position) { }
+
+                    reference operator*() const { return * m_sorter->at(m_position); }
+
+                    input_iterator & operator++()
+                    {
+                        ++m_position;
+                        return * this;
+                    }
+
+                    input_iterator operator++(int)
+                    {
+                        input_iterator it(* this);
+                        ++m_position;
+                        return it;
+                    }
+
+                    bool operator==(input_iterator const & other) const { return m_position == other.m_position; }
+                    bool operator!=(input_iterator const & other) const { return m_position != other.m_position; }
+
+                private:
+                    incremental_sorter * m_sorter;
+                    std::size_t          m_position;
+            };
+
+        public:
+
+            incremental_sorter(Iterator first, Iterator last, Compare comp, memory_resource * resource)
+                    : m_first(first), m_size(last - first), m_sorted(0), m_comp(comp), m_resource(resource),
+                      m_blocks(scratch_allocator<block>(resource))
+            {
+                if (m_size > 0) m_blocks.push_back(block{m_size, false});
+            }
+
+            //! Number of rows of the range.
+            std::size_t size() const { return m_size; }
+
+            //! Number of the leading rows already in their sorted positions.
+            std::size_t sorted() const { return m_sorted; }
+
+            //! Iterator to the `i`-th row in the sorted order (sorting the range up to it).
+            Iterator at(std::size_t i)
+            {
+                sort_until(i + 1);
+                Iterator it = m_first;
+                return it + i;
+            }
+
+            //! Sort the first `k` rows and return the iterator past them.
+            Iterator take(std::size_t k)
+            {
+                k = std::min(k, m_size);
+                sort_until(k);
+                Iterator it = m_first;
+                return it + k;
+            }
+
+            //! The rows in the sorted order.
+            input_iterator begin() { return input_iterator(this, 0); }
+
+            //! The end of the rows in the sorted order.
+            input_iterator end() { return input_iterator(this, m_size); }
+
+        private:
+
+            typedef typename std::decay<decltype(std::declval<Iterator>().template get<I>())>::type key_iterator;
+            typedef typename std::iterator_traits<key_iterator>::value_type                         key_type;
+
+            //! A block of the unsorted rows (starting at the end of the block above it).
+            struct block
+            {
+                std::size_t end;
+                bool        equal;  // all the keys are equal
+            };
+
+            //! Sort the blocks on the top of the stack until the first `k` rows are sorted.
+            void sort_until(std::size_t k)
+            {
+                auto keys = m_first.template get<I>();
+
+                while (m_sorted < k)
+                {
+                    block const       top   = m_blocks.back();
+                    std::size_t const begin = m_sorted, n = top.end - begin;
+
+                    if (top.equal || n <= detail::incremental_block)
+                    {
+                        Iterator it = m_first;
+                        if (!top.equal) detail::binary_insertion_sort<I>(it + begin, n, 1, m_comp);
+                        m_sorted = top.end;
+                        m_blocks.pop_back();
+                        continue;
+                    }
+
+                    // Three-way partition of the block: [begin, m1) < pivot, [m1, m2) == pivot, [m2, end) > pivot.
+                    key_type const pivot = median(keys[begin], keys[begin + n / 2], keys[top.end - 1]);
+
+                    auto less_than_pivot = [&](key_type const & key) { return m_comp(key, pivot); };
+                    auto not_above_pivot = [&](key_type const & key) { return !m_comp(pivot, key); };
+
+                    Iterator it = m_first, last = m_first;
+                    last = last + top.end;
+
+                    it = partition_by<I>(seq, it + begin, last, less_than_pivot, m_resource);
+                    std::size_t const m1 = it - m_first;
+
+                    it = partition_by<I>(seq, it, last, not_above_pivot, m_resource);
+                    std::size_t const m2 = it - m_first;
+
+                    if (m2 == top.end) m_blocks.pop_back();
+                    if (m2 > m1) m_blocks.push_back(block{m2, true});
+                    if (m1 > begin) m_blocks.push_back(block{m1, false});
+                }
+            }
+
+            template<typename T>
+            T median(T const & a, T const & b, T const & c)
+            {
+                if (m_comp(a, b)) return m_comp(b, c) ? b : (m_comp(a, c) ? c : a);
+                return m_comp(a, c) ? a : (m_comp(b, c) ? c : b);
+            }
+
+            Iterator              m_first;
+            std::size_t           m_size;
+            std::size_t           m_sorted;
+            Compare               m_comp;
+            memory_resource     * m_resource;
+            scratch_vector<block> m_blocks;
+    };
+
+    //! Sort a joint range according to the I-th column lazily (see `incremental_sorter`).
+    //!
+    //! The returned object is an input range of the rows in the sorted order, e.g.,
+    //!
+    //!     auto sorter = joint::incremental_sort(begin, end);
+    //!     auto page   = sorter.take(20);  // [begin, page) are the 20 least rows in the sorted order
+    //!
+    //! The range must outlive the returned object and must not be modified while it is used.
+    template<size_t I, typename... Iterators, typename Compare = less>
+    incremental_sorter<I, iterator<Iterators...>, Compare>
+    incremental_sort_by(iterator<Iterators...> first, iterator<Iterators...> last, Compare comp = Compare(),
+                        memory_resource * resource = default_resource())
+    {
+        return incremental_sorter<I, iterator<Iterators...>, Compare>(first, last, comp, resource);
+    }
+
+    //! Sort a joint range according to the first column lazily (see above).
+    template<typename... Iterators, typename Compare = less>
+    incremental_sorter<0, iterator<Iterators...>, Compare>
+    incremental_sort(iterator<Iterators...> first, iterator<Iterators...> last, Compare comp = Compare(),
+                     memory_resource * resource = default_resource())
+    {
+        return incremental_sort_by<0>(first, last, comp, resource);
+    }
+
+} // namespace joint
+
+#endif //JOINT_INCREMENTAL_SORT_HPP
@@ -7,11 +7,21 @@
 
 #include <tuple>
 #include <iterator>
+#include <memory>
 #include <utility>
 #include <type_traits>
+#include <vector>
 
 #include <iostream>
 
+// The joint iterators and their wrappers are usable in constant expressions since C++14 (e.g., to sort a table of
+// `std::array` columns at compile time since C++17, see `constexpr_sort()`).
+#if __cpp_constexpr >= 201304L
+#define JOINT_CONSTEXPR constexpr
+#else
+#define JOINT_CONSTEXPR
+#endif
+
 namespace joint
 {
 
@@ -27,6 +37,35 @@ namespace joint
         {
         };
 
+        // Stuff to check if the iterator is an iterator of a vector (with any allocator, e.g., the vectors of
+        // `resource_columns`). The iterators of the vectors with other allocators than the standard one are
+        // recognized by the iterator types of libstdc++ and libc++ only.
+        template<typename Iterator, typename T = typename std::iterator_traits<Iterator>::value_type>
+        struct is_vector_iterator
+                : std::integral_constant<bool,
+                                         !std::is_same<T, bool>::value
+                                         && (std::is_same<Iterator, typename std::vector<T>::iterator>::value
+                                             || std::is_same<Iterator, typename std::vector<T>::const_iterator>::value)>
+        {
+        };
+
+#if defined(__GLIBCXX__)
+        template<typename P, typename T, typename A>
+        struct is_vector_iterator<__gnu_cxx::__normal_iterator<P, std::vector<T, A>>, T> : std::true_type { };
+#elif defined(_LIBCPP_VERSION)
+        // The libc++ wrapper is used by the contiguous containers only (and never by `std::vector<bool>`).
+        template<typename P, typename T>
+        struct is_vector_iterator<std::__wrap_iter<P>, T> : std::true_type { };
+#endif
+
+        // Stuff to check if the iterator points to a contiguous storage (a pointer or an iterator of a vector),
+        // so that the algorithms can work with raw pointers. It can be specialized for other iterators.
+        template<typename Iterator, typename T = typename std::iterator_traits<Iterator>::value_type>
+        struct is_contiguous_iterator
+                : std::integral_constant<bool, std::is_pointer<Iterator>::value || is_vector_iterator<Iterator>::value>
+        {
+        };
+
         template<typename... Iterators>
         struct assert_random_access { };
 
@@ -53,61 +92,114 @@ namespace joint
 
         // "For-each" function for one tuple with arguments.
         template<typename T, typename F, typename... Args, size_t... Is>
-        void for_each_one_tuple_impl(T & t, F f, sequence<Is...>, Args... args)
+        JOINT_CONSTEXPR void for_each_one_tuple_impl(T & t, F f, sequence<Is...>, Args... args)
         {
             auto l = {(f(std::get<Is>(t), args...), 0)...};
         };
 
         template<typename... Ts, typename F, typename... Args>
-        void for_each_one_tuple(std::tuple<Ts...> & t, F f, Args... args)
+        JOINT_CONSTEXPR void for_each_one_tuple(std::tuple<Ts...> & t, F f, Args... args)
         {
             for_each_one_tuple_impl(t, f, generate_sequence<sizeof...(Ts)>(), args...);
         };
 
         template<typename T1, typename T2, typename F, size_t... Is>
-        void for_each_two_tuples_rhs_nonconst_lvalue_impl(T1 & t1, T2 & t2, F f, sequence<Is...>)
+        JOINT_CONSTEXPR void for_each_two_tuples_rhs_nonconst_lvalue_impl(T1 & t1, T2 & t2, F f, sequence<Is...>)
         {
             auto l = {(f(std::get<Is>(t1), std::get<Is>(t2)), 0)...};
         };
 
         template<typename... Ts1, typename... Ts2, typename F>
-        void for_each_two_tuples_rhs_nonconst_lvalue(std::tuple<Ts1...> & t1, std::tuple<Ts2...> & t2, F f)
+        JOINT_CONSTEXPR void for_each_two_tuples_rhs_nonconst_lvalue(std::tuple<Ts1...> & t1, std::tuple<Ts2...> & t2,
+                                                                     F f)
         {
             for_each_two_tuples_rhs_nonconst_lvalue_impl(t1, t2, f, generate_sequence<sizeof...(Ts1)>());
         };
 
         template<typename T1, typename T2, typename F, size_t... Is>
-        void for_each_two_tuples_rhs_const_lvalue_impl(T1 & t1, T2 const & t2, F f, sequence<Is...>)
+        JOINT_CONSTEXPR void for_each_two_tuples_rhs_const_lvalue_impl(T1 & t1, T2 const & t2, F f, sequence<Is...>)
         {
             auto l = {(f(std::get<Is>(t1), std::get<Is>(t2)), 0)...};
         };
 
         template<typename... Ts1, typename... Ts2, typename F>
-        void for_each_two_tuples_rhs_const_lvalue(std::tuple<Ts1...> & t1, std::tuple<Ts2...> const & t2, F f)
+        JOINT_CONSTEXPR void for_each_two_tuples_rhs_const_lvalue(std::tuple<Ts1...> & t1,
+                                                                  std::tuple<Ts2...> const & t2, F f)
         {
             for_each_two_tuples_rhs_const_lvalue_impl(t1, t2, f, generate_sequence<sizeof...(Ts1)>());
         };
 
         template<typename T1, typename T2, typename F, size_t... Is>
-        void for_each_two_tuples_rhs_rvalue_impl(T1 & t1, T2 && t2, F f, sequence<Is...>)
+        JOINT_CONSTEXPR void for_each_two_tuples_rhs_rvalue_impl(T1 & t1, T2 && t2, F f, sequence<Is...>)
         {
             auto l = {(f(std::get<Is>(t1), std::get<Is>(t2)), 0)...};
         };
 
         template<typename... Ts1, typename... Ts2, typename F>
-        void for_each_two_tuples_rhs_rvalue(std::tuple<Ts1...> & t1, std::tuple<Ts2...> && t2, F f)
+        JOINT_CONSTEXPR void for_each_two_tuples_rhs_rvalue(std::tuple<Ts1...> & t1, std::tuple<Ts2...> && t2, F f)
         {
             for_each_two_tuples_rhs_rvalue_impl(t1, t2, f, generate_sequence<sizeof...(Ts1)>());
         };
 
 
+        // Conjunction of boolean constants.
+        template<bool... Bs>
+        struct all_of : std::true_type { };
+
+        template<bool B, bool... Bs>
+        struct all_of<B, Bs...> : std::integral_constant<bool, B && all_of<Bs...>::value> { };
+
+        // The trait holds for the value types of all the iterators.
+        template<template<typename> class Trait, typename... Iterators>
+        using all_values = all_of<Trait<typename std::iterator_traits<Iterators>::value_type>::value...>;
+
+        // The swap found by the argument dependent lookup (or `std::swap`) does not throw.
+        namespace swap_lookup
+        {
+            using std::swap;
+
+            template<typename T>
+            struct is_nothrow_swappable
+                    : std::integral_constant<bool, noexcept(swap(std::declval<T &>(), std::declval<T &>()))>
+            {
+            };
+        }
+
+        using swap_lookup::is_nothrow_swappable;
+
+        // The values taken from an r-value reference wrapper are copied unless they cannot be (see `copy_or_move`),
+        // these check whether that does not throw.
+        template<typename T>
+        struct is_nothrow_copy_or_move_assignable
+                : std::integral_constant<bool,
+                                         std::is_copy_constructible<T>::value && std::is_copy_assignable<T>::value
+                                         ? std::is_nothrow_copy_assignable<T>::value
+                                         : std::is_nothrow_move_assignable<T>::value>
+        {
+        };
+
+        template<typename T>
+        struct is_nothrow_copy_or_move_constructible
+                : std::integral_constant<bool,
+                                         std::is_copy_constructible<T>::value && std::is_copy_assignable<T>::value
+                                         ? std::is_nothrow_copy_constructible<T>::value
+                                         : std::is_nothrow_move_constructible<T>::value>
+        {
+        };
+
         // Functors passed to the "for-eachers".
         // =====================================
+        //
+        // The "pointers" are the pointer types of the column iterators: raw pointers for the ordinary columns, or
+        // pointer-like objects for the columns with proxy references (e.g., `packed_iterator`), whose dereference
+        // gives a proxy r-value.
 
         // Swap the values pointed to by two pointers.
         struct pointer_content_swapper
         {
-            template<typename P> void operator()(P * p1, P * p2) noexcept
+            template<typename P>
+            JOINT_CONSTEXPR void operator()(P p1, P p2)
+                    noexcept(is_nothrow_swappable<typename std::iterator_traits<P>::value_type>::value)
             {
                 using namespace std;
 
@@ -115,10 +207,15 @@ namespace joint
             }
         };
 
+        // The I-th iterator of a list.
+        template<size_t I, typename... Iterators>
+        using column_iterator = typename std::tuple_element<I, std::tuple<Iterators...>>::type;
+
         // Advance an iterator by n.
         struct iterator_advancer
         {
-            template<typename I> void operator()(I & i, typename I::difference_type n) { i += n; }
+            template<typename I>
+            JOINT_CONSTEXPR void operator()(I & i, typename std::iterator_traits<I>::difference_type n) { i += n; }
         };
 
         // Copy pointers.
@@ -126,61 +223,122 @@ namespace joint
         {
             // Since we want to make this work with iterators, we first dereference the right-hand side pointers
             // and then take the address again.
-            template<typename P, typename I> void operator()(P *& p, I i) { p = &* i; }
+            template<typename P, typename I> JOINT_CONSTEXPR void operator()(P & p, I i) { p = &* i; }
         };
 
         // Copy pointers.
         struct copy_pointer_values
         {
             // Simple copy of the content of p2 to the object pointed to by p1 using the copy assignment.
-            template<typename P> void operator()(P * p1, P const * p2) { * p1 = * p2; }
+            template<typename P1, typename P2> JOINT_CONSTEXPR void operator()(P1 p1, P2 p2) { * p1 = * p2; }
         };
 
         // Copy pointers.
         struct move_pointer_values
         {
             // Simple move of the content of p2 to the object pointed to by p1 using the move assignment.
-            template<typename P> void operator()(P * p1, P * p2) { * p1 = std::move(* p2); }
+            template<typename P> JOINT_CONSTEXPR void operator()(P p1, P p2) { * p1 = std::move(* p2); }
         };
 
         // Make pointers to values.
         struct make_pointers_to_values
         {
-            template<typename T> void operator()(T *& p, T & v) { p = & v; }
+            template<typename T> JOINT_CONSTEXPR void operator()(T *& p, T & v) { p = & v; }
         };
 
         // Copy values to pointers.
         struct copy_values_to_pointers
         {
-            template<typename T> void operator()(T * p, T const & v) { * p = v; }
+            template<typename P, typename T> JOINT_CONSTEXPR void operator()(P p, T const & v) { * p = v; }
         };
 
         // Move values to pointers.
         struct move_values_to_pointers
         {
-            template<typename T> void operator()(T * p, T & v) { * p = std::move(v); }
+            template<typename P, typename T> JOINT_CONSTEXPR void operator()(P p, T & v) { * p = std::move(v); }
         };
 
         //! Copy values from pointers.
         struct copy_values_from_pointers
         {
-            template<typename T, typename I> void operator()(T & v, I i) { v = * i; }
+            template<typename T, typename I> JOINT_CONSTEXPR void operator()(T & v, I i) { v = * i; }
         };
 
         //! Move values from pointers.
         struct move_values_from_pointers
         {
-            template<typename T> void operator()(T & v1, T * v2) { v1 = std::move(* v2); }
+            template<typename T, typename P> JOINT_CONSTEXPR void operator()(T & v1, P v2) { v1 = std::move(* v2); }
+        };
+
+        // Values which cannot be copied (e.g., `std::unique_ptr`) are moved instead whenever the reference
+        // wrapper is an r-value. Copyable values are still copied, since an r-value reference wrapper is also what
+        // the dereference operator returns (see the notes on moving in README).
+        template<typename T>
+        struct is_copyable
+                : std::integral_constant<bool,
+                                         std::is_copy_constructible<T>::value
+                                         && std::is_copy_assignable<T>::value>
+        {
+        };
+
+        template<typename T>
+        JOINT_CONSTEXPR typename std::conditional<is_copyable<T>::value, T const &, T &&>::type copy_or_move(T & v)
+        {
+            return static_cast<typename std::conditional<is_copyable<T>::value, T const &, T &&>::type>(v);
+        }
+
+        // A proxy reference (an r-value) is passed on as is.
+        template<typename T, typename = typename std::enable_if<!std::is_lvalue_reference<T>::value>::type>
+        JOINT_CONSTEXPR T copy_or_move(T && v)
+        {
+            return std::move(v);
+        }
+
+        //! Copy (or move if not copyable) values pointed to by pointers.
+        struct copy_or_move_pointer_values
+        {
+            template<typename P> JOINT_CONSTEXPR void operator()(P p1, P p2) { * p1 = copy_or_move(* p2); }
+        };
+
+        //! Copy (or move if not copyable) values from pointers.
+        struct copy_or_move_values_from_pointers
+        {
+            template<typename T, typename P> JOINT_CONSTEXPR void operator()(T & v1, P v2) { v1 = copy_or_move(* v2); }
         };
 
     }
 
+    //! Check whether the objects of the type can be moved to another address by copying their bytes, the source
+    //! being abandoned without calling its destructor.
+    //!
+    //! The buffers of such entries (e.g., in merges and permutations) are filled and emptied by `std::memcpy`
+    //! instead of constructing, assigning and destroying the entries one by one. It holds for the trivially
+    //! copyable types and the standard smart pointers, and can be specialized for other types (most types not
+    //! pointing into themselves are relocatable).
+    template<typename T>
+    struct is_trivially_relocatable : std::is_trivially_copyable<T> { };
+
+    template<typename T>
+    struct is_trivially_relocatable<std::unique_ptr<T>> : std::true_type { };
+
+    template<typename T>
+    struct is_trivially_relocatable<std::shared_ptr<T>> : std::true_type { };
+
     // Forward declarations.
     template<typename...> class value_wrapper;
 
+    //! Values of the rows are relocatable if the values of all the columns are.
+    template<typename... Iterators>
+    struct is_trivially_relocatable<value_wrapper<Iterators...>>
+            : detail::all_of<is_trivially_relocatable<typename std::iterator_traits<Iterators>::value_type>::value...>
+    {
+    };
+
     template<typename...> class reference_wrapper;
 
-    template<typename... Is> void swap(reference_wrapper<Is...> a, reference_wrapper<Is...> b) noexcept;
+    template<typename... Is>
+    void swap(reference_wrapper<Is...> a, reference_wrapper<Is...> b)
+            noexcept(detail::all_values<detail::is_nothrow_swappable, Is...>::value);
 
     //! A wrapper class serving as a reference type for `iterator<Iterators...>`.
     //!
@@ -194,10 +352,10 @@ namespace joint
             //! Create a reference on the references provided by the iterators.
             //!
             //! The references point to the data referenced by the iterators.
-            reference_wrapper(std::tuple<Iterators...> & iterators)
+            JOINT_CONSTEXPR reference_wrapper(std::tuple<Iterators...> const & iterators)
+                    : m_pointers()
             {
-                detail::for_each_two_tuples_rhs_nonconst_lvalue(m_pointers, iterators,
-                                                                detail::copy_pointers());
+                detail::for_each_two_tuples_rhs_const_lvalue(m_pointers, iterators, detail::copy_pointers());
             }
 
             //! Copy constructor initializes the references to point to the same values.
@@ -211,7 +369,8 @@ namespace joint
             //! Note that the copy assignment is different from the copy constructor. Instead of making the reference
             //! point to the same data as the data given by the right-hand side, the copy assignment copies the values
             //! similarly to the typical assignment of ordinary references.
-            reference_wrapper<Iterators...> operator=(reference_wrapper<Iterators...> const & refs)
+            JOINT_CONSTEXPR reference_wrapper<Iterators...> operator=(reference_wrapper<Iterators...> const & refs)
+                    noexcept(detail::all_values<std::is_nothrow_copy_assignable, Iterators...>::value)
             {
                 detail::for_each_two_tuples_rhs_const_lvalue(m_pointers, refs.m_pointers,
                                                              detail::copy_pointer_values());
@@ -224,38 +383,44 @@ namespace joint
             reference_wrapper(reference_wrapper<Iterators...> &&) = default;
 
             //! Move assignment moves the content of other references into the data pointed to by "this" references.
-            reference_wrapper<Iterators...> operator=(reference_wrapper<Iterators...> && refs)
+            JOINT_CONSTEXPR reference_wrapper<Iterators...> operator=(reference_wrapper<Iterators...> && refs)
+                    noexcept(detail::all_values<detail::is_nothrow_copy_or_move_assignable, Iterators...>::value)
             {
                 // NOTE This cannot be implemented using moves; otherwise, a simple std::copy() would fail!
+                // Only the values which cannot be copied are moved.
                 detail::for_each_two_tuples_rhs_const_lvalue(m_pointers, refs.m_pointers,
-                                                             detail::copy_pointer_values());
+                                                             detail::copy_or_move_pointer_values());
                 return * this;
             }
 
             //! Create references on the values.
-            reference_wrapper(value_wrapper<Iterators...> & vals);
+            JOINT_CONSTEXPR reference_wrapper(value_wrapper<Iterators...> & vals);
 
             //! Copy the content of the values to the references.
-            reference_wrapper<Iterators...> & operator=(value_wrapper<Iterators...> const & vals);
+            JOINT_CONSTEXPR reference_wrapper<Iterators...> & operator=(value_wrapper<Iterators...> const & vals)
+                    noexcept(detail::all_values<std::is_nothrow_copy_assignable, Iterators...>::value);
 
             //! Move the content of the values to the references.
-            reference_wrapper<Iterators...> & operator=(value_wrapper<Iterators...> && vals);
+            JOINT_CONSTEXPR reference_wrapper<Iterators...> & operator=(value_wrapper<Iterators...> && vals)
+                    noexcept(detail::all_values<std::is_nothrow_move_assignable, Iterators...>::value);
 
             //! Get the I-th reference.
             template<size_t I>
-            typename std::tuple_element<I, std::tuple<Iterators...>>::type::reference
+            JOINT_CONSTEXPR typename std::iterator_traits<detail::column_iterator<I, Iterators...>>::reference
             get() { return * std::get<I>(m_pointers); }
 
             //! Get the I-th reference.
             template<size_t I>
-            typename std::tuple_element<I, std::tuple<Iterators...>>::type::reference const
+            JOINT_CONSTEXPR typename std::iterator_traits<detail::column_iterator<I, Iterators...>>::reference const
             get() const { return * std::get<I>(m_pointers); }
 
         private:
 
             std::tuple<typename std::iterator_traits<Iterators>::pointer...> m_pointers;
 
-            template<typename... Is> friend void swap(reference_wrapper<Is...> a, reference_wrapper<Is...> b) noexcept;
+            template<typename... Is>
+            friend void swap(reference_wrapper<Is...> a, reference_wrapper<Is...> b)
+                    noexcept(detail::all_values<detail::is_nothrow_swappable, Is...>::value);
 
             template<typename...> friend class value_wrapper;
     };
@@ -266,7 +431,8 @@ namespace joint
     //! and is the reason why our approach works. The arguments cannot be taken by reference since the dereference
     //! operator of the joint iterator does not return an l-value reference!
     template<typename... Iterators>
-    void swap(reference_wrapper<Iterators...> a, reference_wrapper<Iterators...> b) noexcept
+    void swap(reference_wrapper<Iterators...> a, reference_wrapper<Iterators...> b)
+            noexcept(detail::all_values<detail::is_nothrow_swappable, Iterators...>::value)
     {
         detail::for_each_two_tuples_rhs_nonconst_lvalue(a.m_pointers, b.m_pointers,
                                                         detail::pointer_content_swapper());
@@ -278,23 +444,23 @@ namespace joint
     {
         public:
 
-            //! Create values from the tuple of iterators.
-            value_wrapper(std::tuple<Iterators...> const & iterators)
-            {
-                detail::for_each_two_tuples_rhs_const_lvalue(m_values, iterators,
-                                                             detail::copy_values_from_pointers());
-            }
+            //! Create values from the tuple of iterators (the values are copy constructed in place).
+            JOINT_CONSTEXPR value_wrapper(std::tuple<Iterators...> const & iterators)
+                    : value_wrapper(iterators, detail::generate_sequence<sizeof...(Iterators)>()) { }
 
             //! Create values from a tuple of values.
+            JOINT_CONSTEXPR
             value_wrapper(std::tuple<typename std::iterator_traits<Iterators>::value_type...> const & values)
                     : m_values(values) { }
 
             //! Create values from a tuple of values.
+            JOINT_CONSTEXPR
             value_wrapper(std::tuple<typename std::iterator_traits<Iterators>::value_type...> && values)
-                    : m_values(values) { }
+                    noexcept(detail::all_values<std::is_nothrow_move_constructible, Iterators...>::value)
+                    : m_values(std::move(values)) { }
 
             //! Copy values from a tuple of values.
-            value_wrapper<Iterators...> &
+            JOINT_CONSTEXPR value_wrapper<Iterators...> &
             operator=(std::tuple<typename std::iterator_traits<Iterators>::value_type...> const & values)
             {
                 m_values = values;
@@ -302,10 +468,11 @@ namespace joint
             }
 
             //! Copy values from a tuple of values.
-            value_wrapper<Iterators...> &
+            JOINT_CONSTEXPR value_wrapper<Iterators...> &
             operator=(std::tuple<typename std::iterator_traits<Iterators>::value_type...> && values)
+                    noexcept(detail::all_values<std::is_nothrow_move_assignable, Iterators...>::value)
             {
-                m_values = values;
+                m_values = std::move(values);
                 return * this;
             }
 
@@ -318,28 +485,46 @@ namespace joint
             //! Default move assignment.
             value_wrapper<Iterators...> & operator=(value_wrapper<Iterators...> &&) = default;
 
-            //! Create values from references (copy content).
-            value_wrapper(reference_wrapper<Iterators...> const & refs);
+            //! Create values from references (the values are copy constructed in place).
+            JOINT_CONSTEXPR value_wrapper(reference_wrapper<Iterators...> const & refs)
+                    noexcept(detail::all_values<std::is_nothrow_copy_constructible, Iterators...>::value);
+            //! Create values from references (the values which cannot be copied are move constructed in place).
+            JOINT_CONSTEXPR value_wrapper(reference_wrapper<Iterators...> && refs)
+                    noexcept(detail::all_values<detail::is_nothrow_copy_or_move_constructible, Iterators...>::value);
             //! Copy assign values from references.
-            value_wrapper<Iterators...> & operator=(reference_wrapper<Iterators...> const & refs);
+            JOINT_CONSTEXPR value_wrapper<Iterators...> & operator=(reference_wrapper<Iterators...> const & refs)
+                    noexcept(detail::all_values<std::is_nothrow_copy_assignable, Iterators...>::value);
             //! Move assign values from references.
-            value_wrapper<Iterators...> & operator=(reference_wrapper<Iterators...> && refs);
+            JOINT_CONSTEXPR value_wrapper<Iterators...> & operator=(reference_wrapper<Iterators...> && refs)
+                    noexcept(detail::all_values<detail::is_nothrow_copy_or_move_assignable, Iterators...>::value);
 
             // This method should serve as a conversion of the value to a const reference.
             //! This should convert a constant value to constant reference.
-            operator reference_wrapper<Iterators...> const() const;
+            JOINT_CONSTEXPR operator reference_wrapper<Iterators...> const() const;
 
             //! Get the I-th value.
             template<size_t I>
-            typename std::tuple_element<I, std::tuple<Iterators...>>::type::value_type &
+            JOINT_CONSTEXPR typename std::iterator_traits<detail::column_iterator<I, Iterators...>>::value_type &
             get() { return std::get<I>(m_values); };
 
             //! Get the I-th value.
             template<size_t I>
-            typename std::tuple_element<I, std::tuple<Iterators...>>::type::value_type const &
+            JOINT_CONSTEXPR typename std::iterator_traits<detail::column_iterator<I, Iterators...>>::value_type const &
             get() const { return std::get<I>(m_values); }
 
         private:
+            template<size_t... Is>
+            JOINT_CONSTEXPR value_wrapper(std::tuple<Iterators...> const & iterators, detail::sequence<Is...>)
+                    : m_values(* std::get<Is>(iterators)...) { }
+
+            template<typename Pointers, size_t... Is>
+            JOINT_CONSTEXPR value_wrapper(Pointers const & pointers, detail::sequence<Is...>, std::false_type)
+                    : m_values(* std::get<Is>(pointers)...) { }
+
+            template<typename Pointers, size_t... Is>
+            JOINT_CONSTEXPR value_wrapper(Pointers const & pointers, detail::sequence<Is...>, std::true_type)
+                    : m_values(detail::copy_or_move(* std::get<Is>(pointers))...) { }
+
             std::tuple<typename std::iterator_traits<Iterators>::value_type...> m_values;
 
             template<typename...> friend class reference_wrapper;
@@ -348,15 +533,17 @@ namespace joint
     // Reference wrapper implementations.
 
     template<typename... Iterators>
-    reference_wrapper<Iterators...>::reference_wrapper(value_wrapper<Iterators...> & vals)
+    JOINT_CONSTEXPR reference_wrapper<Iterators...>::reference_wrapper(value_wrapper<Iterators...> & vals)
+            : m_pointers()
     {
         detail::for_each_two_tuples_rhs_nonconst_lvalue(m_pointers, vals.m_values,
                                                         detail::make_pointers_to_values());
     }
 
     template<typename... Iterators>
-    reference_wrapper<Iterators...> &
+    JOINT_CONSTEXPR reference_wrapper<Iterators...> &
     reference_wrapper<Iterators...>::operator=(value_wrapper<Iterators...> const & vals)
+            noexcept(detail::all_values<std::is_nothrow_copy_assignable, Iterators...>::value)
     {
         detail::for_each_two_tuples_rhs_const_lvalue(this->m_pointers, vals.m_values,
                                                      detail::copy_values_to_pointers());
@@ -364,8 +551,9 @@ namespace joint
     }
 
     template<typename... Iterators>
-    reference_wrapper<Iterators...> &
+    JOINT_CONSTEXPR reference_wrapper<Iterators...> &
     reference_wrapper<Iterators...>::operator=(value_wrapper<Iterators...> && vals)
+            noexcept(detail::all_values<std::is_nothrow_move_assignable, Iterators...>::value)
     {
         // This seems to be like the only place where we can safely do a move!
         detail::for_each_two_tuples_rhs_rvalue(this->m_pointers, std::move(vals.m_values),
@@ -376,15 +564,23 @@ namespace joint
     // Value wrapper implementations.
 
     template<typename... Iterators>
-    value_wrapper<Iterators...>::value_wrapper(reference_wrapper<Iterators...> const & refs)
+    JOINT_CONSTEXPR value_wrapper<Iterators...>::value_wrapper(reference_wrapper<Iterators...> const & refs)
+            noexcept(detail::all_values<std::is_nothrow_copy_constructible, Iterators...>::value)
+            : value_wrapper(refs.m_pointers, detail::generate_sequence<sizeof...(Iterators)>(), std::false_type())
+    {
+    }
+
+    template<typename... Iterators>
+    JOINT_CONSTEXPR value_wrapper<Iterators...>::value_wrapper(reference_wrapper<Iterators...> && refs)
+            noexcept(detail::all_values<detail::is_nothrow_copy_or_move_constructible, Iterators...>::value)
+            : value_wrapper(refs.m_pointers, detail::generate_sequence<sizeof...(Iterators)>(), std::true_type())
     {
-        detail::for_each_two_tuples_rhs_const_lvalue(m_values, refs.m_pointers,
-                                                     detail::copy_values_from_pointers());
     }
 
     template<typename... Iterators>
-    value_wrapper<Iterators...> &
+    JOINT_CONSTEXPR value_wrapper<Iterators...> &
     value_wrapper<Iterators...>::operator=(reference_wrapper<Iterators...> const & refs)
+            noexcept(detail::all_values<std::is_nothrow_copy_assignable, Iterators...>::value)
     {
         detail::for_each_two_tuples_rhs_const_lvalue(m_values, refs.m_pointers,
                                                      detail::copy_values_from_pointers());
@@ -392,16 +588,17 @@ namespace joint
     }
 
     template<typename... Iterators>
-    value_wrapper<Iterators...> &
+    JOINT_CONSTEXPR value_wrapper<Iterators...> &
     value_wrapper<Iterators...>::operator=(reference_wrapper<Iterators...> && refs)
+            noexcept(detail::all_values<detail::is_nothrow_copy_or_move_assignable, Iterators...>::value)
     {
         detail::for_each_two_tuples_rhs_const_lvalue(m_values, refs.m_pointers,
-                                                     detail::copy_values_from_pointers());
+                                                     detail::copy_or_move_values_from_pointers());
         return * this;
     }
 
     template<typename... Iterators>
-    value_wrapper<Iterators...>::operator reference_wrapper<Iterators...> const() const
+    JOINT_CONSTEXPR value_wrapper<Iterators...>::operator reference_wrapper<Iterators...> const() const
     {
         return reference_wrapper<Iterators...>(const_cast<value_wrapper<Iterators...> &>(* this));
     }
@@ -411,37 +608,37 @@ namespace joint
     class iterator
     {
         public:
-            typedef std::random_access_iterator_tag           iterator_category;
-            typedef value_wrapper<Iterator, Iterators...>     value_type;
-            typedef typename Iterator::difference_type        difference_type;
-            typedef iterator<Iterator, Iterators...>          pointer;
-            typedef reference_wrapper<Iterator, Iterators...> reference;
+            typedef std::random_access_iterator_tag                          iterator_category;
+            typedef value_wrapper<Iterator, Iterators...>                    value_type;
+            typedef typename std::iterator_traits<Iterator>::difference_type difference_type;
+            typedef iterator<Iterator, Iterators...>                         pointer;
+            typedef reference_wrapper<Iterator, Iterators...>                reference;
         public:
 
             //! Default constructor.
-            iterator()
+            JOINT_CONSTEXPR iterator()
                     : m_iterators() { }
 
             //! Create a joint iterator given a list of iterators.
-            iterator(std::tuple<Iterator, Iterators...> iterators)
+            JOINT_CONSTEXPR iterator(std::tuple<Iterator, Iterators...> iterators)
                     : m_iterators(iterators) { }
 
             //! Prefix increment (increment each iterator).
-            iterator<Iterator, Iterators...> & operator++()
+            JOINT_CONSTEXPR iterator<Iterator, Iterators...> & operator++()
             {
                 detail::for_each_one_tuple(m_iterators, detail::iterator_advancer(), 1);
                 return * this;
             };
 
             //! Prefix decrement (decrement each iterator).
-            iterator<Iterator, Iterators...> & operator--()
+            JOINT_CONSTEXPR iterator<Iterator, Iterators...> & operator--()
             {
                 detail::for_each_one_tuple(m_iterators, detail::iterator_advancer(), -1);
                 return * this;
             };
 
             //! Postfix increment (increment each iterator).
-            iterator<Iterator, Iterators...> operator++(int)
+            JOINT_CONSTEXPR iterator<Iterator, Iterators...> operator++(int)
             {
                 auto copy = * this;
                 this->operator++();
@@ -449,7 +646,7 @@ namespace joint
             };
 
             //! Postfix decrement (decrement each iterator).
-            iterator<Iterator, Iterators...> operator--(int)
+            JOINT_CONSTEXPR iterator<Iterator, Iterators...> operator--(int)
             {
                 auto copy = * this;
                 this->operator--();
@@ -457,21 +654,21 @@ namespace joint
             };
 
             //! Forward advance iterator by `n` (advance each iterator).
-            iterator<Iterator, Iterators...> & operator+=(difference_type n)
+            JOINT_CONSTEXPR iterator<Iterator, Iterators...> & operator+=(difference_type n)
             {
                 detail::for_each_one_tuple(m_iterators, detail::iterator_advancer(), n);
                 return * this;
             };
 
             //! Backward advance iterator by `n` (advance each iterator).
-            iterator<Iterator, Iterators...> & operator-=(difference_type n)
+            JOINT_CONSTEXPR iterator<Iterator, Iterators...> & operator-=(difference_type n)
             {
                 detail::for_each_one_tuple(m_iterators, detail::iterator_advancer(), -n);
                 return * this;
             };
 
             //! Forward advance iterator by `n` (advance each iterator).
-            iterator<Iterator, Iterators...> operator+(difference_type n)
+            JOINT_CONSTEXPR iterator<Iterator, Iterators...> operator+(difference_type n)
             {
                 auto copy = * this;
                 copy.operator+=(n);
@@ -479,7 +676,7 @@ namespace joint
             };
 
             //! Backward advance iterator by `n` (advance each iterator).
-            iterator<Iterator, Iterators...> operator-(difference_type n)
+            JOINT_CONSTEXPR iterator<Iterator, Iterators...> operator-(difference_type n)
             {
                 auto copy = * this;
                 copy.operator-=(n);
@@ -487,85 +684,94 @@ namespace joint
             };
 
             //! Return a reference wrapper associated with this iterator.
-            reference operator*() { return reference(this->m_iterators); }
+            JOINT_CONSTEXPR reference operator*() { return reference(this->m_iterators); }
 
             //! Return a reference wrapper associated with this iterator.
-            reference const operator*() const { return reference(this->m_iterators); }
+            JOINT_CONSTEXPR reference const operator*() const { return reference(this->m_iterators); }
 
             //! Get the pointer (not very useful, just returns this object).
-            pointer operator->() { return * this; }
+            JOINT_CONSTEXPR pointer operator->() { return * this; }
 
             //! Get the I-th iterator.
             template<size_t I>
-            typename std::tuple_element<I, std::tuple<Iterator, Iterators...>>::type
+            JOINT_CONSTEXPR typename std::tuple_element<I, std::tuple<Iterator, Iterators...>>::type
             get() const { return std::get<I>(m_iterators); };
+
+            //! Get the tuple of all the iterators.
+            JOINT_CONSTEXPR std::tuple<Iterator, Iterators...> const & iterators() const { return m_iterators; }
         private:
-            // Mutable to avoid const_cast in operator*() const.
-            mutable std::tuple<Iterator, Iterators...>           m_iterators;
+            std::tuple<Iterator, Iterators...>                   m_iterators;
             // This does nothing, just checks that all iterators are random access.
             detail::assert_random_access<Iterator, Iterators...> assert_random_access;
     };
 
     //! Compare two iterators. The comparison is based on the first iterator only.
     template<typename... Iterators>
-    bool operator==(iterator<Iterators...> const & i1, iterator<Iterators...> const & i2)
+    JOINT_CONSTEXPR bool operator==(iterator<Iterators...> const & i1, iterator<Iterators...> const & i2)
     {
         return i1.template get<0>() == i2.template get<0>();
     };
 
     //! Compare two iterators. The comparison is based on the first iterator only.
     template<typename... Iterators>
-    bool operator!=(iterator<Iterators...> const & i1, iterator<Iterators...> const & i2)
+    JOINT_CONSTEXPR bool operator!=(iterator<Iterators...> const & i1, iterator<Iterators...> const & i2)
     {
         return i1.template get<0>() != i2.template get<0>();
     };
 
     //! Compare two iterators. The comparison is based on the first iterator only.
     template<typename... Iterators>
-    bool operator<(iterator<Iterators...> const & i1, iterator<Iterators...> const & i2)
+    JOINT_CONSTEXPR bool operator<(iterator<Iterators...> const & i1, iterator<Iterators...> const & i2)
     {
         return i1.template get<0>() < i2.template get<0>();
     };
 
     //! Compare two iterators. The comparison is based on the first iterator only.
     template<typename... Iterators>
-    bool operator>(iterator<Iterators...> const & i1, iterator<Iterators...> const & i2)
+    JOINT_CONSTEXPR bool operator>(iterator<Iterators...> const & i1, iterator<Iterators...> const & i2)
     {
         return i1.template get<0>() > i2.template get<0>();
     };
 
     //! Compare two iterators. The comparison is based on the first iterator only.
     template<typename... Iterators>
-    bool operator<=(iterator<Iterators...> const & i1, iterator<Iterators...> const & i2)
+    JOINT_CONSTEXPR bool operator<=(iterator<Iterators...> const & i1, iterator<Iterators...> const & i2)
     {
         return i1.template get<0>() <= i2.template get<0>();
     };
 
     //! Compare two iterators. The comparison is based on the first iterator only.
     template<typename... Iterators>
-    bool operator>=(iterator<Iterators...> const & i1, iterator<Iterators...> const & i2)
+    JOINT_CONSTEXPR bool operator>=(iterator<Iterators...> const & i1, iterator<Iterators...> const & i2)
     {
         return i1.template get<0>() >= i2.template get<0>();
     };
 
     //! Compute the difference of two iterators. The difference is based on the first iterator only.
     template<typename Iterator, typename... Iterators>
-    typename Iterator::difference_type operator-(iterator<Iterator, Iterators...> const & i1,
-                                                 iterator<Iterator, Iterators...> const & i2)
+    JOINT_CONSTEXPR typename std::iterator_traits<Iterator>::difference_type
+    operator-(iterator<Iterator, Iterators...> const & i1, iterator<Iterator, Iterators...> const & i2)
     {
         return i1.template get<0>() - i2.template get<0>();
     };
 
     //! Make a joint iterator from a list of iterators.
     template<typename... Iterators>
-    iterator<Iterators...> make_joint(Iterators... iterators)
+    JOINT_CONSTEXPR iterator<Iterators...> make_joint(Iterators... iterators)
     {
         return iterator<Iterators...>(std::make_tuple(iterators...));
     }
 
+    //! Default comparator of the keys used by the algorithms comparing a single column (like `std::less<>`).
+    struct less
+    {
+        template<typename A, typename B>
+        JOINT_CONSTEXPR bool operator()(A const & a, B const & b) const { return a < b; }
+    };
+
     //! Default comparison operator for values. It considers only the values of the first iterator.
     template<typename... Iterators>
-    bool operator<(value_wrapper<Iterators...> const & a,
+    JOINT_CONSTEXPR bool operator<(value_wrapper<Iterators...> const & a,
                    value_wrapper<Iterators...> const & b)
     {
         return a.template get<0>() < b.template get<0>();
@@ -574,21 +780,21 @@ namespace joint
     // For some reason, GCC does not want to use an implicit conversion to value!
 
     template<typename... Iterators>
-    bool operator<(reference_wrapper<Iterators...> const & a,
+    JOINT_CONSTEXPR bool operator<(reference_wrapper<Iterators...> const & a,
                    reference_wrapper<Iterators...> const & b)
     {
         return a.template get<0>() < b.template get<0>();
     }
 
     template<typename... Iterators>
-    bool operator<(value_wrapper<Iterators...> const & a,
+    JOINT_CONSTEXPR bool operator<(value_wrapper<Iterators...> const & a,
                    reference_wrapper<Iterators...> const & b)
     {
         return a.template get<0>() < b.template get<0>();
     }
 
     template<typename... Iterators>
-    bool operator<(reference_wrapper<Iterators...> const & a,
+    JOINT_CONSTEXPR bool operator<(reference_wrapper<Iterators...> const & a,
                    value_wrapper<Iterators...> const & b)
     {
         return a.template get<0>() < b.template get<0>();
@@ -0,0 +1,546 @@
+//
+// Joins of two joint ranges on their key columns.
+//
+
+#ifndef JOINT_JOIN_HPP
+#define JOINT_JOIN_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "joint_iterator.hpp"
+#include "joint_columns.hpp"
+#include "joint_merge.hpp"
+#include "joint_parallel.hpp"
+#include "joint_scratch.hpp"
+#include "joint_sorted_range.hpp"
+
+#if !defined(JOINT_PREFETCH) && defined(__GNUC__)
+#define JOINT_PREFETCH(address) __builtin_prefetch(address)
+#elif !defined(JOINT_PREFETCH)
+#define JOINT_PREFETCH(address) ((void) 0)
+#endif
+
+namespace joint
+{
+
+    namespace detail
+    {
+
+        //! Mix the bits of a hash (the standard hashes of integers are usually the identity).
+        inline std::uint64_t mix_hash(std::uint64_t h)
+        {
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            h *= 0xc4ceb93fe53a3ce5ULL;
+            h ^= h >> 33;
+            return h;
+        }
+
+        //! Number of rows probed together (their slots are prefetched before the table is accessed).
+        constexpr std::size_t join_batch = 16;
+
+        //! Number of the build rows per partition which keeps the hash table of the partition in cache.
+        constexpr std::size_t join_partition_rows = 32768;
+
+        //! Maximal number of the partitions of the parallel join.
+        constexpr std::size_t max_join_partitions = 1024;
+
+        //! Number of partitions of the join (a sequential join does not partition the rows).
+        inline std::size_t join_partitions(sequential_policy, std::size_t, std::size_t)
+        {
+            return 1;
+        }
+
+        //! Number of partitions of the join (enough to keep the tasks busy and the tables in cache).
+        inline std::size_t join_partitions(parallel_policy const & policy, std::size_t build, std::size_t probe)
+        {
+            if (build + probe < 2 * default_grain) return 1;
+
+            std::size_t const tasks      = 4 * thread_count(policy);
+            std::size_t       partitions = 1;
+            while (partitions < max_join_partitions
+                   && (partitions < tasks || build / partitions > join_partition_rows))
+                partitions *= 2;
+            return partitions;
+        }
+
+        //! Rows of one side of the join grouped by the partitions (given by the high bits of the hashes).
+        //!
+        //! The hashes are stored along with the row indices so that the partitions are processed sequentially.
+        struct join_partitioning
+        {
+            explicit join_partitioning(memory_resource * resource)
+                    : hashes(scratch_allocator<std::uint64_t>(resource)),
+                      rows(scratch_allocator<std::size_t>(resource)),
+                      offsets(scratch_allocator<std::size_t>(resource)) { }
+
+            scratch_vector<std::uint64_t> hashes;
+            scratch_vector<std::size_t>   rows;
+            scratch_vector<std::size_t>   offsets;
+        };
+
+        //! Hash the keys and group the rows by the partitions.
+        template<typename Policy, typename KeyIterator>
+        void join_partition(Policy const & policy, KeyIterator keys, std::size_t n, std::size_t partitions,
+                            join_partitioning & p, memory_resource * resource)
+        {
+            typedef typename std::iterator_traits<KeyIterator>::value_type key_type;
+
+            std::size_t const chunks = chunk_count(policy, n);
+            int               shift  = 64;
+            while ((std::size_t(1) << (64 - shift)) < partitions) --shift;
+
+            auto partition_of = [&](std::uint64_t h) -> std::size_t
+            {
+                return partitions == 1 ? 0 : static_cast<std::size_t>(h >> shift);
+            };
+
+            scratch_vector<std::uint64_t> hashes(n, 0, scratch_allocator<std::uint64_t>(resource));
+            scratch_vector<std::size_t>   counts(chunks * partitions, 0, scratch_allocator<std::size_t>(resource));
+
+            for_each_chunk(policy, chunks, [&](std::size_t c)
+            {
+                std::hash<key_type> hash;
+                std::size_t       * count = counts.data() + c * partitions;
+                for (std::size_t i = chunk_begin(c, chunks, n), e = chunk_begin(c + 1, chunks, n); i < e; ++i)
+                {
+                    hashes[i] = mix_hash(hash(keys[i]));
+                    ++count[partition_of(hashes[i])];
+                }
+            });
+
+            // Exclusive prefix sums ordered by the partitions first, then by the chunks.
+            p.offsets.assign(partitions + 1, 0);
+            std::size_t sum = 0;
+            for (std::size_t k = 0; k < partitions; ++k)
+            {
+                p.offsets[k] = sum;
+                for (std::size_t c = 0; c < chunks; ++c)
+                {
+                    std::size_t count = counts[c * partitions + k];
+                    counts[c * partitions + k] = sum;
+                    sum += count;
+                }
+            }
+            p.offsets[partitions] = sum;
+
+            p.hashes.resize(n);
+            p.rows.resize(n);
+            for_each_chunk(policy, chunks, [&](std::size_t c)
+            {
+                std::size_t * offset = counts.data() + c * partitions;
+                for (std::size_t i = chunk_begin(c, chunks, n), e = chunk_begin(c + 1, chunks, n); i < e; ++i)
+                {
+                    std::size_t t = offset[partition_of(hashes[i])]++;
+                    p.hashes[t] = hashes[i];
+                    p.rows[t]   = i;
+                }
+            });
+        }
+
+        //! Open addressing (linear probing) hash table of the build rows of a partition.
+        //!
+        //! A slot holds a distinct key, given by the full hash and the first of its rows (the keys are compared
+        //! through the build key column, so they need not be default constructible); the further rows with the same
+        //! key are chained by `next`. Duplicate keys thus take a single slot and the probes do not degrade on skewed
+        //! keys. The rows are the positions `j` in the partition (the build row is `rows[j]`), an empty slot has the
+        //! row `empty`, and the table is at most half full.
+        template<typename KeyIterator>
+        struct join_table
+        {
+            static constexpr std::size_t empty = static_cast<std::size_t>(-1);
+
+            join_table(KeyIterator keys, std::size_t const * rows, std::size_t n, memory_resource * resource)
+                    : keys(keys), rows(rows), mask(capacity(n) - 1),
+                      hashes(mask + 1, 0, scratch_allocator<std::uint64_t>(resource)),
+                      heads(mask + 1, empty, scratch_allocator<std::size_t>(resource)),
+                      next(n, empty, scratch_allocator<std::size_t>(resource)) { }
+
+            static std::size_t capacity(std::size_t n)
+            {
+                std::size_t c = 16;
+                while (c < 2 * n) c *= 2;
+                return c;
+            }
+
+            //! Insert the `j`-th row of the partition (prepended to the chain of its key).
+            void insert(std::uint64_t hash, std::size_t j)
+            {
+                auto const & key = keys[rows[j]];
+
+                std::size_t s = static_cast<std::size_t>(hash) & mask;
+                for (; heads[s] != empty; s = (s + 1) & mask)
+                {
+                    if (hashes[s] == hash && keys[rows[heads[s]]] == key)
+                    {
+                        next[j]  = heads[s];
+                        heads[s] = j;
+                        return;
+                    }
+                }
+                hashes[s] = hash;
+                heads[s]  = j;
+            }
+
+            //! The first row of the chain of the key (or `empty`), starting the search at the slot `s`.
+            template<typename Key>
+            std::size_t find(std::size_t s, std::uint64_t hash, Key const & key) const
+            {
+                for (; heads[s] != empty; s = (s + 1) & mask)
+                    if (hashes[s] == hash && keys[rows[heads[s]]] == key) return heads[s];
+                return empty;
+            }
+
+            KeyIterator                   keys;
+            std::size_t const           * rows;
+            std::size_t                   mask;
+            scratch_vector<std::uint64_t> hashes;
+            scratch_vector<std::size_t>   heads;
+            scratch_vector<std::size_t>   next;
+        };
+
+        template<typename KeyIterator>
+        constexpr std::size_t join_table<KeyIterator>::empty;
+
+        //! The matching row pairs of a join.
+        struct join_matches
+        {
+            explicit join_matches(memory_resource * resource)
+                    : build(scratch_allocator<std::size_t>(resource)), probe(scratch_allocator<std::size_t>(resource))
+            {
+            }
+
+            scratch_vector<std::size_t> build;
+            scratch_vector<std::size_t> probe;
+        };
+
+        //! Find all the pairs of the build and probe rows with equal keys.
+        //!
+        //! Both sides are partitioned by their hashes, then a hash table is built on the build rows of each
+        //! partition and probed by the probe rows of the same partition in batches (prefetching the slots).
+        //! The partitions are independent tasks and their matches are concatenated in the order of the partitions.
+        template<typename Policy, typename BuildIterator, typename ProbeIterator>
+        void hash_join(Policy const & policy, BuildIterator build_keys, std::size_t n_build,
+                       ProbeIterator probe_keys, std::size_t n_probe, join_matches & matches,
+                       memory_resource * resource)
+        {
+            std::size_t const partitions = join_partitions(policy, n_build, n_probe);
+
+            join_partitioning build(resource), probe(resource);
+            join_partition(policy, build_keys, n_build, partitions, build, resource);
+            join_partition(policy, probe_keys, n_probe, partitions, probe, resource);
+
+            // The tables and the matches of the partitions are allocated concurrently.
+            synchronized_resource upstream(resource);
+            std::vector<join_matches> results(partitions, join_matches(& upstream));
+
+            for_each_chunk(policy, partitions, [&](std::size_t k)
+            {
+                // The rows are inserted backwards, so that the chains list them in the order of the build side.
+                std::size_t const         offset = build.offsets[k], n = build.offsets[k + 1] - offset;
+                join_table<BuildIterator> table(build_keys, build.rows.data() + offset, n, & upstream);
+                for (std::size_t j = n; j-- > 0;) table.insert(build.hashes[offset + j], j);
+
+                join_matches & result = results[k];
+                std::size_t    slots[join_batch];
+
+                for (std::size_t b = probe.offsets[k], end = probe.offsets[k + 1]; b < end; b += join_batch)
+                {
+                    std::size_t const e = std::min(b + join_batch, end);
+
+                    for (std::size_t i = b; i < e; ++i)
+                    {
+                        std::size_t s = static_cast<std::size_t>(probe.hashes[i]) & table.mask;
+                        JOINT_PREFETCH(table.heads.data() + s);
+                        JOINT_PREFETCH(table.hashes.data() + s);
+                        slots[i - b] = s;
+                    }
+
+                    for (std::size_t i = b; i < e; ++i)
+                    {
+                        std::size_t const row = probe.rows[i];
+                        for (std::size_t j = table.find(slots[i - b], probe.hashes[i], probe_keys[row]);
+                             j != table.empty; j = table.next[j])
+                        {
+                            result.build.push_back(table.rows[j]);
+                            result.probe.push_back(row);
+                        }
+                    }
+                }
+            });
+
+            scratch_vector<std::size_t> offsets(partitions + 1, 0, scratch_allocator<std::size_t>(resource));
+            for (std::size_t k = 0; k < partitions; ++k) offsets[k + 1] = offsets[k] + results[k].build.size();
+
+            matches.build.resize(offsets[partitions]);
+            matches.probe.resize(offsets[partitions]);
+            for_each_chunk(policy, partitions, [&](std::size_t k)
+            {
+                std::copy(results[k].build.begin(), results[k].build.end(), matches.build.begin() + offsets[k]);
+                std::copy(results[k].probe.begin(), results[k].probe.end(), matches.probe.begin() + offsets[k]);
+            });
+        }
+
+        //! Join the key columns building the hash table on the smaller side.
+        //!
+        //! The row indices of the matches are returned as the left and right ones.
+        template<typename Policy, typename LeftIterator, typename RightIterator>
+        void hash_join_rows(Policy const & policy, LeftIterator left_keys, std::size_t n_left,
+                            RightIterator right_keys, std::size_t n_right,
+                            scratch_vector<std::size_t> & left_rows, scratch_vector<std::size_t> & right_rows,
+                            memory_resource * resource)
+        {
+            static_assert(std::is_same<typename std::iterator_traits<LeftIterator>::value_type,
+                                       typename std::iterator_traits<RightIterator>::value_type>::value,
+                          "The key columns must be of the same type.");
+
+            join_matches matches(resource);
+            if (n_left <= n_right)
+            {
+                hash_join(policy, left_keys, n_left, right_keys, n_right, matches, resource);
+                left_rows.swap(matches.build);
+                right_rows.swap(matches.probe);
+            }
+            else
+            {
+                hash_join(policy, right_keys, n_right, left_keys, n_left, matches, resource);
+                left_rows.swap(matches.probe);
+                right_rows.swap(matches.build);
+            }
+        }
+
+        //! Copy the column entries at the given rows to the output column.
+        template<typename Policy>
+        struct row_gatherer
+        {
+            Policy const                      & policy;
+            scratch_vector<std::size_t> const & rows;
+
+            template<typename O, typename I> void operator()(O output, I column) const
+            {
+                std::size_t const n      = rows.size();
+                std::size_t const chunks = chunk_count(policy, n);
+
+                for_each_chunk(policy, chunks, [&](std::size_t c)
+                {
+                    for (std::size_t j = chunk_begin(c, chunks, n), e = chunk_begin(c + 1, chunks, n); j < e; ++j)
+                        output[j] = column[rows[j]];
+                });
+            }
+        };
+
+        //! Apply `f(std::get<Offset + I>(targets), std::get<I>(sources))` for each source column.
+        template<size_t Offset, typename Targets, typename Sources, typename F, size_t... Is>
+        void for_each_column_pair(Targets & targets, Sources & sources, F f, sequence<Is...>)
+        {
+            auto l = {(f(std::get<Offset + Is>(targets), std::get<Is>(sources)), 0)...};
+            (void) l;
+        }
+
+        //! Store the row indices of the matches into the output columns.
+        inline std::size_t write_join_indices(scratch_vector<std::size_t> const & left_rows,
+                                              scratch_vector<std::size_t> const & right_rows,
+                                              columns<std::size_t, std::size_t> & output)
+        {
+            output.resize(left_rows.size());
+            std::copy(left_rows.begin(), left_rows.end(), output.get<0>().begin());
+            std::copy(right_rows.begin(), right_rows.end(), output.get<1>().begin());
+            return left_rows.size();
+        }
+
+        //! Gather the matching rows of both ranges into the output columns.
+        template<typename Policy, typename... L, typename... R, template<typename> class A, typename... Ts>
+        std::size_t gather_join(Policy const & policy, iterator<L...> left_first, iterator<R...> right_first,
+                                scratch_vector<std::size_t> const & left_rows,
+                                scratch_vector<std::size_t> const & right_rows, basic_columns<A, Ts...> & output)
+        {
+            static_assert(sizeof...(L) + sizeof...(R) == sizeof...(Ts),
+                          "The number of the output columns does not match.");
+
+            output.resize(left_rows.size());
+
+            auto targets = output.begin().iterators();
+            auto left    = left_first.iterators();
+            auto right   = right_first.iterators();
+            for_each_column_pair<0>(targets, left, row_gatherer<Policy>{policy, left_rows},
+                                    generate_sequence<sizeof...(L)>());
+            for_each_column_pair<sizeof...(L)>(targets, right, row_gatherer<Policy>{policy, right_rows},
+                                               generate_sequence<sizeof...(R)>());
+
+            return left_rows.size();
+        }
+
+        //! Find all the pairs of rows with equal keys of two sorted key columns.
+        //!
+        //! The non-matching keys are skipped by galloping and each pair of the runs of equal keys is emitted as
+        //! the cartesian product of the runs (ordered by the left rows, then by the right ones).
+        template<typename LeftIterator, typename RightIterator, typename Compare>
+        void merge_join_rows(LeftIterator left, std::size_t n_left, RightIterator right, std::size_t n_right,
+                             Compare & comp, scratch_vector<std::size_t> & left_rows,
+                             scratch_vector<std::size_t> & right_rows)
+        {
+            std::size_t i = 0, j = 0;
+            while (i < n_left && j < n_right)
+            {
+                if (comp(left[i], right[j]))
+                    i += gallop_lower(left + i, n_left - i, right[j], comp);
+                else if (comp(right[j], left[i]))
+                    j += gallop_lower(right + j, n_right - j, left[i], comp);
+                else
+                {
+                    std::size_t const i_end = i + gallop_upper(left + i, n_left - i, left[i], comp);
+                    std::size_t const j_end = j + gallop_upper(right + j, n_right - j, right[j], comp);
+                    for (std::size_t a = i; a < i_end; ++a)
+                    {
+                        for (std::size_t b = j; b < j_end; ++b)
+                        {
+                            left_rows.push_back(a);
+                            right_rows.push_back(b);
+                        }
+                    }
+                    i = i_end;
+                    j = j_end;
+                }
+            }
+        }
+
+    }
+
+    //! Find all the pairs of rows of two ranges with equal keys in the `KL`-th and `KR`-th columns, respectively.
+    //!
+    //! The hash table is built on the keys of the smaller range. Both ranges are radix partitioned by the hashes of
+    //! the keys for the parallel execution, so that the table of each partition fits in cache and the partitions
+    //! can be joined independently. The keys must be of the same type, hashable by `std::hash` and comparable by
+    //! `==`. The output columns are resized to the number of the matches (which is returned) and filled by the
+    //! indices of the left and right rows, respectively; the order of the matches is unspecified.
+    template<size_t KL, size_t KR, typename Policy, typename... L, typename... R>
+    std::size_t hash_join_indices(Policy const & policy, iterator<L...> left_first, iterator<L...> left_last,
+                                  iterator<R...> right_first, iterator<R...> right_last,
+                                  columns<std::size_t, std::size_t> & output,
+                                  memory_resource * resource = default_resource())
+    {
+        scratch_vector<std::size_t> left_rows{scratch_allocator<std::size_t>(resource)};
+        scratch_vector<std::size_t> right_rows{scratch_allocator<std::size_t>(resource)};
+        detail::hash_join_rows(policy, left_first.template get<KL>(), left_last - left_first,
+                               right_first.template get<KR>(), right_last - right_first,
+                               left_rows, right_rows, resource);
+
+        return detail::write_join_indices(left_rows, right_rows, output);
+    }
+
+    //! Find all the pairs of rows of two ranges with equal keys in parallel (see above).
+    template<size_t KL, size_t KR, typename... L, typename... R>
+    std::size_t hash_join_indices(iterator<L...> left_first, iterator<L...> left_last,
+                                  iterator<R...> right_first, iterator<R...> right_last,
+                                  columns<std::size_t, std::size_t> & output,
+                                  memory_resource * resource = default_resource())
+    {
+        return hash_join_indices<KL, KR>(par, left_first, left_last, right_first, right_last, output, resource);
+    }
+
+    //! Join two ranges on the `KL`-th and `KR`-th columns, respectively (see `hash_join_indices()`).
+    //!
+    //! The output has the columns of the left range followed by the columns of the right range. It is resized to
+    //! the number of the matching pairs of rows (which is returned) and filled by their entries gathered column by
+    //! column.
+    template<size_t KL, size_t KR, typename Policy, typename... L, typename... R, template<typename> class A,
+             typename... Ts>
+    std::size_t hash_join(Policy const & policy, iterator<L...> left_first, iterator<L...> left_last,
+                          iterator<R...> right_first, iterator<R...> right_last, basic_columns<A, Ts...> & output,
+                          memory_resource * resource = default_resource())
+    {
+        scratch_vector<std::size_t> left_rows{scratch_allocator<std::size_t>(resource)};
+        scratch_vector<std::size_t> right_rows{scratch_allocator<std::size_t>(resource)};
+        detail::hash_join_rows(policy, left_first.template get<KL>(), left_last - left_first,
+                               right_first.template get<KR>(), right_last - right_first,
+                               left_rows, right_rows, resource);
+
+        return detail::gather_join(policy, left_first, right_first, left_rows, right_rows, output);
+    }
+
+    //! Join two ranges in parallel (see above).
+    template<size_t KL, size_t KR, typename... L, typename... R, template<typename> class A, typename... Ts>
+    std::size_t hash_join(iterator<L...> left_first, iterator<L...> left_last,
+                          iterator<R...> right_first, iterator<R...> right_last, basic_columns<A, Ts...> & output,
+                          memory_resource * resource = default_resource())
+    {
+        return hash_join<KL, KR>(par, left_first, left_last, right_first, right_last, output, resource);
+    }
+
+    //! Find all the pairs of rows of two ranges sorted by their `KL`-th and `KR`-th columns with equal keys.
+    //!
+    //! Both ranges must be sorted according to the comparator (which takes the keys). The ranges are walked in a
+    //! single pass and each pair of the runs of equal keys produces all the pairs of their rows. The output columns
+    //! are resized to the number of the matches (which is returned) and filled by the indices of the left and
+    //! right rows ordered as the left rows (and the right rows within the equal keys).
+    template<size_t KL, size_t KR, typename... L, typename... R, typename Compare = less>
+    std::size_t merge_join_indices(iterator<L...> left_first, iterator<L...> left_last,
+                                   iterator<R...> right_first, iterator<R...> right_last,
+                                   columns<std::size_t, std::size_t> & output, Compare comp = Compare(),
+                                   memory_resource * resource = default_resource())
+    {
+        scratch_vector<std::size_t> left_rows{scratch_allocator<std::size_t>(resource)};
+        scratch_vector<std::size_t> right_rows{scratch_allocator<std::size_t>(resource)};
+        detail::merge_join_rows(left_first.template get<KL>(), left_last - left_first,
+                                right_first.template get<KR>(), right_last - right_first, comp,
+                                left_rows, right_rows);
+
+        return detail::write_join_indices(left_rows, right_rows, output);
+    }
+
+    //! Join two ranges sorted by the `KL`-th and `KR`-th columns, respectively (see `merge_join_indices()`).
+    //!
+    //! The output has the columns of the left range followed by the columns of the right range (see
+    //! `hash_join()`), the rows are ordered by the keys.
+    template<size_t KL, size_t KR, typename... L, typename... R, template<typename> class A, typename... Ts,
+             typename Compare = less>
+    std::size_t merge_join(iterator<L...> left_first, iterator<L...> left_last,
+                           iterator<R...> right_first, iterator<R...> right_last, basic_columns<A, Ts...> & output,
+                           Compare comp = Compare(), memory_resource * resource = default_resource())
+    {
+        scratch_vector<std::size_t> left_rows{scratch_allocator<std::size_t>(resource)};
+        scratch_vector<std::size_t> right_rows{scratch_allocator<std::size_t>(resource)};
+        detail::merge_join_rows(left_first.template get<KL>(), left_last - left_first,
+                                right_first.template get<KR>(), right_last - right_first, comp,
+                                left_rows, right_rows);
+
+        return detail::gather_join(seq, left_first, right_first, left_rows, right_rows, output);
+    }
+
+    //! Find all the pairs of rows with equal keys of two sorted ranges (see `merge_join_indices()`).
+    //!
+    //! The key columns and the comparator are taken from the orders of the ranges, which must use the same
+    //! comparator type.
+    template<size_t KL, size_t KR, typename Compare, typename... L, typename... R>
+    std::size_t merge_join_indices(sorted_range<order_by<KL, Compare>, L...> const & left,
+                                   sorted_range<order_by<KR, Compare>, R...> const & right,
+                                   columns<std::size_t, std::size_t> & output,
+                                   memory_resource * resource = default_resource())
+    {
+        return merge_join_indices<KL, KR>(left.begin(), left.end(), right.begin(), right.end(), output,
+                                          left.key_comp(), resource);
+    }
+
+    //! Join two sorted ranges on their key columns (see `merge_join()` and `merge_join_indices()` above).
+    template<size_t KL, size_t KR, typename Compare, typename... L, typename... R, template<typename> class A,
+             typename... Ts>
+    std::size_t merge_join(sorted_range<order_by<KL, Compare>, L...> const & left,
+                           sorted_range<order_by<KR, Compare>, R...> const & right, basic_columns<A, Ts...> & output,
+                           memory_resource * resource = default_resource())
+    {
+        return merge_join<KL, KR>(left.begin(), left.end(), right.begin(), right.end(), output, left.key_comp(),
+                                  resource);
+    }
+
+} // namespace joint
+
+#endif //JOINT_JOIN_HPP
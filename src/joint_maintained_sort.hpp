@@ -0,0 +1,185 @@
+//
+// Keeping joint ranges sorted under in-place updates of their keys.
+//
+
+#ifndef JOINT_MAINTAINED_SORT_HPP
+#define JOINT_MAINTAINED_SORT_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <utility>
+
+#include "joint_iterator.hpp"
+#include "joint_merge.hpp"
+#include "joint_observer.hpp"
+#include "joint_scratch.hpp"
+#include "joint_sort.hpp"
+#include "joint_sorted_range.hpp"
+
+namespace joint
+{
+
+    namespace detail
+    {
+
+        //! The order is restored by a full sort if more than `1 / maintained_resort_fraction` of the rows are dirty.
+        constexpr std::size_t maintained_resort_fraction = 16;
+
+        //! Move the dirty rows of a column to its end, keeping the order of the clean rows.
+        //!
+        //! The dirty entries (given by their ascending distinct indices) are buffered, the runs of the clean entries
+        //! between them are moved forward and the buffered entries are put behind them. The entries before the first
+        //! dirty one are not touched.
+        struct dirty_row_mover
+        {
+            scratch_vector<std::size_t> const & dirty;
+            std::size_t                         n;
+            memory_resource                   * resource;
+
+            template<typename I> void operator()(I column)
+            {
+                typedef typename std::iterator_traits<I>::value_type value_type;
+
+                scratch_vector<value_type> buffer{scratch_allocator<value_type>(resource)};
+                buffer.reserve(dirty.size());
+                for (std::size_t i : dirty) buffer.push_back(std::move(column[i]));
+
+                std::size_t out = dirty.front();
+                for (std::size_t k = 0; k < dirty.size(); ++k)
+                {
+                    std::size_t const begin = dirty[k] + 1, end = k + 1 < dirty.size() ? dirty[k + 1] : n;
+                    std::move(column + begin, column + end, column + out);
+                    out += end - begin;
+                }
+                std::move(buffer.begin(), buffer.end(), column + out);
+            }
+        };
+
+    }
+
+    //! A joint range kept sorted according to the I-th column while the keys of its rows are updated in place.
+    //!
+    //! The range is sorted once by the constructor. The rows whose keys are changed are recorded as dirty, either
+    //! by writing them through `update(i)` (e.g., `sorter.update(i).get<0>() = key`) or by `mark_dirty(i)` after
+    //! writing them directly. `sorted()` restores the order: the `D` dirty rows are moved behind the clean ones
+    //! (which stay sorted), sorted by `sort_by<I>()` and merged back by `inplace_merge_by<I>()`, which takes
+    //! `O(N + D log D)` time instead of `O(N log N)` for a full sort (the order is restored by the full sort if many
+    //! rows are dirty). The rows are identified by their current positions, which change when the order is restored.
+    //! The restoration is not stable.
+    template<size_t I, typename Compare, typename... Iterators>
+    class maintained_sorter
+    {
+        public:
+            typedef joint::iterator<Iterators...>                iterator;
+            typedef typename iterator::reference                 reference;
+            typedef sorted_range_by<I, Compare, Iterators...>    sorted_range_type;
+
+        public:
+
+            maintained_sorter(iterator first, iterator last, Compare comp, memory_resource * resource)
+                    : m_first(first), m_last(last), m_comp(comp), m_resource(resource),
+                      m_flags(last - first, resource), m_dirty(scratch_allocator<std::size_t>(resource))
+            {
+                sort_by<I>(m_first, m_last, m_comp, m_resource);
+            }
+
+            //! Number of rows of the range.
+            std::size_t size() const { return m_last - m_first; }
+
+            //! Number of the dirty rows.
+            std::size_t dirty() const { return m_dirty.size(); }
+
+            //! Record that the key of the `i`-th row has been changed.
+            void mark_dirty(std::size_t i)
+            {
+                assert(i < size());
+                if (m_flags[i]) return;
+
+                m_flags.set(i);
+                m_dirty.push_back(i);
+            }
+
+            //! The `i`-th row to be updated (recorded as dirty).
+            reference update(std::size_t i)
+            {
+                mark_dirty(i);
+                iterator it = m_first;
+                return * (it + i);
+            }
+
+            //! The range sorted again (see `restore()`).
+            sorted_range_type sorted()
+            {
+                restore();
+                return sorted_range_type(m_first, m_last, m_comp);
+            }
+
+            //! Restore the order of the rows after the updates of their keys.
+            void restore()
+            {
+                if (m_dirty.empty()) return;
+
+                std::size_t const n = size(), d = m_dirty.size();
+                for (std::size_t i : m_dirty) m_flags.reset(i);
+
+                if (d > n / detail::maintained_resort_fraction)
+                {
+                    sort_by<I>(m_first, m_last, m_comp, m_resource);
+                    m_dirty.clear();
+                    return;
+                }
+
+                std::sort(m_dirty.begin(), m_dirty.end());
+                {
+                    phase_timer timer(phase::partition, n - m_dirty.front());
+
+                    auto iterators = m_first.iterators();
+                    detail::for_each_one_tuple(iterators, detail::dirty_row_mover{m_dirty, n, m_resource});
+                }
+                m_dirty.clear();
+
+                iterator middle = m_first;
+                middle = middle + (n - d);
+                sort_by<I>(middle, m_last, m_comp, m_resource);
+                inplace_merge_by<I>(m_first, middle, m_last, m_comp, m_resource);
+            }
+
+        private:
+            iterator                    m_first;
+            iterator                    m_last;
+            Compare                     m_comp;
+            memory_resource           * m_resource;
+            detail::scratch_bitset      m_flags;
+            scratch_vector<std::size_t> m_dirty;
+    };
+
+    //! Sort a joint range according to the I-th column and keep it sorted under updates (see `maintained_sorter`).
+    //!
+    //!     auto book = joint::maintained_sort(begin, end);
+    //!     book.update(i).get<0>() = price;   // for ~0.1% of the rows
+    //!     auto sorted = book.sorted();      // O(N + D log D) instead of a full sort
+    //!
+    //! The range must outlive the returned object.
+    template<size_t I, typename... Iterators, typename Compare = less>
+    maintained_sorter<I, Compare, Iterators...>
+    maintained_sort_by(iterator<Iterators...> first, iterator<Iterators...> last, Compare comp = Compare(),
+                       memory_resource * resource = default_resource())
+    {
+        return maintained_sorter<I, Compare, Iterators...>(first, last, comp, resource);
+    }
+
+    //! Sort a joint range according to the first column and keep it sorted under updates (see above).
+    template<typename... Iterators, typename Compare = less>
+    maintained_sorter<0, Compare, Iterators...>
+    maintained_sort(iterator<Iterators...> first, iterator<Iterators...> last, Compare comp = Compare(),
+                    memory_resource * resource = default_resource())
+    {
+        return maintained_sort_by<0>(first, last, comp, resource);
+    }
+
+} // namespace joint
+
+#endif //JOINT_MAINTAINED_SORT_HPP
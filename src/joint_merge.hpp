@@ -0,0 +1,430 @@
+//
+// Merging of sorted joint ranges.
+//
+
+#ifndef JOINT_MERGE_HPP
+#define JOINT_MERGE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "joint_iterator.hpp"
+#include "joint_observer.hpp"
+#include "joint_scratch.hpp"
+
+namespace joint
+{
+
+    namespace detail
+    {
+
+        //! Merge two consecutive parts of a column according to the recorded decisions.
+        //!
+        //! The `i`-th bit of `from_left` tells whether the `i`-th merged entry comes from the left part. The smaller
+        //! part is moved to a scratch buffer, the bigger one is merged in place.
+        struct bitset_merger
+        {
+            scratch_bitset const & from_left;
+            std::size_t            n_left;
+            std::size_t            n;
+            memory_resource      * resource;
+
+            template<typename I> void operator()(I column)
+            {
+                merge(column, is_contiguous_iterator<I>());
+            }
+
+            //! Merge a contiguous column through raw pointers.
+            template<typename I> void merge(I column, std::true_type)
+            {
+                typedef typename std::iterator_traits<I>::value_type value_type;
+
+                merge_contiguous(& * column, is_trivially_relocatable<value_type>());
+            }
+
+            //! Merge a contiguous column moving the entries (through a buffer of moved entries).
+            template<typename T> void merge_contiguous(T * data, std::false_type)
+            {
+                scratch_vector<T> buffer{scratch_allocator<T>(resource)};
+                if (n_left <= n - n_left)
+                {
+                    buffer.reserve(n_left);
+                    buffer.assign(std::make_move_iterator(data), std::make_move_iterator(data + n_left));
+                }
+                else
+                {
+                    buffer.reserve(n - n_left);
+                    buffer.assign(std::make_move_iterator(data + n_left), std::make_move_iterator(data + n));
+                }
+                merge_entries(data, buffer.data(), [](T * target, T * source) { * target = std::move(* source); });
+            }
+
+            //! Merge a contiguous column relocating the entries bytewise (no entry is constructed or destroyed).
+            template<typename T> void merge_contiguous(T * data, std::true_type)
+            {
+                relocation_buffer<T> buffer(std::min(n_left, n - n_left), resource);
+                relocate(buffer.data(), n_left <= n - n_left ? data : data + n_left, buffer.size());
+                merge_entries(data, buffer.data(), [](T * target, T * source) { relocate(target, source, 1); });
+            }
+
+            //! Merge the column with the smaller part in the buffer, `move(target, source)` moves an entry.
+            template<typename T, typename Move> void merge_entries(T * data, T * buffer, Move move)
+            {
+                if (n_left <= n - n_left)
+                {
+                    T * out   = data;
+                    T * left  = buffer;
+                    T * right = data + n_left;
+                    T * end   = left + n_left;
+                    for (std::size_t k = 0; left != end; ++k)
+                    {
+                        // Select the source without branching (the decisions are hardly predictable).
+                        bool from = from_left[k];
+                        move(out++, from ? left : right);
+                        left  += from;
+                        right += !from;
+                    }
+                }
+                else
+                {
+                    T * out   = data + n;
+                    T * left  = data + n_left;
+                    T * right = buffer + (n - n_left);
+                    T * end   = buffer;
+                    for (std::size_t k = n; right != end; --k)
+                    {
+                        bool from = from_left[k - 1];
+                        move(--out, (from ? left : right) - 1);
+                        left  -= from;
+                        right -= !from;
+                    }
+                }
+            }
+
+            //! Merge a column given by a general random access iterator.
+            template<typename I> void merge(I column, std::false_type)
+            {
+                typedef typename std::iterator_traits<I>::value_type value_type;
+
+                scratch_vector<value_type> buffer{scratch_allocator<value_type>(resource)};
+
+                if (n_left <= n - n_left)
+                {
+                    buffer.assign(std::make_move_iterator(column), std::make_move_iterator(column + n_left));
+
+                    std::size_t i = 0, j = n_left;
+                    for (std::size_t k = 0; i < n_left; ++k)
+                        column[k] = from_left[k] ? std::move(buffer[i++]) : std::move(column[j++]);
+                }
+                else
+                {
+                    buffer.assign(std::make_move_iterator(column + n_left), std::make_move_iterator(column + n));
+
+                    std::size_t i = n_left, j = n - n_left;
+                    for (std::size_t k = n; j > 0; --k)
+                        column[k - 1] = from_left[k - 1] ? std::move(column[--i]) : std::move(buffer[--j]);
+                }
+            }
+        };
+
+        //! Number of consecutive wins of one side after which the merge switches to galloping.
+        constexpr std::size_t min_gallop = 7;
+
+        //! Number of the leading keys in `[keys, keys + n)` not greater than `key` (exponential search).
+        template<typename KeyIterator, typename T, typename Compare>
+        std::size_t gallop_upper(KeyIterator keys, std::size_t n, T const & key, Compare & comp)
+        {
+            std::size_t lo = 0, bound = 1;
+            while (bound <= n && !comp(key, keys[bound - 1]))
+            {
+                lo = bound;
+                bound *= 2;
+            }
+            return std::upper_bound(keys + lo, keys + std::min(bound - 1, n), key, comp) - keys;
+        }
+
+        //! Number of the leading keys in `[keys, keys + n)` less than `key` (exponential search).
+        template<typename KeyIterator, typename T, typename Compare>
+        std::size_t gallop_lower(KeyIterator keys, std::size_t n, T const & key, Compare & comp)
+        {
+            std::size_t lo = 0, bound = 1;
+            while (bound <= n && comp(keys[bound - 1], key))
+            {
+                lo = bound;
+                bound *= 2;
+            }
+            return std::lower_bound(keys + lo, keys + std::min(bound - 1, n), key, comp) - keys;
+        }
+
+        //! Stable merge of the sorted rows `[first, first + n_left)` and `[first + n_left, first + n)`.
+        //!
+        //! The merge decisions are taken on the I-th column only (galloping over long runs taken from one side) and
+        //! recorded into a bitset, each column is merged separately afterwards.
+        template<size_t I, typename... Iterators, typename Compare>
+        void merge_adjacent(iterator<Iterators...> first, std::size_t n_left, std::size_t n, Compare & comp,
+                            memory_resource * resource)
+        {
+            auto keys = first.template get<I>();
+            if (n_left == 0 || n_left == n) return;
+
+            // Leading entries of the left part and trailing entries of the right part are already in place.
+            std::size_t lo = gallop_upper(keys, n_left, keys[n_left], comp);
+            if (lo == n_left) return;
+            std::size_t hi = n_left + gallop_lower(keys + n_left, n - n_left, keys[n_left - 1], comp);
+
+            keys   += lo;
+            n       = hi - lo;
+            n_left -= lo;
+
+            scratch_bitset from_left(n, resource);
+            std::size_t    i = 0, j = n_left, k = 0, wins = 0;
+            bool           last = false;
+            while (i < n_left && j < n)
+            {
+                bool left = !comp(keys[j], keys[i]);
+                from_left.assign(k++, left);
+                i += left;
+                j += !left;
+
+                // Count the consecutive wins of one side without branching and gallop if there are too many.
+                wins = (wins & -static_cast<std::size_t>(left == last)) + 1;
+                last = left;
+                if (wins >= min_gallop && i < n_left && j < n)
+                {
+                    std::size_t count = left ? gallop_upper(keys + i, n_left - i, keys[j], comp)
+                                             : gallop_lower(keys + j, n - j, keys[i], comp);
+                    for (std::size_t c = 0; c < count; ++c) from_left.assign(k++, left);
+                    (left ? i : j) += count;
+                    wins = 0;
+                }
+            }
+            while (i++ < n_left) from_left.set(k++);
+
+            auto iterators = (first + lo).iterators();
+            for_each_one_tuple(iterators, bitset_merger{from_left, n_left, n, resource});
+        }
+
+        //! Tournament tree of losers over the heads of `k` sorted key columns.
+        //!
+        //! Each inner node keeps the loser of the match played there and the winner is kept aside, so that replacing
+        //! the winner by the next key of its column replays only the matches on its path to the root (`log2(k)`
+        //! comparisons). Exhausted columns lose against all the others and the ties are won by the column with the
+        //! lower index (hence the merge is stable).
+        template<typename KeyIterator, typename Compare>
+        class loser_tree
+        {
+            public:
+                loser_tree(std::size_t k, Compare & comp, memory_resource * resource)
+                        : m_size(1), m_comp(comp),
+                          m_keys(scratch_allocator<KeyIterator>(resource)),
+                          m_positions(scratch_allocator<std::size_t>(resource)),
+                          m_ends(scratch_allocator<std::size_t>(resource)),
+                          m_losers(scratch_allocator<std::size_t>(resource)),
+                          m_winner(0)
+                {
+                    while (m_size < k) m_size *= 2;
+                    m_keys.reserve(k);
+                    m_positions.assign(m_size, 0);
+                    m_ends.assign(m_size, 0);
+                }
+
+                //! Add the next key column (of `n` keys).
+                void add(KeyIterator keys, std::size_t n)
+                {
+                    m_ends[m_keys.size()] = n;
+                    m_keys.push_back(keys);
+                }
+
+                //! Play all the matches (once all the columns are added).
+                void build()
+                {
+                    scratch_vector<std::size_t> winners(2 * m_size, 0, m_losers.get_allocator());
+                    m_losers.assign(m_size, 0);
+                    for (std::size_t i = 0; i < m_size; ++i) winners[m_size + i] = i;
+                    for (std::size_t node = m_size - 1; node > 0; --node)
+                    {
+                        std::size_t a = winners[2 * node], b = winners[2 * node + 1];
+                        bool        w = beats(a, b);
+                        winners[node]  = w ? a : b;
+                        m_losers[node] = w ? b : a;
+                    }
+                    m_winner = m_size > 1 ? winners[1] : 0;
+                }
+
+                //! Check whether all the columns are exhausted.
+                bool empty() const { return exhausted(m_winner); }
+
+                //! Index of the column with the least head.
+                std::size_t top() const { return m_winner; }
+
+                //! Advance the column with the least head.
+                void pop()
+                {
+                    ++m_positions[m_winner];
+                    std::size_t w = m_winner;
+                    for (std::size_t node = (m_size + w) / 2; node > 0; node /= 2)
+                    {
+                        if (beats(m_losers[node], w)) std::swap(m_losers[node], w);
+                    }
+                    m_winner = w;
+                }
+
+            private:
+                bool exhausted(std::size_t i) const { return m_positions[i] == m_ends[i]; }
+
+                bool beats(std::size_t a, std::size_t b)
+                {
+                    if (exhausted(a)) return false;
+                    if (exhausted(b)) return true;
+
+                    auto const & key_a = m_keys[a][m_positions[a]];
+                    auto const & key_b = m_keys[b][m_positions[b]];
+                    return a < b ? !m_comp(key_b, key_a) : m_comp(key_a, key_b);
+                }
+
+                std::size_t                 m_size;
+                Compare                   & m_comp;
+                scratch_vector<KeyIterator> m_keys;
+                scratch_vector<std::size_t> m_positions;
+                scratch_vector<std::size_t> m_ends;
+                scratch_vector<std::size_t> m_losers;
+                std::size_t                 m_winner;
+        };
+
+        //! Move (or copy if `Move` is false) the column entries of the merged ranges to the output column in the
+        //! recorded order.
+        template<typename RangeIterator, bool Move = true>
+        struct kway_mover
+        {
+            RangeIterator                          ranges;
+            std::size_t                            k;
+            scratch_vector<std::uint32_t> const  & sources;
+            memory_resource                      * resource;
+
+            template<size_t C, typename O> void move(O output)
+            {
+                typedef typename std::decay<decltype(ranges[0].first.template get<C>())>::type column_iterator;
+
+                scratch_vector<column_iterator> cursors{scratch_allocator<column_iterator>(resource)};
+                cursors.reserve(k);
+                for (std::size_t r = 0; r < k; ++r) cursors.push_back(ranges[r].first.template get<C>());
+
+                for (std::uint32_t r : sources)
+                {
+                    transfer(output, cursors[r], std::integral_constant<bool, Move>());
+                    ++cursors[r];
+                    ++output;
+                }
+            }
+
+            template<typename O, typename C> static void transfer(O & output, C & cursor, std::true_type)
+            {
+                * output = std::move(* cursor);
+            }
+
+            template<typename O, typename C> static void transfer(O & output, C & cursor, std::false_type)
+            {
+                * output = * cursor;
+            }
+        };
+
+        template<typename Mover, typename Outputs, size_t... Is>
+        void kway_move_columns(Mover & mover, Outputs & outputs, sequence<Is...>)
+        {
+            auto l = {(mover.template move<Is>(std::get<Is>(outputs)), 0)...};
+            (void) l;
+        }
+
+    }
+
+    //! Merge two consecutive sorted parts `[first, middle)` and `[middle, last)` of a range sorted by the I-th column.
+    //!
+    //! Unlike `std::inplace_merge`, the comparator is called on the keys (the I-th column values) only. The merge
+    //! decisions are recorded into a bitset first and each column is merged separately afterwards, hence the scratch
+    //! memory is taken for a single column at a time (from `resource`). The merge is stable.
+    template<size_t I, typename... Iterators, typename Compare = less>
+    void inplace_merge_by(iterator<Iterators...> first, iterator<Iterators...> middle, iterator<Iterators...> last,
+                          Compare comp = Compare(), memory_resource * resource = default_resource())
+    {
+        std::size_t const n = last - first;
+        phase_timer       timer(phase::merge, n, n * detail::row_bytes<Iterators...>::value);
+
+        detail::merge_adjacent<I>(first, middle - first, n, comp, resource);
+    }
+
+    //! Merge two consecutive sorted parts of a range sorted by the first column (see above).
+    template<typename... Iterators, typename Compare = less>
+    void inplace_merge(iterator<Iterators...> first, iterator<Iterators...> middle, iterator<Iterators...> last,
+                       Compare comp = Compare(), memory_resource * resource = default_resource())
+    {
+        inplace_merge_by<0>(first, middle, last, comp, resource);
+    }
+
+    namespace detail
+    {
+
+        //! Merge many sorted ranges into the output range moving (or copying if `Move` is false) the rows.
+        template<size_t I, bool Move, typename RangeIterator, typename... Out, typename Compare>
+        iterator<Out...> kway_merge_rows(RangeIterator ranges_first, RangeIterator ranges_last,
+                                         iterator<Out...> output, Compare comp, memory_resource * resource)
+        {
+            typedef typename std::decay<decltype(ranges_first->first.template get<I>())>::type key_iterator;
+            typedef typename std::decay<decltype(ranges_first->first.iterators())>::type input_iterators;
+            static_assert(std::tuple_size<input_iterators>::value == sizeof...(Out),
+                          "The number of the output columns does not match.");
+
+            std::size_t const k = ranges_last - ranges_first;
+
+            loser_tree<key_iterator, Compare> tree(k, comp, resource);
+            std::size_t                       n = 0;
+            for (std::size_t r = 0; r < k; ++r)
+            {
+                std::size_t size = ranges_first[r].second - ranges_first[r].first;
+                tree.add(ranges_first[r].first.template get<I>(), size);
+                n += size;
+            }
+
+            phase_timer timer(phase::merge, n, n * row_bytes<Out...>::value);
+            tree.build();
+
+            scratch_vector<std::uint32_t> sources{scratch_allocator<std::uint32_t>(resource)};
+            sources.reserve(n);
+            for (; !tree.empty(); tree.pop()) sources.push_back(static_cast<std::uint32_t>(tree.top()));
+
+            auto                            outputs = output.iterators();
+            kway_mover<RangeIterator, Move> mover{ranges_first, k, sources, resource};
+            kway_move_columns(mover, outputs, generate_sequence<sizeof...(Out)>());
+
+            return output + n;
+        }
+
+    }
+
+    //! Merge many ranges sorted by the I-th column into the output range.
+    //!
+    //! The ranges are given by the pairs of joint iterators `[ranges_first, ranges_last)` (their first and last
+    //! rows). The order of the rows is found by a loser tree on the keys first (recording the source range of each
+    //! row), then the rows are moved to the output column by column. The comparator takes the keys, the merge is
+    //! stable (equal keys are taken in the order of the ranges). Returns the end of the output range.
+    template<size_t I, typename RangeIterator, typename... Out, typename Compare = less>
+    iterator<Out...> kway_merge_by(RangeIterator ranges_first, RangeIterator ranges_last, iterator<Out...> output,
+                                   Compare comp = Compare(), memory_resource * resource = default_resource())
+    {
+        return detail::kway_merge_rows<I, true>(ranges_first, ranges_last, output, comp, resource);
+    }
+
+    //! Merge many ranges sorted by the first column into the output range (see above).
+    template<typename RangeIterator, typename... Out, typename Compare = less>
+    iterator<Out...> kway_merge(RangeIterator ranges_first, RangeIterator ranges_last, iterator<Out...> output,
+                                Compare comp = Compare(), memory_resource * resource = default_resource())
+    {
+        return kway_merge_by<0>(ranges_first, ranges_last, output, comp, resource);
+    }
+
+} // namespace joint
+
+#endif //JOINT_MERGE_HPP
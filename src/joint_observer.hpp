@@ -0,0 +1,366 @@
+//
+// Observing the phases of the joint algorithms (wall time, moved data and hardware counters).
+//
+
+#ifndef JOINT_OBSERVER_HPP
+#define JOINT_OBSERVER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+#if defined(__linux__) && !defined(JOINT_NO_PERF_EVENTS)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define JOINT_HAS_PERF_EVENTS 1
+#endif
+
+namespace joint
+{
+
+    //! The phases of the algorithms reported to the observers.
+    enum class phase
+    {
+        key_extraction, // computing the keys (e.g., the cached prefixes or the histogram of the keys)
+        sort,           // sorting the rows (or their indices)
+        partition,      // partitioning the rows
+        merge,          // merging sorted ranges
+        permutation,    // applying a permutation to the columns
+        gather          // copying the selected rows to an output
+    };
+
+    //! Name of the phase.
+    inline char const * phase_name(phase p)
+    {
+        switch (p)
+        {
+            case phase::key_extraction: return "key extraction";
+            case phase::sort:           return "sort";
+            case phase::partition:      return "partition";
+            case phase::merge:          return "merge";
+            case phase::permutation:    return "permutation";
+            case phase::gather:         return "gather";
+        }
+        return "unknown";
+    }
+
+    //! Values of the hardware counters (of the calling thread).
+    //!
+    //! The counters are scheduled on the hardware as one group, `time_running` is the time the group was counting
+    //! and `time_enabled` the time it was enabled. If the kernel multiplexed the hardware between more events than
+    //! it has counters, `time_running` is less than `time_enabled` and the counts are estimates (see `scaled()`).
+    struct counter_values
+    {
+        std::uint64_t cycles        = 0;
+        std::uint64_t llc_misses    = 0;
+        std::uint64_t dtlb_misses   = 0;
+        std::uint64_t branch_misses = 0;
+        std::uint64_t time_enabled  = 0;
+        std::uint64_t time_running  = 0;
+
+        //! Whether the counts are scaled from a part of the time.
+        bool multiplexed() const { return time_running < time_enabled; }
+
+        //! The differences from the earlier values, scaled by the time the group was enabled over the time it was
+        //! counting (all zero if it was not counting at all).
+        counter_values since(counter_values const & start) const
+        {
+            counter_values d;
+            d.time_enabled = time_enabled - start.time_enabled;
+            d.time_running = time_running - start.time_running;
+
+            double const scale = d.time_running == 0 ? 0.0
+                                 : d.time_enabled <= d.time_running ? 1.0
+                                 : static_cast<double>(d.time_enabled) / static_cast<double>(d.time_running);
+            d.cycles        = static_cast<std::uint64_t>((cycles - start.cycles) * scale);
+            d.llc_misses    = static_cast<std::uint64_t>((llc_misses - start.llc_misses) * scale);
+            d.dtlb_misses   = static_cast<std::uint64_t>((dtlb_misses - start.dtlb_misses) * scale);
+            d.branch_misses = static_cast<std::uint64_t>((branch_misses - start.branch_misses) * scale);
+            return d;
+        }
+    };
+
+    //! Hardware counters of the thread which constructs them, read by `perf_event_open` (Linux only).
+    //!
+    //! The counters are opened as one group led by the cycles, so that they are counted over the same time and read
+    //! at once (with the times to scale them if the hardware is multiplexed). A counter which the kernel or the
+    //! hardware does not support (or which does not fit in the group) is left out, the others are still available;
+    //! if the cycles are not available, the first available counter leads the group. The access may be restricted
+    //! by `perf_event_paranoid`. Only the user space of the constructing thread is counted: neither the other
+    //! threads (e.g., the workers of the parallel policies) nor the threads created later. The values of the
+    //! unavailable counters are zero.
+    class hardware_counters
+    {
+        public:
+            enum counter { cycles, llc_misses, dtlb_misses, branch_misses, count };
+
+            //! Open the counters for the calling thread.
+            hardware_counters()
+            {
+                for (int & fd : m_fds) fd = -1;
+                for (std::uint64_t & id : m_ids) id = 0;
+#ifdef JOINT_HAS_PERF_EVENTS
+                open(cycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+                open(llc_misses, PERF_TYPE_HW_CACHE,
+                     PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                     | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+                open(dtlb_misses, PERF_TYPE_HW_CACHE,
+                     PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                     | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+                open(branch_misses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+            }
+
+            hardware_counters(hardware_counters const &) = delete;
+            hardware_counters & operator=(hardware_counters const &) = delete;
+
+            ~hardware_counters()
+            {
+#ifdef JOINT_HAS_PERF_EVENTS
+                // The members of the group first, then its leader.
+                for (int fd : m_fds)
+                    if (fd >= 0 && fd != m_leader) ::close(fd);
+                if (m_leader >= 0) ::close(m_leader);
+#endif
+            }
+
+            //! Check whether the counter could be opened.
+            bool available(counter c) const { return m_fds[c] >= 0; }
+
+            //! Check whether any counter could be opened.
+            bool available() const { return m_leader >= 0; }
+
+            //! Read the current values of the counters (not scaled, see `counter_values::since()`).
+            counter_values read() const
+            {
+                counter_values values;
+#ifdef JOINT_HAS_PERF_EVENTS
+                if (m_leader < 0) return values;
+
+                // nr, time_enabled, time_running, {value, id} * nr
+                std::uint64_t buffer[3 + 2 * count];
+                ssize_t const size = ::read(m_leader, buffer, sizeof(buffer));
+                if (size < static_cast<ssize_t>(3 * sizeof(std::uint64_t))) return values;
+
+                std::uint64_t const n = std::min<std::uint64_t>(buffer[0], count);
+                values.time_enabled = buffer[1];
+                values.time_running = buffer[2];
+                for (std::uint64_t i = 0; i < n; ++i)
+                {
+                    std::uint64_t const value = buffer[3 + 2 * i], id = buffer[4 + 2 * i];
+                    if      (id == m_ids[cycles])        values.cycles        = value;
+                    else if (id == m_ids[llc_misses])    values.llc_misses    = value;
+                    else if (id == m_ids[dtlb_misses])   values.dtlb_misses   = value;
+                    else if (id == m_ids[branch_misses]) values.branch_misses = value;
+                }
+#endif
+                return values;
+            }
+
+        private:
+
+#ifdef JOINT_HAS_PERF_EVENTS
+            void open(counter c, std::uint32_t type, std::uint64_t config)
+            {
+                perf_event_attr attr;
+                std::memset(& attr, 0, sizeof(attr));
+                attr.size           = sizeof(attr);
+                attr.type           = type;
+                attr.config         = config;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv     = 1;
+                attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_ID | PERF_FORMAT_TOTAL_TIME_ENABLED
+                                      | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+                int const fd = static_cast<int>(::syscall(__NR_perf_event_open, & attr, 0, -1, m_leader, 0));
+                if (fd < 0) return;
+                if (::ioctl(fd, PERF_EVENT_IOC_ID, & m_ids[c]) != 0)
+                {
+                    ::close(fd);
+                    return;
+                }
+                m_fds[c] = fd;
+                if (m_leader < 0) m_leader = fd;
+            }
+#endif
+
+            int           m_fds[count];
+            std::uint64_t m_ids[count];
+            int           m_leader = -1;
+    };
+
+    //! A report of a finished phase.
+    struct phase_report
+    {
+        joint::phase   phase;
+        double         seconds;        // wall time
+        std::size_t    elements;       // number of the rows (or keys) processed
+        std::size_t    bytes;          // number of the bytes of the column entries moved (if known)
+        bool           has_counters;   // whether the hardware counters below were read
+        counter_values counters;       // differences of the hardware counters over the phase (scaled)
+    };
+
+    //! An observer of the phases of the algorithms (see `observe_scope`).
+    //!
+    //! The phases may nest (e.g., `sort` contains `permutation` when the rows are sorted as indices), the inner
+    //! ones are reported first. The phases are reported by the thread which called the algorithm, the work of the
+    //! parallel tasks is included in the wall time but not in the hardware counters.
+    class observer
+    {
+        public:
+            virtual ~observer() { }
+
+            //! Called when a phase is finished.
+            virtual void report(phase_report const & report) = 0;
+
+            //! The hardware counters to be read at the phase boundaries (none by default).
+            virtual hardware_counters const * counters() const { return nullptr; }
+    };
+
+    //! An observer collecting the reports (with the hardware counters if requested).
+    //!
+    //! The hardware counters are those of the thread which constructs the recorder (see `hardware_counters`), so
+    //! the recorder should be constructed and observed by the same thread.
+    class phase_recorder : public observer
+    {
+        public:
+            explicit phase_recorder(bool read_counters = false)
+                    : m_counters(read_counters ? new hardware_counters() : nullptr) { }
+
+            void report(phase_report const & report) override { m_reports.push_back(report); }
+
+            hardware_counters const * counters() const override { return m_counters.get(); }
+
+            //! The reports in the order of finishing the phases.
+            std::vector<phase_report> const & reports() const { return m_reports; }
+
+            //! Remove all the reports.
+            void clear() { m_reports.clear(); }
+
+        private:
+            std::unique_ptr<hardware_counters> m_counters;
+            std::vector<phase_report>          m_reports;
+    };
+
+    //! Print a report (one line).
+    inline std::ostream & operator<<(std::ostream & out, phase_report const & report)
+    {
+        out << phase_name(report.phase) << ": " << report.seconds * 1000 << " ms, " << report.elements
+            << " elements";
+        if (report.bytes > 0) out << ", " << report.bytes << " bytes";
+        if (report.has_counters)
+            out << ", " << report.counters.cycles << " cycles, " << report.counters.llc_misses << " LLC misses, "
+                << report.counters.dtlb_misses << " dTLB misses, " << report.counters.branch_misses
+                << " branch misses";
+        if (report.has_counters && report.counters.multiplexed())
+            out << " (scaled from " << 100.0 * report.counters.time_running / report.counters.time_enabled
+                << "% of the time)";
+        return out;
+    }
+
+    namespace detail
+    {
+
+        //! The observer of the calling thread.
+        inline observer *& current_observer()
+        {
+            static thread_local observer * current = nullptr;
+            return current;
+        }
+
+        //! Number of bytes of a row of the columns of the given iterators.
+        template<typename... Iterators>
+        struct row_bytes : std::integral_constant<std::size_t, 0> { };
+
+        template<typename Iterator, typename... Iterators>
+        struct row_bytes<Iterator, Iterators...>
+                : std::integral_constant<std::size_t,
+                                         sizeof(typename std::iterator_traits<Iterator>::value_type)
+                                         + row_bytes<Iterators...>::value>
+        {
+        };
+
+    }
+
+    //! Install an observer for the algorithms called by the current thread in the scope (the previous one is
+    //! restored at its end).
+    class observe_scope
+    {
+        public:
+            explicit observe_scope(observer & o)
+                    : m_previous(detail::current_observer())
+            {
+                detail::current_observer() = & o;
+            }
+
+            ~observe_scope() { detail::current_observer() = m_previous; }
+
+            observe_scope(observe_scope const &) = delete;
+            observe_scope & operator=(observe_scope const &) = delete;
+
+        private:
+            observer * m_previous;
+    };
+
+    //! Measure a phase from the construction to the destruction and report it to the observer of the thread.
+    //!
+    //! Without an observer, only the observer pointer is checked. It can be used to measure custom code as well,
+    //! e.g., the phases of a benchmark.
+    class phase_timer
+    {
+        public:
+            typedef std::chrono::steady_clock clock;
+
+            phase_timer(joint::phase p, std::size_t elements, std::size_t bytes = 0)
+                    : m_observer(detail::current_observer()), m_counters(nullptr)
+            {
+                if (!m_observer) return;
+
+                m_report.phase        = p;
+                m_report.elements     = elements;
+                m_report.bytes        = bytes;
+                m_report.has_counters = false;
+
+                m_counters = m_observer->counters();
+                if (m_counters && m_counters->available())
+                {
+                    m_report.has_counters = true;
+                    m_report.counters     = m_counters->read();
+                }
+                m_start = clock::now();
+            }
+
+            ~phase_timer()
+            {
+                if (!m_observer) return;
+
+                m_report.seconds = std::chrono::duration<double>(clock::now() - m_start).count();
+                if (m_report.has_counters)
+                {
+                    m_report.counters = m_counters->read().since(m_report.counters);
+                }
+                m_observer->report(m_report);
+            }
+
+            phase_timer(phase_timer const &) = delete;
+            phase_timer & operator=(phase_timer const &) = delete;
+
+        private:
+            observer                * m_observer;
+            hardware_counters const * m_counters;
+            phase_report              m_report;
+            clock::time_point         m_start;
+    };
+
+} // namespace joint
+
+#endif //JOINT_OBSERVER_HPP
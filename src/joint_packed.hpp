@@ -0,0 +1,441 @@
+//
+// Bit-packed (frame-of-reference encoded) integer columns usable in joint ranges.
+//
+
+#ifndef JOINT_PACKED_HPP
+#define JOINT_PACKED_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "joint_iterator.hpp"
+#include "joint_observer.hpp"
+#include "joint_permutation.hpp"
+#include "joint_scratch.hpp"
+#include "joint_sort.hpp"
+
+namespace joint
+{
+
+    template<typename T> class packed_column;
+
+    template<typename T, typename Column> class packed_iterator;
+
+    //! A proxy reference to an entry of a packed column (converts to the value and assigns the encoded value).
+    template<typename T, typename Column>
+    class packed_reference
+    {
+        public:
+            packed_reference(Column * column, std::size_t i)
+                    : m_column(column), m_i(i) { }
+
+            packed_reference(packed_reference const &) = default;
+
+            operator T() const { return m_column->get(m_i); }
+
+            packed_reference & operator=(T value)
+            {
+                m_column->set(m_i, value);
+                return * this;
+            }
+
+            //! Assign the value of another entry (not rebinding the reference, as for the ordinary references).
+            packed_reference & operator=(packed_reference const & other)
+            {
+                m_column->set(m_i, other.m_column->get(other.m_i));
+                return * this;
+            }
+
+            //! The "address" of the entry (so that the joint references can point to it).
+            packed_iterator<T, Column> operator&() const { return packed_iterator<T, Column>(m_column, m_i); }
+
+            friend void swap(packed_reference a, packed_reference b)
+            {
+                T value = a;
+                a = T(b);
+                b = value;
+            }
+
+        private:
+            Column    * m_column;
+            std::size_t m_i;
+    };
+
+    //! A random access iterator over the entries of a packed column.
+    //!
+    //! It serves as its own pointer type (see `packed_reference::operator&()`).
+    template<typename T, typename Column>
+    class packed_iterator
+    {
+        public:
+            typedef std::random_access_iterator_tag                      iterator_category;
+            typedef T                                                    value_type;
+            typedef std::ptrdiff_t                                       difference_type;
+            typedef packed_iterator                                      pointer;
+            typedef typename std::conditional<std::is_const<Column>::value, T,
+                                              packed_reference<T, Column>>::type reference;
+
+            packed_iterator()
+                    : m_column(nullptr), m_i(0) { }
+
+            packed_iterator(Column * column, std::size_t i)
+                    : m_column(column), m_i(i) { }
+
+            //! Conversion of a mutable iterator to a constant one.
+            template<typename C, typename = typename std::enable_if<std::is_same<C const, Column>::value>::type>
+            packed_iterator(packed_iterator<T, C> const & other)
+                    : m_column(other.column()), m_i(other.index()) { }
+
+            reference operator*() const { return reference_at(m_i); }
+            reference operator[](difference_type n) const { return reference_at(m_i + n); }
+
+            packed_iterator & operator++() { ++m_i; return * this; }
+            packed_iterator & operator--() { --m_i; return * this; }
+            packed_iterator operator++(int) { packed_iterator it(* this); ++m_i; return it; }
+            packed_iterator operator--(int) { packed_iterator it(* this); --m_i; return it; }
+
+            packed_iterator & operator+=(difference_type n) { m_i += n; return * this; }
+            packed_iterator & operator-=(difference_type n) { m_i -= n; return * this; }
+            packed_iterator operator+(difference_type n) const { return packed_iterator(m_column, m_i + n); }
+            packed_iterator operator-(difference_type n) const { return packed_iterator(m_column, m_i - n); }
+            friend packed_iterator operator+(difference_type n, packed_iterator it) { return it + n; }
+
+            difference_type operator-(packed_iterator const & other) const
+            {
+                return static_cast<difference_type>(m_i) - static_cast<difference_type>(other.m_i);
+            }
+
+            bool operator==(packed_iterator const & other) const { return m_i == other.m_i; }
+            bool operator!=(packed_iterator const & other) const { return m_i != other.m_i; }
+            bool operator<(packed_iterator const & other) const { return m_i < other.m_i; }
+            bool operator>(packed_iterator const & other) const { return m_i > other.m_i; }
+            bool operator<=(packed_iterator const & other) const { return m_i <= other.m_i; }
+            bool operator>=(packed_iterator const & other) const { return m_i >= other.m_i; }
+
+            //! The column of the iterator.
+            Column * column() const { return m_column; }
+
+            //! The index of the entry in the column.
+            std::size_t index() const { return m_i; }
+
+        private:
+            template<typename C = Column>
+            typename std::enable_if<std::is_const<C>::value, T>::type reference_at(std::size_t i) const
+            {
+                return m_column->get(i);
+            }
+
+            template<typename C = Column>
+            typename std::enable_if<!std::is_const<C>::value, packed_reference<T, C>>::type
+            reference_at(std::size_t i) const
+            {
+                return packed_reference<T, C>(m_column, i);
+            }
+
+            Column    * m_column;
+            std::size_t m_i;
+    };
+
+    //! A column of integers stored in `bits()` bits each as the differences from `base()` (frame of reference).
+    //!
+    //! The codes (the differences) are packed one after another into 64-bit words, an entry spanning two words is
+    //! read by two loads. E.g., timestamps or ids needing 20 to 40 bits take a third to a half of the memory of
+    //! `long`. The iterators are random access with proxy references, hence the column can take part in joint
+    //! ranges (e.g., `joint::make_joint(packed.begin(), payload.begin())`). The entries sharing a word must not be
+    //! written concurrently: use the sequential policy for the parallel algorithms writing the column.
+    template<typename T>
+    class packed_column
+    {
+            static_assert(std::is_integral<T>::value, "Only integers can be packed.");
+
+        public:
+            typedef T                                       value_type;
+            typedef std::size_t                             size_type;
+            typedef packed_iterator<T, packed_column>       iterator;
+            typedef packed_iterator<T, packed_column const> const_iterator;
+            typedef packed_reference<T, packed_column>      reference;
+
+        public:
+
+            //! Create an empty column of the entries in `[base, base + 2^bits)`.
+            //!
+            //! By default, the column takes all the values of `T` (the base is the least value of `T`, so that the
+            //! negative values fit as well and the codes keep the order of the values).
+            explicit packed_column(T base = std::numeric_limits<T>::min(), unsigned bits = 8 * sizeof(T))
+                    : m_base(base), m_bits(bits), m_mask(bits == 64 ? ~std::uint64_t(0)
+                                                                    : (std::uint64_t(1) << bits) - 1),
+                      m_size(0)
+            {
+                assert(bits <= 64);
+            }
+
+            //! Encode the values of a range with the least base and number of bits.
+            template<typename ForwardIterator>
+            static packed_column encode(ForwardIterator first, ForwardIterator last)
+            {
+                if (first == last) return packed_column();
+
+                auto const range = std::minmax_element(first, last);
+                T const    min   = * range.first;
+
+                std::uint64_t span = static_cast<std::uint64_t>(* range.second) - static_cast<std::uint64_t>(min);
+                unsigned      bits = 0;
+                for (; span != 0; span >>= 1) ++bits;
+
+                packed_column column(min, bits);
+                column.reserve(std::distance(first, last));
+                for (; first != last; ++first) column.push_back(* first);
+                return column;
+            }
+
+            //! The least representable value.
+            T base() const { return m_base; }
+
+            //! Number of bits per entry.
+            unsigned bits() const { return m_bits; }
+
+            //! Number of entries.
+            size_type size() const { return m_size; }
+
+            //! Check whether there are no entries.
+            bool empty() const { return m_size == 0; }
+
+            //! Number of bytes taken by the packed entries.
+            std::size_t bytes() const { return m_words.size() * sizeof(std::uint64_t); }
+
+            //! The packed words.
+            std::uint64_t const * words() const { return m_words.data(); }
+
+            //! Check whether the value can be stored.
+            bool fits(T value) const { return code_of(value) <= m_mask; }
+
+            //! Reserve the storage for `n` entries.
+            void reserve(size_type n) { m_words.reserve(word_count(n)); }
+
+            //! Resize to `n` entries (the new entries are `base()`).
+            void resize(size_type n)
+            {
+                std::size_t const words = m_words.size();
+                m_words.resize(word_count(n), 0);
+
+                // The new words are zero already, the rest of the last old word may hold codes of removed entries.
+                for (size_type i = m_size; i < n && i * m_bits < words * 64; ++i) store(i, 0);
+                m_size = n;
+            }
+
+            //! Append a value (it must fit, see `fits()`).
+            void push_back(T value)
+            {
+                assert(fits(value));
+                m_words.resize(word_count(m_size + 1), 0);
+                store(m_size++, code_of(value));
+            }
+
+            //! Remove all the entries.
+            void clear()
+            {
+                m_words.clear();
+                m_size = 0;
+            }
+
+            //! The `i`-th value.
+            T get(size_type i) const { return static_cast<T>(static_cast<std::uint64_t>(m_base) + code(i)); }
+
+            //! Set the `i`-th value (it must fit, see `fits()`).
+            void set(size_type i, T value)
+            {
+                assert(fits(value));
+                store(i, code_of(value));
+            }
+
+            //! The code (the difference from the base) of the `i`-th entry.
+            std::uint64_t code(size_type i) const
+            {
+                if (m_bits == 0) return 0;
+
+                std::size_t const bit = i * m_bits, k = bit / 64;
+                unsigned const    s   = bit % 64;
+
+                std::uint64_t value = m_words[k] >> s;
+                if (s + m_bits > 64) value |= m_words[k + 1] << (64 - s);
+                return value & m_mask;
+            }
+
+            //! Set the code of the `i`-th entry.
+            void store(size_type i, std::uint64_t code)
+            {
+                if (m_bits == 0) return;
+
+                std::size_t const bit = i * m_bits, k = bit / 64;
+                unsigned const    s   = bit % 64;
+
+                m_words[k] = (m_words[k] & ~(m_mask << s)) | (code << s);
+                if (s + m_bits > 64)
+                    m_words[k + 1] = (m_words[k + 1] & ~(m_mask >> (64 - s))) | (code >> (64 - s));
+            }
+
+            //! Unpack the codes of the entries `[first, first + n)` (sequentially, word by word).
+            template<typename OutputIterator>
+            OutputIterator unpack(size_type first, size_type n, OutputIterator output) const
+            {
+                for (size_type i = first; i < first + n; ++i) * output++ = code(i);
+                return output;
+            }
+
+            //! The code of a value (the values below the base wrap around to large codes).
+            std::uint64_t code_of(T value) const
+            {
+                return static_cast<std::uint64_t>(value) - static_cast<std::uint64_t>(m_base);
+            }
+
+            //! First entry not less than the value in a column sorted in the ascending order.
+            //!
+            //! The binary search compares the codes, the entries are not decoded.
+            const_iterator lower_bound(T value) const
+            {
+                if (value < m_base) return begin();
+                std::uint64_t const c = code_of(value);
+                return const_iterator(this, search(c, [](std::uint64_t a, std::uint64_t b) { return a < b; }));
+            }
+
+            //! First entry greater than the value in a column sorted in the ascending order (see above).
+            const_iterator upper_bound(T value) const
+            {
+                if (value < m_base) return begin();
+                std::uint64_t const c = code_of(value);
+                return const_iterator(this, search(c, [](std::uint64_t a, std::uint64_t b) { return a <= b; }));
+            }
+
+            iterator begin() { return iterator(this, 0); }
+            iterator end() { return iterator(this, m_size); }
+            const_iterator begin() const { return const_iterator(this, 0); }
+            const_iterator end() const { return const_iterator(this, m_size); }
+
+            reference operator[](size_type i) { return reference(this, i); }
+            T operator[](size_type i) const { return get(i); }
+
+        private:
+
+            std::size_t word_count(size_type n) const { return (n * m_bits + 63) / 64; }
+
+            //! Index of the first entry for which `before(code, c)` does not hold.
+            template<typename Before>
+            size_type search(std::uint64_t c, Before before) const
+            {
+                size_type first = 0, n = m_size;
+                while (n > 0)
+                {
+                    size_type const half = n / 2;
+                    if (before(code(first + half), c))
+                    {
+                        first += half + 1;
+                        n     -= half + 1;
+                    }
+                    else
+                        n = half;
+                }
+                return first;
+            }
+
+            T                          m_base;
+            unsigned                   m_bits;
+            std::uint64_t              m_mask;
+            size_type                  m_size;
+            std::vector<std::uint64_t> m_words;
+    };
+
+    namespace detail
+    {
+
+        //! Number of bits of a digit of the radix sort of the packed keys.
+        constexpr unsigned packed_radix_bits = 11;
+
+        //! Sorting by a packed key column: the LSD radix sort of the codes (see `key_sorter`).
+        //!
+        //! The codes are unpacked once (the values are not decoded) and sorted with their row indices by a digit
+        //! of `packed_radix_bits` bits per pass, hence 20 to 40 bit keys take 2 to 4 passes. The passes whose digit
+        //! is the same for all the keys are skipped. The rows are permuted once at the end. The sort is stable.
+        template<typename T>
+        struct packed_key_sorter
+        {
+            struct entry
+            {
+                std::uint64_t code;
+                std::size_t   index;
+            };
+
+            template<size_t I, typename... Iterators, typename Compare>
+            static void sort(iterator<Iterators...> first, iterator<Iterators...> last, Compare &,
+                             memory_resource * resource)
+            {
+                auto                     keys   = first.template get<I>();
+                packed_column<T> const & column = * keys.column();
+                std::size_t const        n      = last - first;
+
+                scratch_vector<entry> entries{scratch_allocator<entry>(resource)};
+                bool                  sorted = true;
+                {
+                    phase_timer timer(phase::key_extraction, n);
+                    entries.reserve(n);
+                    for (std::size_t i = 0; i < n; ++i)
+                    {
+                        entries.push_back(entry{column.code(keys.index() + i), i});
+                        sorted = sorted && (i == 0 || entries[i - 1].code <= entries[i].code);
+                    }
+                }
+                if (sorted) return;
+
+                scratch_vector<std::size_t> permutation{scratch_allocator<std::size_t>(resource)};
+                {
+                    phase_timer timer(phase::sort, n);
+
+                    scratch_vector<entry>       buffer(n, entry(), scratch_allocator<entry>(resource));
+                    scratch_vector<std::size_t> offsets(std::size_t(1) << packed_radix_bits, 0,
+                                                        scratch_allocator<std::size_t>(resource));
+                    std::uint64_t const         mask = offsets.size() - 1;
+
+                    for (unsigned shift = 0; shift < column.bits(); shift += packed_radix_bits)
+                    {
+                        std::fill(offsets.begin(), offsets.end(), 0);
+                        for (auto & e : entries) ++offsets[(e.code >> shift) & mask];
+                        if (offsets[(entries[0].code >> shift) & mask] == n) continue;
+
+                        std::size_t sum = 0;
+                        for (auto & offset : offsets)
+                        {
+                            std::size_t const count = offset;
+                            offset = sum;
+                            sum   += count;
+                        }
+                        for (auto & e : entries) buffer[offsets[(e.code >> shift) & mask]++] = e;
+                        entries.swap(buffer);
+                    }
+
+                    permutation.reserve(n);
+                    for (auto & e : entries) permutation.push_back(e.index);
+                }
+
+                permute(first, last, permutation.begin(), resource);
+            }
+        };
+
+        //! Packed key columns in the ascending order are sorted by the radix sort of their codes.
+        template<typename T>
+        struct key_sorter<packed_iterator<T, packed_column<T>>, less> : packed_key_sorter<T> { };
+
+        //! Packed key columns in the ascending order are sorted by the radix sort of their codes.
+        template<typename T>
+        struct key_sorter<packed_iterator<T, packed_column<T>>, std::less<T>> : packed_key_sorter<T> { };
+
+    }
+
+} // namespace joint
+
+#endif //JOINT_PACKED_HPP
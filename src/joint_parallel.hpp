@@ -0,0 +1,245 @@
+//
+// Parallel execution support for the joint algorithms.
+//
+
+#ifndef JOINT_PARALLEL_HPP
+#define JOINT_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace joint
+{
+
+    //! A simple pool of worker threads executing batches of indexed tasks.
+    //!
+    //! A batch of `n` tasks is published to the workers which claim the task indices from a shared atomic counter,
+    //! hence faster workers simply take more tasks. The calling thread takes part in the execution as well, so
+    //! a batch always completes even if all the workers are busy (this also makes nested batches safe).
+    class thread_pool
+    {
+        public:
+
+            //! Create a pool with `threads` threads in total (the calling thread included).
+            explicit thread_pool(unsigned threads = std::thread::hardware_concurrency())
+                    : m_generation(0), m_stop(false)
+            {
+                for (unsigned i = 1; i < threads; ++i)
+                    m_workers.emplace_back(&thread_pool::work, this);
+            }
+
+            thread_pool(thread_pool const &) = delete;
+            thread_pool & operator=(thread_pool const &) = delete;
+
+            //! Stop and join the workers.
+            ~thread_pool()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stop = true;
+                }
+                m_wake.notify_all();
+                for (auto & worker : m_workers) worker.join();
+            }
+
+            //! Number of threads executing the tasks (the calling thread included).
+            unsigned size() const { return static_cast<unsigned>(m_workers.size()) + 1; }
+
+            //! Execute `f(i)` for `i = 0, ..., n - 1` and wait for all the tasks to complete.
+            //!
+            //! The first exception thrown by a task is rethrown in the calling thread.
+            template<typename F>
+            void run(std::size_t n, F f)
+            {
+                if (n == 0) return;
+
+                if (n == 1 || m_workers.empty())
+                {
+                    for (std::size_t i = 0; i < n; ++i) f(i);
+                    return;
+                }
+
+                auto job = std::make_shared<batch>(n, std::function<void(std::size_t)>(f));
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_batch = job;
+                    ++m_generation;
+                }
+                m_wake.notify_all();
+
+                execute(* job);
+
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_done.wait(lock, [&]() { return job->completed.load() == job->tasks; });
+                    if (m_batch == job) m_batch.reset();
+                }
+
+                if (job->error) std::rethrow_exception(job->error);
+            }
+
+            //! The shared pool used by the algorithms if no other pool is given.
+            static thread_pool & instance()
+            {
+                static thread_pool pool;
+                return pool;
+            }
+
+        private:
+
+            struct batch
+            {
+                batch(std::size_t n, std::function<void(std::size_t)> f)
+                        : tasks(n), function(std::move(f)), next(0), completed(0) { }
+
+                std::size_t                       tasks;
+                std::function<void(std::size_t)>  function;
+                std::atomic<std::size_t>          next;
+                std::atomic<std::size_t>          completed;
+                std::exception_ptr                error;
+                std::mutex                        error_mutex;
+            };
+
+            //! Claim and execute the tasks of a batch until there are none left.
+            void execute(batch & job)
+            {
+                for (std::size_t i = job.next++; i < job.tasks; i = job.next++)
+                {
+                    try
+                    {
+                        job.function(i);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock(job.error_mutex);
+                        if (!job.error) job.error = std::current_exception();
+                    }
+
+                    if (++job.completed == job.tasks)
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_done.notify_all();
+                    }
+                }
+            }
+
+            //! The worker loop.
+            void work()
+            {
+                std::size_t seen = 0;
+                for (;;)
+                {
+                    std::shared_ptr<batch> job;
+                    {
+                        std::unique_lock<std::mutex> lock(m_mutex);
+                        m_wake.wait(lock, [&]() { return m_stop || m_generation != seen; });
+                        if (m_stop) return;
+                        seen = m_generation;
+                        job  = m_batch;
+                    }
+                    if (job) execute(* job);
+                }
+            }
+
+            std::vector<std::thread> m_workers;
+            std::mutex               m_mutex;
+            std::condition_variable  m_wake;
+            std::condition_variable  m_done;
+            std::shared_ptr<batch>   m_batch;
+            std::size_t              m_generation;
+            bool                     m_stop;
+    };
+
+    //! Execution policy requesting a sequential execution.
+    struct sequential_policy { };
+
+    //! Execution policy requesting a parallel execution on a thread pool.
+    struct parallel_policy
+    {
+        //! Use the given pool (or the shared pool if null).
+        constexpr explicit parallel_policy(thread_pool * pool = nullptr)
+                : pool(pool) { }
+
+        thread_pool * pool;
+    };
+
+    //! The sequential policy object.
+    constexpr sequential_policy seq{};
+
+    //! The parallel policy object (uses the shared pool).
+    constexpr parallel_policy par{};
+
+    //! Check whether a type is one of the execution policies.
+    template<typename T>
+    struct is_execution_policy
+            : std::integral_constant<bool,
+                                     std::is_same<typename std::decay<T>::type, sequential_policy>::value
+                                     || std::is_same<typename std::decay<T>::type, parallel_policy>::value>
+    {
+    };
+
+    namespace detail
+    {
+
+        //! Minimal number of elements per chunk worth to be processed by a separate task.
+        constexpr std::size_t default_grain = 16384;
+
+        //! Number of threads executing the tasks of the policy.
+        inline unsigned thread_count(sequential_policy) { return 1; }
+
+        //! Number of threads executing the tasks of the policy.
+        inline unsigned thread_count(parallel_policy const & policy)
+        {
+            return policy.pool ? policy.pool->size() : thread_pool::instance().size();
+        }
+
+        //! Number of chunks the range of `n` elements is split into.
+        inline std::size_t chunk_count(sequential_policy, std::size_t, std::size_t = default_grain)
+        {
+            return 1;
+        }
+
+        //! Number of chunks the range of `n` elements is split into.
+        inline std::size_t chunk_count(parallel_policy const & policy, std::size_t n,
+                                       std::size_t grain = default_grain)
+        {
+            thread_pool & pool = policy.pool ? * policy.pool : thread_pool::instance();
+            std::size_t chunks = std::min<std::size_t>((n + grain - 1) / grain, 4 * pool.size());
+            return std::max<std::size_t>(chunks, 1);
+        }
+
+        //! Begin of the `c`-th of `chunks` chunks of a range of `n` elements.
+        inline std::size_t chunk_begin(std::size_t c, std::size_t chunks, std::size_t n)
+        {
+            return static_cast<std::size_t>(static_cast<unsigned long long>(n) * c / chunks);
+        }
+
+        //! Execute `f(c)` for each chunk index `c` sequentially.
+        template<typename F>
+        void for_each_chunk(sequential_policy, std::size_t chunks, F f)
+        {
+            for (std::size_t c = 0; c < chunks; ++c) f(c);
+        }
+
+        //! Execute `f(c)` for each chunk index `c` on the pool of the policy.
+        template<typename F>
+        void for_each_chunk(parallel_policy const & policy, std::size_t chunks, F f)
+        {
+            thread_pool & pool = policy.pool ? * policy.pool : thread_pool::instance();
+            pool.run(chunks, f);
+        }
+
+    }
+
+} // namespace joint
+
+#endif //JOINT_PARALLEL_HPP
@@ -0,0 +1,314 @@
+//
+// Partitioning and filtering of joint ranges by a predicate on a single key column.
+//
+
+#ifndef JOINT_PARTITION_HPP
+#define JOINT_PARTITION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "joint_iterator.hpp"
+#include "joint_columns.hpp"
+#include "joint_observer.hpp"
+#include "joint_parallel.hpp"
+#include "joint_scratch.hpp"
+
+namespace joint
+{
+
+    namespace detail
+    {
+
+        //! Selection of the rows of a range computed in chunks.
+        //!
+        //! The mask holds one byte per row (so that the chunks can be written concurrently) and `offsets[c]` is the
+        //! number of selected rows in the chunks preceding the chunk `c` (the last entry is the total count).
+        struct selection
+        {
+            explicit selection(memory_resource * resource)
+                    : size(0), chunks(0), mask(scratch_allocator<unsigned char>(resource)),
+                      offsets(scratch_allocator<std::size_t>(resource)) { }
+
+            std::size_t                   size;
+            std::size_t                   chunks;
+            scratch_vector<unsigned char> mask;
+            scratch_vector<std::size_t>   offsets;
+
+            std::size_t begin(std::size_t c) const { return chunk_begin(c, chunks, size); }
+            std::size_t end(std::size_t c) const { return chunk_begin(c + 1, chunks, size); }
+            std::size_t count() const { return offsets[chunks]; }
+        };
+
+        //! Evaluate the predicate on the key column and fill in the selection.
+        template<typename Policy, typename KeyIterator, typename Predicate>
+        void select(Policy const & policy, KeyIterator key, std::size_t n, Predicate pred, selection & s)
+        {
+            s.size   = n;
+            s.chunks = chunk_count(policy, n);
+            s.mask.resize(n);
+            s.offsets.assign(s.chunks + 1, 0);
+
+            for_each_chunk(policy, s.chunks, [&](std::size_t c)
+            {
+                std::size_t count = 0;
+                for (std::size_t i = s.begin(c), e = s.end(c); i < e; ++i)
+                {
+                    bool selected = pred(key[i]) ? true : false;
+                    s.mask[i] = selected;
+                    count += selected;
+                }
+                s.offsets[c + 1] = count;
+            });
+
+            for (std::size_t c = 0; c < s.chunks; ++c) s.offsets[c + 1] += s.offsets[c];
+        }
+
+        //! Stable partition of a column: scatter the selected rows to the front and the rest behind them.
+        //!
+        //! The entries which can be moved without exceptions are scattered in parallel chunks through a raw buffer.
+        //! The others are buffered sequentially in a `scratch_vector`, so that an exception thrown by a move
+        //! leaves no entries to destroy nor storage to release behind (the column is then in a valid but
+        //! unspecified state).
+        template<typename Policy>
+        struct selection_scatterer
+        {
+            Policy const    & policy;
+            selection const & s;
+            memory_resource * resource;
+
+            template<typename I> void operator()(I column)
+            {
+                typedef typename std::iterator_traits<I>::value_type value_type;
+                typedef typename std::iterator_traits<I>::reference  reference;
+
+                scatter(column, std::integral_constant<bool,
+                        std::is_nothrow_constructible<value_type, decltype(std::move(std::declval<reference>()))>::value
+                        && std::is_nothrow_assignable<reference, value_type &&>::value
+                        && std::is_nothrow_destructible<value_type>::value>());
+            }
+
+            template<typename I> void scatter(I column, std::true_type)
+            {
+                typedef typename std::iterator_traits<I>::value_type value_type;
+
+                // The buffer is left uninitialized and the entries are move constructed into it, so that the
+                // values need not be default constructible.
+                value_type * buffer = static_cast<value_type *>(resource->allocate(s.size * sizeof(value_type),
+                                                                                   alignof(value_type)));
+                std::size_t const selected = s.count();
+
+                for_each_chunk(policy, s.chunks, [&](std::size_t c)
+                {
+                    std::size_t t = s.offsets[c];
+                    std::size_t f = selected + s.begin(c) - s.offsets[c];
+                    for (std::size_t i = s.begin(c), e = s.end(c); i < e; ++i)
+                        ::new (static_cast<void *>(buffer + (s.mask[i] ? t++ : f++))) value_type(std::move(column[i]));
+                });
+
+                for_each_chunk(policy, s.chunks, [&](std::size_t c)
+                {
+                    for (std::size_t i = s.begin(c), e = s.end(c); i < e; ++i)
+                    {
+                        column[i] = std::move(buffer[i]);
+                        buffer[i].~value_type();
+                    }
+                });
+
+                resource->deallocate(buffer, s.size * sizeof(value_type), alignof(value_type));
+            }
+
+            template<typename I> void scatter(I column, std::false_type)
+            {
+                typedef typename std::iterator_traits<I>::value_type value_type;
+
+                scratch_vector<value_type> buffer{scratch_allocator<value_type>(resource)};
+                buffer.reserve(s.size);
+                for (std::size_t i = 0; i < s.size; ++i)
+                    if (s.mask[i]) buffer.emplace_back(std::move(column[i]));
+                for (std::size_t i = 0; i < s.size; ++i)
+                    if (!s.mask[i]) buffer.emplace_back(std::move(column[i]));
+
+                std::move(buffer.begin(), buffer.end(), column);
+            }
+        };
+
+        //! Swap the column entries at the positions given by two index vectors.
+        template<typename Policy>
+        struct index_pair_swapper
+        {
+            Policy const                      & policy;
+            scratch_vector<std::size_t> const & left;
+            scratch_vector<std::size_t> const & right;
+
+            template<typename I> void operator()(I column)
+            {
+                std::size_t const n      = left.size();
+                std::size_t const chunks = chunk_count(policy, n);
+
+                for_each_chunk(policy, chunks, [&](std::size_t c)
+                {
+                    using std::swap;
+
+                    for (std::size_t j = chunk_begin(c, chunks, n), e = chunk_begin(c + 1, chunks, n); j < e; ++j)
+                        swap(column[left[j]], column[right[j]]);
+                });
+            }
+        };
+
+        //! Copy the selected column entries to the output column.
+        template<typename Policy>
+        struct selection_gatherer
+        {
+            Policy const    & policy;
+            selection const & s;
+
+            template<typename O, typename I> void operator()(O output, I column)
+            {
+                for_each_chunk(policy, s.chunks, [&](std::size_t c)
+                {
+                    O out = output + s.offsets[c];
+                    for (std::size_t i = s.begin(c), e = s.end(c); i < e; ++i)
+                        if (s.mask[i]) * out++ = column[i];
+                });
+            }
+        };
+
+    }
+
+    //! Partition the range so that the rows whose I-th column satisfies the predicate precede the others.
+    //!
+    //! The predicate is evaluated on the key column only (in parallel chunks). The misplaced rows are then paired
+    //! up using prefix sums and swapped column by column. The relative order of the rows is not preserved.
+    //! Returns the iterator to the first row of the second group.
+    template<size_t I, typename Policy, typename... Iterators, typename Predicate>
+    iterator<Iterators...> partition_by(Policy const & policy, iterator<Iterators...> first,
+                                        iterator<Iterators...> last, Predicate pred,
+                                        memory_resource * resource = default_resource())
+    {
+        std::size_t const n = last - first;
+
+        detail::selection s(resource);
+        detail::select(policy, first.template get<I>(), n, pred, s);
+        std::size_t const m = s.count();
+
+        // Selected rows behind the partition point are exchanged with the unselected rows in front of it.
+        scratch_vector<std::size_t> offsets_left(s.chunks + 1, 0, scratch_allocator<std::size_t>(resource));
+        scratch_vector<std::size_t> offsets_right(s.chunks + 1, 0, scratch_allocator<std::size_t>(resource));
+        detail::for_each_chunk(policy, s.chunks, [&](std::size_t c)
+        {
+            for (std::size_t i = s.begin(c), e = s.end(c); i < e; ++i)
+            {
+                if (i < m && !s.mask[i]) ++offsets_left[c + 1];
+                else if (i >= m && s.mask[i]) ++offsets_right[c + 1];
+            }
+        });
+        for (std::size_t c = 0; c < s.chunks; ++c)
+        {
+            offsets_left[c + 1]  += offsets_left[c];
+            offsets_right[c + 1] += offsets_right[c];
+        }
+
+        scratch_vector<std::size_t> left(offsets_left[s.chunks], 0, scratch_allocator<std::size_t>(resource));
+        scratch_vector<std::size_t> right(offsets_right[s.chunks], 0, scratch_allocator<std::size_t>(resource));
+        detail::for_each_chunk(policy, s.chunks, [&](std::size_t c)
+        {
+            std::size_t l = offsets_left[c], r = offsets_right[c];
+            for (std::size_t i = s.begin(c), e = s.end(c); i < e; ++i)
+            {
+                if (i < m && !s.mask[i]) left[l++] = i;
+                else if (i >= m && s.mask[i]) right[r++] = i;
+            }
+        });
+
+        auto iterators = first.iterators();
+        detail::for_each_one_tuple(iterators, detail::index_pair_swapper<Policy>{policy, left, right});
+
+        return first + m;
+    }
+
+    //! Partition the range in parallel (see above).
+    template<size_t I, typename... Iterators, typename Predicate>
+    iterator<Iterators...> partition_by(iterator<Iterators...> first, iterator<Iterators...> last, Predicate pred,
+                                        memory_resource * resource = default_resource())
+    {
+        return partition_by<I>(par, first, last, pred, resource);
+    }
+
+    //! Stable version of `partition_by`.
+    //!
+    //! The predicate is evaluated on the key column only (in parallel chunks) and every column is then compacted
+    //! by a prefix-sum scatter through a buffer of one column (taken from `resource`). Returns the iterator to
+    //! the first row of the second group.
+    template<size_t I, typename Policy, typename... Iterators, typename Predicate>
+    iterator<Iterators...> stable_partition_by(Policy const & policy, iterator<Iterators...> first,
+                                               iterator<Iterators...> last, Predicate pred,
+                                               memory_resource * resource = default_resource())
+    {
+        std::size_t const n = last - first;
+        phase_timer       timer(phase::partition, n, n * detail::row_bytes<Iterators...>::value);
+
+        detail::selection s(resource);
+        detail::select(policy, first.template get<I>(), n, pred, s);
+
+        if (s.count() != 0 && s.count() != n)
+        {
+            auto iterators = first.iterators();
+            detail::for_each_one_tuple(iterators, detail::selection_scatterer<Policy>{policy, s, resource});
+        }
+
+        return first + s.count();
+    }
+
+    //! Stable partition of the range in parallel (see above).
+    template<size_t I, typename... Iterators, typename Predicate>
+    iterator<Iterators...> stable_partition_by(iterator<Iterators...> first, iterator<Iterators...> last,
+                                               Predicate pred, memory_resource * resource = default_resource())
+    {
+        return stable_partition_by<I>(par, first, last, pred, resource);
+    }
+
+    //! Copy the rows whose I-th column satisfies the predicate into the columns `output` (replacing its content).
+    //!
+    //! The relative order of the rows is preserved. Returns the number of the copied rows.
+    template<size_t I, typename Policy, typename... Iterators, typename Predicate, template<typename> class A,
+             typename... Ts>
+    std::size_t filter(Policy const & policy, iterator<Iterators...> first, iterator<Iterators...> last,
+                       Predicate pred, basic_columns<A, Ts...> & output,
+                       memory_resource * resource = default_resource())
+    {
+        static_assert(sizeof...(Iterators) == sizeof...(Ts), "The number of the output columns does not match.");
+
+        std::size_t const n = last - first;
+        phase_timer       timer(phase::gather, n);
+
+        detail::selection s(resource);
+        detail::select(policy, first.template get<I>(), n, pred, s);
+
+        output.resize(s.count());
+
+        auto sources = first.iterators();
+        auto targets = output.begin().iterators();
+        detail::for_each_two_tuples_rhs_nonconst_lvalue(targets, sources,
+                                                        detail::selection_gatherer<Policy>{policy, s});
+
+        return s.count();
+    }
+
+    //! Filter the range in parallel (see above).
+    template<size_t I, typename... Iterators, typename Predicate, template<typename> class A, typename... Ts>
+    std::size_t filter(iterator<Iterators...> first, iterator<Iterators...> last, Predicate pred,
+                       basic_columns<A, Ts...> & output, memory_resource * resource = default_resource())
+    {
+        return filter<I>(par, first, last, pred, output, resource);
+    }
+
+} // namespace joint
+
+#endif //JOINT_PARTITION_HPP
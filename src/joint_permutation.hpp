@@ -0,0 +1,87 @@
+//
+// Applying permutations to joint ranges.
+//
+
+#ifndef JOINT_PERMUTATION_HPP
+#define JOINT_PERMUTATION_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "joint_iterator.hpp"
+#include "joint_observer.hpp"
+#include "joint_scratch.hpp"
+
+namespace joint
+{
+
+    namespace detail
+    {
+
+        //! Permute a column such that its `i`-th entry becomes the `permutation[i]`-th original one.
+        //!
+        //! The entries are gathered into a buffer of the column and moved back afterwards (the contiguous columns of
+        //! trivially relocatable entries are relocated bytewise instead).
+        template<typename IndexIterator>
+        struct permutation_gatherer
+        {
+            IndexIterator     permutation;
+            std::size_t       n;
+            memory_resource * resource;
+
+            template<typename I> void operator()(I column)
+            {
+                typedef typename std::iterator_traits<I>::value_type value_type;
+
+                gather(column, std::integral_constant<bool, is_contiguous_iterator<I>::value
+                                                            && is_trivially_relocatable<value_type>::value>());
+            }
+
+            template<typename I> void gather(I column, std::false_type)
+            {
+                typedef typename std::iterator_traits<I>::value_type value_type;
+
+                scratch_vector<value_type> buffer{scratch_allocator<value_type>(resource)};
+                buffer.reserve(n);
+
+                for (std::size_t i = 0; i < n; ++i) buffer.push_back(std::move(column[permutation[i]]));
+                std::move(buffer.begin(), buffer.end(), column);
+            }
+
+            //! The relocatable entries are gathered bytewise and copied back by a single `memcpy`.
+            template<typename I> void gather(I column, std::true_type)
+            {
+                typedef typename std::iterator_traits<I>::value_type value_type;
+
+                value_type                    * data = & * column;
+                relocation_buffer<value_type>   buffer(n, resource);
+
+                for (std::size_t i = 0; i < n; ++i) relocate(buffer.data() + i, data + permutation[i], 1);
+                relocate(data, buffer.data(), n);
+            }
+        };
+
+    }
+
+    //! Permute the rows of a joint range such that the `i`-th row becomes the `permutation[i]`-th original one.
+    //!
+    //! This is the way to apply an order computed by sorting indices (e.g., `permutation` sorted by the keys):
+    //! each column is gathered through a single column buffer taken from `resource`, so each entry is moved
+    //! exactly twice.
+    template<typename... Iterators, typename IndexIterator>
+    void permute(iterator<Iterators...> first, iterator<Iterators...> last, IndexIterator permutation,
+                 memory_resource * resource = default_resource())
+    {
+        std::size_t const n = last - first;
+        phase_timer       timer(phase::permutation, n, n * detail::row_bytes<Iterators...>::value);
+
+        auto iterators = first.iterators();
+        detail::for_each_one_tuple(iterators,
+                                   detail::permutation_gatherer<IndexIterator>{permutation, n, resource});
+    }
+
+} // namespace joint
+
+#endif //JOINT_PERMUTATION_HPP
@@ -0,0 +1,189 @@
+//
+// Priority queue of rows keeping the payload columns in place.
+//
+
+#ifndef JOINT_PRIORITY_QUEUE_HPP
+#define JOINT_PRIORITY_QUEUE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "joint_iterator.hpp"
+#include "joint_columns.hpp"
+
+namespace joint
+{
+
+    namespace detail
+    {
+
+        //! Number of children of a node of the heap (the children of a node share a cache line).
+        constexpr std::size_t heap_arity = 4;
+
+        template<typename C, typename... Args, size_t... Is>
+        void assign_row_impl(C & columns, std::size_t row, sequence<Is...>, Args &&... args)
+        {
+            auto l = {(columns.template get<Is>()[row] = std::forward<Args>(args), 0)...};
+            (void) l;
+        }
+
+    }
+
+    //! A priority queue of rows given by a key and payload columns.
+    //!
+    //! The heap is kept on an array of the keys and the slots of the payloads, the payloads themselves are stored
+    //! in `joint::columns` and never move while in the queue, hence a sift step moves a key and a 32-bit slot only.
+    //! The heap is `detail::heap_arity`-ary. As for `std::priority_queue`, the top is the greatest key according to
+    //! the comparator (use e.g. `std::greater<Key>` to get the least key on the top). The payloads of the popped rows
+    //! are released (reset to the default values) and their slots are reused by the next pushes.
+    template<typename Compare, typename Key, typename... Payload>
+    class basic_priority_queue
+    {
+            static_assert(sizeof...(Payload) > 0, "At least one payload column is required.");
+
+        public:
+            typedef Key                              key_type;
+            typedef columns<Payload...>              payload_type;
+            typedef typename payload_type::reference reference;
+            typedef std::size_t                      size_type;
+
+        public:
+
+            //! Create an empty queue.
+            explicit basic_priority_queue(Compare comp = Compare())
+                    : m_comp(comp) { }
+
+            //! Number of rows in the queue.
+            size_type size() const { return m_heap.size(); }
+
+            //! Check whether the queue is empty.
+            bool empty() const { return m_heap.empty(); }
+
+            //! Reserve the storage for `n` rows.
+            void reserve(size_type n)
+            {
+                m_heap.reserve(n);
+                m_payload.reserve(n);
+                m_free.reserve(n);
+            }
+
+            //! Remove all the rows (and their payloads).
+            void clear()
+            {
+                m_heap.clear();
+                m_payload.clear();
+                m_free.clear();
+            }
+
+            //! Key of the top row.
+            Key const & top_key() const { return m_heap.front().key; }
+
+            //! Payload of the top row.
+            reference top_payload() { return m_payload[m_heap.front().slot]; }
+
+            //! The I-th payload column value of the top row.
+            template<size_t I>
+            typename std::tuple_element<I, std::tuple<Payload...>>::type & top()
+            {
+                return m_payload.template get<I>()[m_heap.front().slot];
+            }
+
+            //! Insert a row given by its key and one value per payload column.
+            template<typename K, typename... Args>
+            void push(K && key, Args &&... payload)
+            {
+                static_assert(sizeof...(Args) == sizeof...(Payload), "One value per payload column is required.");
+
+                std::uint32_t slot;
+                if (m_free.empty())
+                {
+                    slot = static_cast<std::uint32_t>(m_payload.size());
+                    m_payload.emplace_back(std::forward<Args>(payload)...);
+                }
+                else
+                {
+                    slot = m_free.back();
+                    m_free.pop_back();
+                    detail::assign_row_impl(m_payload, slot, detail::generate_sequence<sizeof...(Payload)>(),
+                                            std::forward<Args>(payload)...);
+                }
+
+                m_heap.push_back(entry{std::forward<K>(key), slot});
+                sift_up(m_heap.size() - 1);
+            }
+
+            //! Remove the top row (releasing its payload).
+            void pop()
+            {
+                std::uint32_t const slot = m_heap.front().slot;
+                detail::assign_row_impl(m_payload, slot, detail::generate_sequence<sizeof...(Payload)>(), Payload()...);
+                m_free.push_back(slot);
+                if (m_heap.size() > 1)
+                {
+                    entry last = std::move(m_heap.back());
+                    m_heap.pop_back();
+                    sift_down(0, std::move(last));
+                }
+                else
+                    m_heap.pop_back();
+            }
+
+        private:
+
+            struct entry
+            {
+                Key           key;
+                std::uint32_t slot;
+            };
+
+            //! Move the entry at `i` up until its parent is not less (moving the parents down into the hole).
+            void sift_up(std::size_t i)
+            {
+                entry e = std::move(m_heap[i]);
+                while (i > 0)
+                {
+                    std::size_t parent = (i - 1) / detail::heap_arity;
+                    if (!m_comp(m_heap[parent].key, e.key)) break;
+                    m_heap[i] = std::move(m_heap[parent]);
+                    i         = parent;
+                }
+                m_heap[i] = std::move(e);
+            }
+
+            //! Put the entry into the hole at `i` moving the greatest children up while they are greater.
+            void sift_down(std::size_t i, entry e)
+            {
+                std::size_t const n = m_heap.size();
+                for (;;)
+                {
+                    std::size_t first = detail::heap_arity * i + 1;
+                    if (first >= n) break;
+
+                    std::size_t best = first;
+                    for (std::size_t c = first + 1, last = std::min(first + detail::heap_arity, n); c < last; ++c)
+                        if (m_comp(m_heap[best].key, m_heap[c].key)) best = c;
+
+                    if (!m_comp(e.key, m_heap[best].key)) break;
+                    m_heap[i] = std::move(m_heap[best]);
+                    i         = best;
+                }
+                m_heap[i] = std::move(e);
+            }
+
+            Compare                    m_comp;
+            std::vector<entry>         m_heap;
+            payload_type               m_payload;
+            std::vector<std::uint32_t> m_free;
+    };
+
+    //! A priority queue with the greatest key on the top (see `basic_priority_queue`).
+    template<typename Key, typename... Payload>
+    using priority_queue = basic_priority_queue<less, Key, Payload...>;
+
+} // namespace joint
+
+#endif //JOINT_PRIORITY_QUEUE_HPP
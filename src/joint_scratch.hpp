@@ -0,0 +1,394 @@
+//
+// Scratch memory used by the joint algorithms.
+//
+
+#ifndef JOINT_SCRATCH_HPP
+#define JOINT_SCRATCH_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#if __cplusplus >= 201703L
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#define JOINT_HAS_PMR 1
+#endif
+#endif
+
+namespace joint
+{
+
+    //! An interface of a memory resource (mirrors `std::pmr::memory_resource` which is not available in C++11).
+    //!
+    //! All the algorithms needing scratch memory take a pointer to a memory resource as their last (optional)
+    //! argument.
+    class memory_resource
+    {
+        public:
+            virtual ~memory_resource() { }
+
+            //! Allocate `bytes` bytes aligned to `alignment`.
+            void * allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t))
+            {
+                return do_allocate(bytes, alignment);
+            }
+
+            //! Deallocate the memory obtained by `allocate()` with the same arguments.
+            void deallocate(void * p, std::size_t bytes, std::size_t alignment = alignof(std::max_align_t))
+            {
+                do_deallocate(p, bytes, alignment);
+            }
+
+            //! Check whether the memory allocated by one resource can be deallocated by the other one.
+            bool is_equal(memory_resource const & other) const noexcept { return this == & other; }
+
+        private:
+            virtual void * do_allocate(std::size_t bytes, std::size_t alignment) = 0;
+            virtual void   do_deallocate(void * p, std::size_t bytes, std::size_t alignment) = 0;
+    };
+
+    //! The memory resource using the global `operator new` and `operator delete`.
+    //!
+    //! The alignments (powers of two) above the one guaranteed by `operator new` are served by the aligned
+    //! `operator new` if available (C++17), otherwise the block is over-allocated and aligned by hand, its offset
+    //! being stored in front of the aligned address.
+    class new_delete_resource_type : public memory_resource
+    {
+        private:
+#ifdef __cpp_aligned_new
+            static constexpr std::size_t default_alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+#else
+            static constexpr std::size_t default_alignment = alignof(std::max_align_t);
+#endif
+
+            void * do_allocate(std::size_t bytes, std::size_t alignment) override
+            {
+                if (alignment <= default_alignment) return ::operator new(bytes);
+#ifdef __cpp_aligned_new
+                return ::operator new(bytes, std::align_val_t(alignment));
+#else
+                std::size_t const header = sizeof(std::size_t);
+                char * const      raw    = static_cast<char *>(::operator new(bytes + alignment + header));
+
+                std::uintptr_t const address = reinterpret_cast<std::uintptr_t>(raw) + header;
+                std::size_t const    offset  = header + (alignment - address % alignment) % alignment;
+                std::memcpy(raw + offset - header, & offset, header);
+                return raw + offset;
+#endif
+            }
+
+            void do_deallocate(void * p, std::size_t, std::size_t alignment) override
+            {
+                if (alignment <= default_alignment) return ::operator delete(p);
+#ifdef __cpp_aligned_new
+                ::operator delete(p, std::align_val_t(alignment));
+#else
+                std::size_t offset;
+                std::memcpy(& offset, static_cast<char *>(p) - sizeof(std::size_t), sizeof(offset));
+                ::operator delete(static_cast<char *>(p) - offset);
+#endif
+            }
+    };
+
+    //! Get the memory resource using the global `operator new` and `operator delete`.
+    inline memory_resource * new_delete_resource()
+    {
+        static new_delete_resource_type resource;
+        return & resource;
+    }
+
+    namespace detail
+    {
+
+        inline std::atomic<memory_resource *> & default_resource_pointer()
+        {
+            static std::atomic<memory_resource *> resource{new_delete_resource()};
+            return resource;
+        }
+
+    }
+
+    //! Get the resource used by the algorithms if none is given (`new_delete_resource()` unless set otherwise).
+    inline memory_resource * default_resource() { return detail::default_resource_pointer().load(); }
+
+    //! Set the resource used by the algorithms if none is given (e.g., a `huge_page_resource`) and return the
+    //! previous one (a null pointer stands for `new_delete_resource()`). The resource must outlive its use.
+    inline memory_resource * set_default_resource(memory_resource * resource)
+    {
+        return detail::default_resource_pointer().exchange(resource ? resource : new_delete_resource());
+    }
+
+#ifdef JOINT_HAS_PMR
+    //! Adaptor making a `std::pmr::memory_resource` usable by the joint algorithms.
+    class pmr_resource : public memory_resource
+    {
+        public:
+            explicit pmr_resource(std::pmr::memory_resource * resource)
+                    : m_resource(resource) { }
+
+        private:
+            void * do_allocate(std::size_t bytes, std::size_t alignment) override
+            {
+                return m_resource->allocate(bytes, alignment);
+            }
+
+            void do_deallocate(void * p, std::size_t bytes, std::size_t alignment) override
+            {
+                m_resource->deallocate(p, bytes, alignment);
+            }
+
+            std::pmr::memory_resource * m_resource;
+    };
+#endif
+
+    //! A memory resource serializing the calls to another resource (used by parallel algorithms).
+    class synchronized_resource : public memory_resource
+    {
+        public:
+            explicit synchronized_resource(memory_resource * upstream)
+                    : m_upstream(upstream) { }
+
+        private:
+            void * do_allocate(std::size_t bytes, std::size_t alignment) override
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return m_upstream->allocate(bytes, alignment);
+            }
+
+            void do_deallocate(void * p, std::size_t bytes, std::size_t alignment) override
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_upstream->deallocate(p, bytes, alignment);
+            }
+
+            memory_resource * m_upstream;
+            std::mutex        m_mutex;
+    };
+
+    //! A reusable arena for the scratch memory of the algorithms.
+    //!
+    //! The memory is taken from blocks obtained from the upstream resource by bumping a pointer. Deallocations
+    //! in the reverse order of allocations give the memory back immediately, other deallocations are deferred until
+    //! all the allocations are released. At this point, the arena is rewound (and its blocks are merged into one
+    //! if more of them were needed) so that the next call of an algorithm reuses the same memory without touching
+    //! the upstream resource. The arena is not thread safe, the algorithms allocate from the calling thread only.
+    class scratch_arena : public memory_resource
+    {
+        public:
+
+            //! Create an arena with the initial capacity (in bytes).
+            explicit scratch_arena(std::size_t capacity = 0, memory_resource * upstream = default_resource())
+                    : m_upstream(upstream), m_top(0), m_live(0)
+            {
+                if (capacity > 0) add_block(capacity);
+            }
+
+            scratch_arena(scratch_arena const &) = delete;
+            scratch_arena & operator=(scratch_arena const &) = delete;
+
+            //! Give all the blocks back to the upstream resource.
+            ~scratch_arena() { release(); }
+
+            //! Give all the blocks back to the upstream resource (all the allocations must be released already).
+            void release()
+            {
+                for (auto & b : m_blocks) m_upstream->deallocate(b.data, b.size);
+                m_blocks.clear();
+                m_top  = 0;
+                m_live = 0;
+            }
+
+            //! Total size of the blocks owned by the arena.
+            std::size_t capacity() const
+            {
+                std::size_t size = 0;
+                for (auto & b : m_blocks) size += b.size;
+                return size;
+            }
+
+            //! Number of blocks owned by the arena.
+            std::size_t blocks() const { return m_blocks.size(); }
+
+        private:
+
+            struct block
+            {
+                char      * data;
+                std::size_t size;
+                std::size_t used;
+            };
+
+            void add_block(std::size_t size)
+            {
+                block b = {static_cast<char *>(m_upstream->allocate(size)), size, 0};
+                m_blocks.push_back(b);
+                m_top = m_blocks.size() - 1;
+            }
+
+            void * do_allocate(std::size_t bytes, std::size_t alignment) override
+            {
+                for (;;)
+                {
+                    if (m_top < m_blocks.size())
+                    {
+                        block & b = m_blocks[m_top];
+                        auto address = reinterpret_cast<std::uintptr_t>(b.data) + b.used;
+                        auto padding = (alignment - address % alignment) % alignment;
+                        if (b.used + padding + bytes <= b.size)
+                        {
+                            b.used += padding + bytes;
+                            ++m_live;
+                            return b.data + b.used - bytes;
+                        }
+                        if (m_top + 1 < m_blocks.size())
+                        {
+                            m_blocks[++m_top].used = 0;
+                            continue;
+                        }
+                    }
+                    std::size_t last = m_blocks.empty() ? 0 : m_blocks.back().size;
+                    add_block(std::max<std::size_t>(std::max<std::size_t>(2 * last, 4096), bytes + alignment));
+                }
+            }
+
+            void do_deallocate(void * p, std::size_t bytes, std::size_t) override
+            {
+                block & b = m_blocks[m_top];
+                if (static_cast<char *>(p) + bytes == b.data + b.used)
+                    b.used = static_cast<std::size_t>(static_cast<char *>(p) - b.data);
+
+                if (--m_live == 0) rewind();
+            }
+
+            //! Start from the beginning (merging the blocks into a single one).
+            void rewind()
+            {
+                if (m_blocks.size() > 1)
+                {
+                    std::size_t size = capacity();
+                    release();
+                    add_block(size);
+                }
+                m_top = 0;
+                if (!m_blocks.empty()) m_blocks[0].used = 0;
+            }
+
+            memory_resource  * m_upstream;
+            std::vector<block> m_blocks;
+            std::size_t        m_top;
+            std::size_t        m_live;
+    };
+
+    //! An allocator taking the memory from a memory resource.
+    template<typename T>
+    class scratch_allocator
+    {
+        public:
+            typedef T value_type;
+
+            scratch_allocator(memory_resource * resource = default_resource()) noexcept
+                    : m_resource(resource) { }
+
+            template<typename U>
+            scratch_allocator(scratch_allocator<U> const & other) noexcept
+                    : m_resource(other.resource()) { }
+
+            T * allocate(std::size_t n)
+            {
+                return static_cast<T *>(m_resource->allocate(n * sizeof(T), alignof(T)));
+            }
+
+            void deallocate(T * p, std::size_t n)
+            {
+                m_resource->deallocate(p, n * sizeof(T), alignof(T));
+            }
+
+            memory_resource * resource() const noexcept { return m_resource; }
+
+        private:
+            memory_resource * m_resource;
+    };
+
+    template<typename T, typename U>
+    bool operator==(scratch_allocator<T> const & a, scratch_allocator<U> const & b) noexcept
+    {
+        return a.resource()->is_equal(* b.resource());
+    }
+
+    template<typename T, typename U>
+    bool operator!=(scratch_allocator<T> const & a, scratch_allocator<U> const & b) noexcept
+    {
+        return !(a == b);
+    }
+
+    //! A vector in the scratch memory.
+    template<typename T>
+    using scratch_vector = std::vector<T, scratch_allocator<T>>;
+
+    namespace detail
+    {
+
+        //! A bitset in the scratch memory (e.g., for recording the decisions of merges and permutations).
+        class scratch_bitset
+        {
+            public:
+                scratch_bitset(std::size_t n, memory_resource * resource)
+                        : m_words((n + 63) / 64, 0, scratch_allocator<std::uint64_t>(resource)) { }
+
+                void set(std::size_t i) { m_words[i / 64] |= std::uint64_t(1) << (i % 64); }
+
+                void reset(std::size_t i) { m_words[i / 64] &= ~(std::uint64_t(1) << (i % 64)); }
+
+                //! Set the bit if `value` is true (without branching, the bit must be cleared beforehand).
+                void assign(std::size_t i, bool value) { m_words[i / 64] |= std::uint64_t(value) << (i % 64); }
+
+                bool operator[](std::size_t i) const { return (m_words[i / 64] >> (i % 64)) & 1; }
+
+            private:
+                scratch_vector<std::uint64_t> m_words;
+        };
+
+        //! Uninitialized scratch storage of `n` entries moved in and out bytewise (see `relocate()`).
+        //!
+        //! No entry is constructed or destroyed in the buffer, the entries relocated into it must be relocated out.
+        template<typename T>
+        class relocation_buffer
+        {
+            public:
+                relocation_buffer(std::size_t n, memory_resource * resource)
+                        : m_data(static_cast<T *>(resource->allocate(n * sizeof(T), alignof(T)))), m_size(n),
+                          m_resource(resource) { }
+
+                relocation_buffer(relocation_buffer const &) = delete;
+                relocation_buffer & operator=(relocation_buffer const &) = delete;
+
+                ~relocation_buffer() { m_resource->deallocate(m_data, m_size * sizeof(T), alignof(T)); }
+
+                T * data() const { return m_data; }
+
+                std::size_t size() const { return m_size; }
+
+            private:
+                T               * m_data;
+                std::size_t       m_size;
+                memory_resource * m_resource;
+        };
+
+        //! Move `n` trivially relocatable entries by copying their bytes (the sources are abandoned).
+        template<typename T>
+        void relocate(T * target, T const * source, std::size_t n)
+        {
+            std::memcpy(static_cast<void *>(target), static_cast<void const *>(source), n * sizeof(T));
+        }
+
+    }
+
+} // namespace joint
+
+#endif //JOINT_SCRATCH_HPP
@@ -0,0 +1,338 @@
+//
+// Random shuffling and sampling of the rows of joint ranges.
+//
+
+#ifndef JOINT_SHUFFLE_HPP
+#define JOINT_SHUFFLE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <random>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+#include "joint_iterator.hpp"
+#include "joint_observer.hpp"
+#include "joint_parallel.hpp"
+#include "joint_scratch.hpp"
+
+#if !defined(JOINT_PREFETCH) && defined(__GNUC__)
+#define JOINT_PREFETCH(address) __builtin_prefetch(address)
+#elif !defined(JOINT_PREFETCH)
+#define JOINT_PREFETCH(address) ((void) 0)
+#endif
+
+namespace joint
+{
+
+    namespace detail
+    {
+
+        //! Distance (in rows) of the prefetching of the gathered entries ahead of the gathering.
+        constexpr std::size_t gather_prefetch_distance = 16;
+
+        //! Number of the rows per bucket of the shuffle (the indices of a bucket are shuffled in cache).
+        constexpr std::size_t shuffle_grain = 65536;
+
+        //! Maximal number of the buckets of the shuffle.
+        constexpr std::size_t max_shuffle_buckets = 512;
+
+        //! A small and fast random engine of the tasks of the shuffle (SplitMix64).
+        class split_mix
+        {
+            public:
+                typedef std::uint64_t result_type;
+
+                explicit split_mix(std::uint64_t seed) : m_state(seed) { }
+
+                static constexpr result_type min() { return 0; }
+
+                static constexpr result_type max() { return ~result_type(0); }
+
+                result_type operator()()
+                {
+                    std::uint64_t z = (m_state += 0x9e3779b97f4a7c15ULL);
+                    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+                    return z ^ (z >> 31);
+                }
+
+            private:
+                std::uint64_t m_state;
+        };
+
+        //! Seed of the engine of the `i`-th task derived from the seed drawn from the generator of the caller.
+        inline std::uint64_t task_seed(std::uint64_t seed, std::uint64_t i)
+        {
+            split_mix random(seed ^ (i * 0xd1b54a32d192ed03ULL));
+            return random();
+        }
+
+        //! Generate a uniformly random permutation of `0, ..., n - 1` into `permutation`.
+        //!
+        //! The indices are scattered into random buckets chunk by chunk (two passes over the same random numbers:
+        //! counting and scattering) and each bucket is shuffled by Fisher-Yates. Every chunk and bucket has its own
+        //! engine seeded by `task_seed()` and the numbers of the chunks and buckets depend only on `n`, hence the
+        //! permutation depends only on `seed` and not on the policy or the number of the threads.
+        template<typename Policy>
+        void random_permutation(Policy const & policy, std::size_t n, std::uint64_t seed,
+                                scratch_vector<std::size_t> & permutation, memory_resource * resource)
+        {
+            typedef split_mix engine;
+
+            std::size_t const buckets = std::max<std::size_t>(std::min(n / shuffle_grain, max_shuffle_buckets), 1);
+            permutation.resize(n);
+
+            // The beginnings of the buckets (stored one after another) and the end of the last one.
+            scratch_vector<std::size_t> starts(buckets + 1, 0, scratch_allocator<std::size_t>(resource));
+            starts[buckets] = n;
+
+            if (buckets == 1)
+                for (std::size_t i = 0; i < n; ++i) permutation[i] = i;
+            else
+            {
+                // The bucket of a row by the multiply-shift of 32 random bits (the bias is below 2^-23).
+                auto bucket_of = [buckets](engine & random)
+                {
+                    return static_cast<std::size_t>(((random() >> 32) * buckets) >> 32);
+                };
+
+                scratch_vector<std::size_t> counts(buckets * buckets, 0, scratch_allocator<std::size_t>(resource));
+                for_each_chunk(policy, buckets, [&](std::size_t c)
+                {
+                    engine        random(task_seed(seed, c));
+                    std::size_t * chunk_counts = counts.data() + c * buckets;
+                    for (std::size_t i = chunk_begin(c, buckets, n), e = chunk_begin(c + 1, buckets, n); i < e; ++i)
+                        ++chunk_counts[bucket_of(random)];
+                });
+
+                // The offsets of the chunks within the buckets.
+                std::size_t offset = 0;
+                for (std::size_t b = 0; b < buckets; ++b)
+                {
+                    starts[b] = offset;
+                    for (std::size_t c = 0; c < buckets; ++c)
+                    {
+                        std::size_t const count = counts[c * buckets + b];
+                        counts[c * buckets + b] = offset;
+                        offset                 += count;
+                    }
+                }
+
+                for_each_chunk(policy, buckets, [&](std::size_t c)
+                {
+                    engine        random(task_seed(seed, c));
+                    std::size_t * chunk_offsets = counts.data() + c * buckets;
+                    for (std::size_t i = chunk_begin(c, buckets, n), e = chunk_begin(c + 1, buckets, n); i < e; ++i)
+                        permutation[chunk_offsets[bucket_of(random)]++] = i;
+                });
+            }
+
+            for_each_chunk(policy, buckets, [&](std::size_t b)
+            {
+                engine random(task_seed(seed, buckets + b));
+                for (std::size_t i = starts[b + 1] - starts[b]; i > 1; --i)
+                {
+                    std::uniform_int_distribution<std::size_t> distribution(0, i - 1);
+                    std::swap(permutation[starts[b] + i - 1], permutation[starts[b] + distribution(random)]);
+                }
+            });
+        }
+
+        //! Permute a column such that its `i`-th entry becomes the `permutation[i]`-th original one (in parallel).
+        //!
+        //! The entries are moved to an uninitialized buffer and back chunk by chunk (the contiguous columns of
+        //! trivially relocatable entries are relocated bytewise instead).
+        template<typename Policy>
+        struct parallel_gatherer
+        {
+            Policy const                      & policy;
+            scratch_vector<std::size_t> const & permutation;
+            memory_resource                   * resource;
+
+            template<typename I> void operator()(I column) const
+            {
+                typedef typename std::iterator_traits<I>::value_type value_type;
+
+                gather(column, std::integral_constant<bool, is_contiguous_iterator<I>::value
+                                                            && is_trivially_relocatable<value_type>::value>());
+            }
+
+            template<typename I> void gather(I column, std::false_type) const
+            {
+                typedef typename std::iterator_traits<I>::value_type value_type;
+
+                std::size_t const             n      = permutation.size();
+                std::size_t const             chunks = chunk_count(policy, n);
+                relocation_buffer<value_type> buffer(n, resource);
+                value_type                  * data   = buffer.data();
+
+                for_each_chunk(policy, chunks, [&](std::size_t c)
+                {
+                    for (std::size_t i = chunk_begin(c, chunks, n), e = chunk_begin(c + 1, chunks, n); i < e; ++i)
+                        ::new (static_cast<void *>(data + i)) value_type(std::move(column[permutation[i]]));
+                });
+                for_each_chunk(policy, chunks, [&](std::size_t c)
+                {
+                    for (std::size_t i = chunk_begin(c, chunks, n), e = chunk_begin(c + 1, chunks, n); i < e; ++i)
+                    {
+                        column[i] = std::move(data[i]);
+                        data[i].~value_type();
+                    }
+                });
+            }
+
+            template<typename I> void gather(I column, std::true_type) const
+            {
+                typedef typename std::iterator_traits<I>::value_type value_type;
+
+                std::size_t const             n      = permutation.size();
+                std::size_t const             chunks = chunk_count(policy, n);
+                relocation_buffer<value_type> buffer(n, resource);
+                value_type                  * data   = & * column;
+
+                for_each_chunk(policy, chunks, [&](std::size_t c)
+                {
+                    for (std::size_t i = chunk_begin(c, chunks, n), e = chunk_begin(c + 1, chunks, n); i < e; ++i)
+                    {
+                        if (i + gather_prefetch_distance < e)
+                            JOINT_PREFETCH(data + permutation[i + gather_prefetch_distance]);
+                        relocate(buffer.data() + i, data + permutation[i], 1);
+                    }
+                });
+                for_each_chunk(policy, chunks, [&](std::size_t c)
+                {
+                    std::size_t const b = chunk_begin(c, chunks, n), e = chunk_begin(c + 1, chunks, n);
+                    relocate(data + b, buffer.data() + b, e - b);
+                });
+            }
+        };
+
+        //! Copy the column entries at the given rows to the output column (in parallel).
+        template<typename Policy>
+        struct sample_gatherer
+        {
+            Policy const                      & policy;
+            scratch_vector<std::size_t> const & rows;
+
+            template<typename O, typename I> void operator()(O output, I column) const
+            {
+                std::size_t const n      = rows.size();
+                std::size_t const chunks = chunk_count(policy, n);
+
+                for_each_chunk(policy, chunks, [&](std::size_t c)
+                {
+                    for (std::size_t j = chunk_begin(c, chunks, n), e = chunk_begin(c + 1, chunks, n); j < e; ++j)
+                        output[j] = column[rows[j]];
+                });
+            }
+        };
+
+        template<typename Outputs, typename Columns, typename F, size_t... Is>
+        void for_each_output_column(Outputs & outputs, Columns & columns, F f, sequence<Is...>)
+        {
+            auto l = {(f(std::get<Is>(outputs), std::get<Is>(columns)), 0)...};
+            (void) l;
+        }
+
+        //! Draw a seed for the tasks from the generator of the caller.
+        template<typename RandomEngine>
+        std::uint64_t draw_seed(RandomEngine & random)
+        {
+            return std::uniform_int_distribution<std::uint64_t>()(random);
+        }
+
+    }
+
+    //! Shuffle the rows of a joint range uniformly at random (all the columns stay aligned).
+    //!
+    //! A random permutation of the row indices is generated in parallel (see `detail::random_permutation()`) and
+    //! applied column by column, each column being gathered through a buffer by the parallel tasks. Only a single
+    //! seed is drawn from `random`, so the result is reproducible for a given seed of the generator regardless of
+    //! the policy and the number of threads (but it differs from `std::shuffle()`).
+    template<typename Policy, typename... Iterators, typename RandomEngine,
+             typename = typename std::enable_if<is_execution_policy<Policy>::value>::type>
+    void shuffle(Policy const & policy, iterator<Iterators...> first, iterator<Iterators...> last,
+                 RandomEngine && random, memory_resource * resource = default_resource())
+    {
+        std::size_t const n = last - first;
+        if (n < 2) return;
+
+        phase_timer timer(phase::permutation, n, n * detail::row_bytes<Iterators...>::value);
+
+        scratch_vector<std::size_t> permutation{scratch_allocator<std::size_t>(resource)};
+        detail::random_permutation(policy, n, detail::draw_seed(random), permutation, resource);
+
+        auto iterators = first.iterators();
+        detail::for_each_one_tuple(iterators, detail::parallel_gatherer<Policy>{policy, permutation, resource});
+    }
+
+    //! Shuffle the rows of a joint range uniformly at random in parallel (see above).
+    template<typename... Iterators, typename RandomEngine>
+    void shuffle(iterator<Iterators...> first, iterator<Iterators...> last, RandomEngine && random,
+                 memory_resource * resource = default_resource())
+    {
+        shuffle(par, first, last, random, resource);
+    }
+
+    //! Copy `k` rows of a joint range chosen uniformly at random (without replacement) to the output range.
+    //!
+    //! The row indices are chosen by a partial Fisher-Yates shuffle of the virtual index array (only the displaced
+    //! indices are stored, so it takes `O(k)` time and memory regardless of the size of the range) and sorted, so
+    //! the sampled rows keep their relative order as with `std::sample()`. Then only the sampled rows are gathered,
+    //! column by column by the parallel tasks. The output is a joint iterator of random access iterators of the
+    //! output columns. Returns the end of the output (`min(k, last - first)` rows).
+    template<typename Policy, typename... Iterators, typename... Outputs, typename RandomEngine,
+             typename = typename std::enable_if<is_execution_policy<Policy>::value>::type>
+    iterator<Outputs...> sample(Policy const & policy, iterator<Iterators...> first, iterator<Iterators...> last,
+                                std::size_t k, iterator<Outputs...> output, RandomEngine && random,
+                                memory_resource * resource = default_resource())
+    {
+        static_assert(sizeof...(Iterators) == sizeof...(Outputs), "One output column per column is required.");
+
+        std::size_t const n = last - first;
+        k = std::min(k, n);
+
+        phase_timer timer(phase::gather, k, k * detail::row_bytes<Iterators...>::value);
+
+        scratch_vector<std::size_t> rows{scratch_allocator<std::size_t>(resource)};
+        rows.reserve(k);
+
+        std::unordered_map<std::size_t, std::size_t> displaced;
+        for (std::size_t i = 0; i < k; ++i)
+        {
+            std::uniform_int_distribution<std::size_t> distribution(i, n - 1);
+            std::size_t const j = distribution(random);
+
+            auto const at_i = displaced.find(i), at_j = displaced.find(j);
+            std::size_t const row_i = at_i == displaced.end() ? i : at_i->second;
+            std::size_t const row_j = at_j == displaced.end() ? j : at_j->second;
+
+            rows.push_back(row_j);
+            displaced[j] = row_i;
+        }
+        std::sort(rows.begin(), rows.end());
+
+        auto outputs = output.iterators();
+        auto columns = first.iterators();
+        detail::for_each_output_column(outputs, columns, detail::sample_gatherer<Policy>{policy, rows},
+                                       detail::generate_sequence<sizeof...(Iterators)>());
+        return output + k;
+    }
+
+    //! Copy `k` random rows of a joint range to the output range in parallel (see above).
+    template<typename... Iterators, typename... Outputs, typename RandomEngine>
+    iterator<Outputs...> sample(iterator<Iterators...> first, iterator<Iterators...> last, std::size_t k,
+                                iterator<Outputs...> output, RandomEngine && random,
+                                memory_resource * resource = default_resource())
+    {
+        return sample(par, first, last, k, output, random, resource);
+    }
+
+} // namespace joint
+
+#endif //JOINT_SHUFFLE_HPP
@@ -0,0 +1,1298 @@
+//
+// Sorting of joint ranges by a single key column.
+//
+
+#ifndef JOINT_SORT_HPP
+#define JOINT_SORT_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "joint_iterator.hpp"
+#include "joint_merge.hpp"
+#include "joint_observer.hpp"
+#include "joint_parallel.hpp"
+#include "joint_partition.hpp"
+#include "joint_permutation.hpp"
+#include "joint_scratch.hpp"
+#include "joint_sorted_range.hpp"
+
+namespace joint
+{
+
+    namespace detail
+    {
+
+        //! Reverse the first `n` entries of a column.
+        struct range_reverser
+        {
+            std::size_t n;
+
+            template<typename I> void operator()(I column) { std::reverse(column, column + n); }
+        };
+
+        //! Move the entry at `to` to the position `from` and shift the entries in between by one to the right.
+        struct entry_shifter
+        {
+            std::size_t from;
+            std::size_t to;
+
+            template<typename I> void operator()(I column)
+            {
+                typename std::iterator_traits<I>::value_type value = std::move(column[to]);
+                std::move_backward(column + from, column + to, column + to + 1);
+                column[from] = std::move(value);
+            }
+        };
+
+        //! Sort the first `n` rows given that the first `sorted` of them are sorted already.
+        //!
+        //! The insertion positions are found by a binary search on the key column, the rows are moved column-wise.
+        template<size_t I, typename... Iterators, typename Compare>
+        void binary_insertion_sort(iterator<Iterators...> first, std::size_t n, std::size_t sorted, Compare & comp)
+        {
+            auto keys      = first.template get<I>();
+            auto iterators = first.iterators();
+
+            for (std::size_t i = std::max<std::size_t>(sorted, 1); i < n; ++i)
+            {
+                std::size_t position = std::upper_bound(keys, keys + i, keys[i], comp) - keys;
+                if (position != i) for_each_one_tuple(iterators, entry_shifter{position, i});
+            }
+        }
+
+        //! Length of the run at the beginning of the range (a strictly descending run is reversed in place).
+        template<size_t I, typename... Iterators, typename Compare>
+        std::size_t count_run(iterator<Iterators...> first, std::size_t n, Compare & comp)
+        {
+            auto keys = first.template get<I>();
+            if (n < 2) return n;
+
+            std::size_t length = 2;
+            if (comp(keys[1], keys[0]))
+            {
+                while (length < n && comp(keys[length], keys[length - 1])) ++length;
+
+                auto iterators = first.iterators();
+                for_each_one_tuple(iterators, range_reverser{length});
+            }
+            else
+            {
+                while (length < n && !comp(keys[length], keys[length - 1])) ++length;
+            }
+
+            return length;
+        }
+
+        //! Minimal length of a run (between 32 and 64) for which the number of runs is (close to) a power of two.
+        inline std::size_t min_run_length(std::size_t n)
+        {
+            std::size_t r = 0;
+            while (n >= 64)
+            {
+                r |= n & 1;
+                n >>= 1;
+            }
+            return n + r;
+        }
+
+        //! State of the adaptive merge sort (TimSort).
+        template<size_t I, typename Iterator, typename Compare>
+        class run_merger
+        {
+            public:
+                run_merger(Iterator first, Compare & comp, memory_resource * resource)
+                        : m_first(first), m_comp(comp), m_resource(resource) { }
+
+                //! Add the next run and restore the invariants on the run lengths.
+                void push(std::size_t base, std::size_t length)
+                {
+                    m_runs.push_back(run{base, length});
+
+                    while (m_runs.size() > 1)
+                    {
+                        std::size_t n = m_runs.size() - 2;
+                        if ((n > 0 && length_of(n - 1) <= length_of(n) + length_of(n + 1))
+                            || (n > 1 && length_of(n - 2) <= length_of(n - 1) + length_of(n)))
+                        {
+                            if (length_of(n - 1) < length_of(n + 1)) --n;
+                        }
+                        else if (length_of(n) > length_of(n + 1))
+                        {
+                            break;
+                        }
+                        merge_at(n);
+                    }
+                }
+
+                //! Merge all the remaining runs.
+                void finish()
+                {
+                    while (m_runs.size() > 1)
+                    {
+                        std::size_t n = m_runs.size() - 2;
+                        if (n > 0 && length_of(n - 1) < length_of(n + 1)) --n;
+                        merge_at(n);
+                    }
+                }
+
+            private:
+
+                struct run
+                {
+                    std::size_t base;
+                    std::size_t length;
+                };
+
+                std::size_t length_of(std::size_t i) const { return m_runs[i].length; }
+
+                void merge_at(std::size_t i)
+                {
+                    run & a = m_runs[i];
+                    run & b = m_runs[i + 1];
+
+                    merge_adjacent<I>(m_first + a.base, a.length, a.length + b.length, m_comp, m_resource);
+
+                    a.length += b.length;
+                    m_runs.erase(m_runs.begin() + i + 1);
+                }
+
+                Iterator          m_first;
+                Compare         & m_comp;
+                memory_resource * m_resource;
+                std::vector<run>  m_runs;
+        };
+
+        //! Comparators of the (size optimal) sorting networks for 2 to 8 entries.
+        struct sorting_network
+        {
+            unsigned char const (* comparators)[2];
+            std::size_t           size;
+
+            static sorting_network get(std::size_t n)
+            {
+                static unsigned char const network2[][2] = {{0, 1}};
+                static unsigned char const network3[][2] = {{0, 2}, {0, 1}, {1, 2}};
+                static unsigned char const network4[][2] = {{0, 2}, {1, 3}, {0, 1}, {2, 3}, {1, 2}};
+                static unsigned char const network5[][2] = {{0, 3}, {1, 4}, {0, 2}, {1, 3}, {0, 1}, {2, 4}, {1, 2},
+                                                            {3, 4}, {2, 3}};
+                static unsigned char const network6[][2] = {{0, 5}, {1, 3}, {2, 4}, {1, 2}, {3, 4}, {0, 3}, {2, 5},
+                                                            {0, 1}, {2, 3}, {4, 5}, {1, 2}, {3, 4}};
+                static unsigned char const network7[][2] = {{0, 6}, {2, 3}, {4, 5}, {0, 2}, {1, 4}, {3, 6}, {0, 1},
+                                                            {2, 5}, {3, 4}, {1, 2}, {4, 6}, {2, 3}, {4, 5}, {1, 2},
+                                                            {3, 4}, {5, 6}};
+                static unsigned char const network8[][2] = {{0, 2}, {1, 3}, {4, 6}, {5, 7}, {0, 4}, {1, 5}, {2, 6},
+                                                            {3, 7}, {0, 1}, {2, 3}, {4, 5}, {6, 7}, {2, 4}, {3, 5},
+                                                            {1, 4}, {3, 6}, {1, 2}, {3, 4}, {5, 6}};
+
+                switch (n)
+                {
+                    case 2: return sorting_network{network2, 1};
+                    case 3: return sorting_network{network3, 3};
+                    case 4: return sorting_network{network4, 5};
+                    case 5: return sorting_network{network5, 9};
+                    case 6: return sorting_network{network6, 12};
+                    case 7: return sorting_network{network7, 16};
+                    case 8: return sorting_network{network8, 19};
+                    default: return sorting_network{nullptr, 0};
+                }
+            }
+        };
+
+        //! Maximal size of a segment sorted by a sorting network.
+        constexpr std::size_t max_network_size = 8;
+
+        //! Maximal size of a segment sorted by the insertion sort.
+        constexpr std::size_t max_insertion_size = 64;
+
+        //! Sort up to `max_network_size` rows by a sorting network on the key column.
+        template<size_t I, typename... Iterators, typename Compare>
+        void network_sort(iterator<Iterators...> first, std::size_t n, Compare & comp)
+        {
+            auto keys    = first.template get<I>();
+            auto network = sorting_network::get(n);
+
+            for (std::size_t c = 0; c < network.size; ++c)
+            {
+                std::size_t i = network.comparators[c][0], j = network.comparators[c][1];
+                if (comp(keys[j], keys[i])) std::iter_swap(first + i, first + j);
+            }
+        }
+
+        //! Check whether the rows are sorted by strings in the lexicographic order (suitable for the prefix sort).
+        template<typename KeyIterator, typename Compare>
+        struct is_string_key
+                : std::integral_constant<bool,
+                                         std::is_same<typename std::iterator_traits<KeyIterator>::value_type,
+                                                      std::string>::value
+                                         && (std::is_same<Compare, less>::value
+                                             || std::is_same<Compare, std::less<std::string>>::value)>
+        {
+        };
+
+        //! Big-endian prefix of 8 bytes of a string starting at `depth` (padded by zeros).
+        //!
+        //! Comparing prefixes as integers is equivalent to comparing the bytes as `std::string::compare()` does.
+        inline std::uint64_t string_prefix(std::string const & s, std::size_t depth)
+        {
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            if (s.size() >= depth + 8)
+            {
+                std::uint64_t word;
+                std::memcpy(& word, s.data() + depth, 8);
+                return __builtin_bswap64(word);
+            }
+#endif
+            std::uint64_t prefix = 0;
+            std::size_t   length = s.size() > depth ? std::min<std::size_t>(s.size() - depth, 8) : 0;
+            for (std::size_t b = 0; b < length; ++b)
+                prefix |= std::uint64_t(static_cast<unsigned char>(s[depth + b])) << (56 - 8 * b);
+            return prefix;
+        }
+
+        //! A row index with the cached prefix of its key.
+        struct string_entry
+        {
+            std::uint64_t prefix;
+            std::size_t   index;
+
+            bool operator<(string_entry const & e) const
+            {
+                return prefix < e.prefix || (prefix == e.prefix && index < e.index);
+            }
+        };
+
+        //! Sort the entries by their string keys.
+        //!
+        //! The entries are sorted by their cached prefixes (with the row index breaking the ties, so the sort is
+        //! stable). The groups of equal prefixes are refined by the next 8 bytes of the keys (similarly to the MSD
+        //! radix sort), the keys ending within the prefix precede the others and they are ordered by their length.
+        //! The keys are therefore only touched when computing the prefixes of the tied groups.
+        template<typename KeyIterator>
+        void sort_string_entries(KeyIterator keys, string_entry * first, string_entry * last)
+        {
+            struct group
+            {
+                string_entry * first;
+                string_entry * last;
+                std::size_t    depth;
+            };
+
+            std::vector<group> groups(1, group{first, last, 0});
+            while (!groups.empty())
+            {
+                group g = groups.back();
+                groups.pop_back();
+
+                std::sort(g.first, g.last);
+
+                for (string_entry * run = g.first; run != g.last;)
+                {
+                    string_entry * end = run + 1;
+                    while (end != g.last && end->prefix == run->prefix) ++end;
+
+                    if (end - run > 1)
+                    {
+                        std::size_t const next = g.depth + 8;
+
+                        string_entry * middle = std::partition(run, end, [&](string_entry const & e)
+                        {
+                            return keys[e.index].size() <= next;
+                        });
+                        std::sort(run, middle, [&](string_entry const & a, string_entry const & b)
+                        {
+                            std::size_t la = keys[a.index].size(), lb = keys[b.index].size();
+                            return la < lb || (la == lb && a.index < b.index);
+                        });
+
+                        if (end - middle > 1)
+                        {
+                            for (string_entry * e = middle; e != end; ++e) e->prefix = string_prefix(keys[e->index], next);
+                            groups.push_back(group{middle, end, next});
+                        }
+                    }
+
+                    run = end;
+                }
+            }
+        }
+
+        //! Sort by a string key column using the cached prefixes (see above) and permute the rows afterwards.
+        template<size_t I, typename... Iterators, typename Compare>
+        void sort_by_impl(iterator<Iterators...> first, iterator<Iterators...> last, Compare &,
+                          memory_resource * resource, std::true_type)
+        {
+            auto              keys = first.template get<I>();
+            std::size_t const n    = last - first;
+
+            scratch_vector<string_entry> entries{scratch_allocator<string_entry>(resource)};
+            scratch_vector<std::size_t>  permutation{scratch_allocator<std::size_t>(resource)};
+            {
+                phase_timer timer(phase::key_extraction, n);
+                entries.reserve(n);
+                for (std::size_t i = 0; i < n; ++i) entries.push_back(string_entry{string_prefix(keys[i], 0), i});
+            }
+            {
+                phase_timer timer(phase::sort, n);
+                sort_string_entries(keys, entries.data(), entries.data() + n);
+
+                permutation.reserve(n);
+                for (auto & e : entries) permutation.push_back(e.index);
+            }
+
+            permute(first, last, permutation.begin(), resource);
+        }
+
+        //! Sort by a general key column.
+        template<size_t I, typename... Iterators, typename Compare>
+        void sort_by_impl(iterator<Iterators...> first, iterator<Iterators...> last, Compare & comp,
+                          memory_resource * resource, std::false_type);
+
+        //! The sorting kernel of `sort_by()` for the key columns of the given iterator type.
+        //!
+        //! It can be specialized for the columns with dedicated kernels (e.g., the packed columns, see
+        //! joint_packed.hpp); the specialization must be declared before `sort_by()` is called.
+        template<typename KeyIterator, typename Compare>
+        struct key_sorter
+        {
+            template<size_t I, typename... Iterators>
+            static void sort(iterator<Iterators...> first, iterator<Iterators...> last, Compare & comp,
+                             memory_resource * resource)
+            {
+                sort_by_impl<I>(first, last, comp, resource, is_string_key<KeyIterator, Compare>());
+            }
+        };
+
+    }
+
+    //! Stable sort of a joint range according to the I-th column.
+    //!
+    //! This is an adaptive merge sort (TimSort): existing ascending and strictly descending runs of the keys are
+    //! detected (the latter are reversed), short runs are extended by a binary insertion sort and the runs are merged
+    //! with galloping. Already sorted input is therefore handled in a linear time. The comparator is called on the
+    //! keys (the I-th column values) only and the merges work column by column through single column buffers taken
+    //! from an arena on top of `resource`, hence no value wrappers are created at all. Returns the sorted range.
+    template<size_t I, typename... Iterators, typename Compare = less>
+    sorted_range_by<I, Compare, Iterators...> stable_sort_by(iterator<Iterators...> first, iterator<Iterators...> last,
+                                                             Compare comp = Compare(),
+                                                             memory_resource * resource = default_resource())
+    {
+        std::size_t const n = last - first;
+        if (n < 2) return sorted_range_by<I, Compare, Iterators...>(first, last, comp);
+
+        phase_timer timer(phase::sort, n);
+
+        std::size_t const min_run = detail::min_run_length(n);
+
+        scratch_arena arena(0, resource);
+        detail::run_merger<I, iterator<Iterators...>, Compare> merger(first, comp, & arena);
+
+        for (std::size_t base = 0; base < n;)
+        {
+            std::size_t length = detail::count_run<I>(first + base, n - base, comp);
+            if (length < min_run)
+            {
+                std::size_t forced = std::min(min_run, n - base);
+                detail::binary_insertion_sort<I>(first + base, forced, length, comp);
+                length = forced;
+            }
+
+            merger.push(base, length);
+            base += length;
+        }
+
+        merger.finish();
+        return sorted_range_by<I, Compare, Iterators...>(first, last, comp);
+    }
+
+    //! Stable sort of a joint range according to the first column (see above).
+    template<typename... Iterators, typename Compare = less>
+    sorted_range_by<0, Compare, Iterators...> stable_sort(iterator<Iterators...> first, iterator<Iterators...> last,
+                                                          Compare comp = Compare(),
+                                                          memory_resource * resource = default_resource())
+    {
+        return stable_sort_by<0>(first, last, comp, resource);
+    }
+
+    //! Sort a joint range according to the I-th column.
+    //!
+    //! The comparator is called on the keys (the I-th column values) only. The algorithm is chosen according to
+    //! the key type:
+    //!
+    //! - `std::string` keys in the default order: the rows are sorted as indices with a cached 8-byte prefix of their
+    //!   keys and the full keys are consulted only for the tied prefixes; the rows are permuted once at the end.
+    //! - otherwise: the order of the keys is found in a cheap pass first. Sorted keys are left in place, strictly
+    //!   descending keys are reversed column by column, keys with few distinct values (in a sample) are sorted by
+    //!   the quicksort with three-way partitioning, nearly sorted keys by `stable_sort_by<I>()` and the rest by
+    //!   the pattern-defeating quicksort with branchless block partitioning. Integer keys in the natural order
+    //!   spanning less values than there are rows (at most `detail::max_counting_buckets`) are sorted by
+    //!   `counting_sort_by<I>()` instead, unless nearly sorted.
+    //!
+    //! Returns the sorted range (see `sorted_range`), so that the searches, merges and joins need not check it.
+    template<size_t I, typename... Iterators, typename Compare = less>
+    sorted_range_by<I, Compare, Iterators...> sort_by(iterator<Iterators...> first, iterator<Iterators...> last,
+                                                      Compare comp = Compare(),
+                                                      memory_resource * resource = default_resource())
+    {
+        typedef typename std::tuple_element<I, std::tuple<Iterators...>>::type key_iterator;
+
+        if (last - first >= 2) detail::key_sorter<key_iterator, Compare>::template sort<I>(first, last, comp, resource);
+        return sorted_range_by<I, Compare, Iterators...>(first, last, comp);
+    }
+
+    //! Sort a joint range according to the first column (see above).
+    template<typename... Iterators, typename Compare = less>
+    sorted_range_by<0, Compare, Iterators...> sort(iterator<Iterators...> first, iterator<Iterators...> last,
+                                                   Compare comp = Compare(),
+                                                   memory_resource * resource = default_resource())
+    {
+        return sort_by<0>(first, last, comp, resource);
+    }
+
+    //! First row of a joint range sorted by the I-th column whose key is not less than `key` (usable in constant
+    //! expressions, unlike `std::lower_bound()` before C++20).
+    template<size_t I, typename... Iterators, typename Key, typename Compare = less>
+    JOINT_CONSTEXPR iterator<Iterators...> constexpr_lower_bound_by(iterator<Iterators...> first,
+                                                                    iterator<Iterators...> last, Key const & key,
+                                                                    Compare comp = Compare())
+    {
+        typename iterator<Iterators...>::difference_type n = last - first;
+        while (n > 0)
+        {
+            auto const half = n / 2;
+            if (comp(* (first + half).template get<I>(), key))
+            {
+                first += half + 1;
+                n     -= half + 1;
+            }
+            else
+                n = half;
+        }
+        return first;
+    }
+
+    //! Sort a joint range according to the I-th column in a constant expression.
+    //!
+    //! Since C++14, the joint iterators are usable in constant expressions, hence tables of parallel columns (e.g.,
+    //! `std::array` columns of keywords and their ids since C++17) can be sorted at compile time instead of in
+    //! static initializers. It is a stable binary insertion sort moving the rows through the value and reference
+    //! wrappers only (no scratch memory, no threads), i.e., it makes O(n^2) moves and is meant for small tables.
+    template<size_t I, typename... Iterators, typename Compare = less>
+    JOINT_CONSTEXPR void constexpr_sort_by(iterator<Iterators...> first, iterator<Iterators...> last,
+                                           Compare comp = Compare())
+    {
+        typedef typename iterator<Iterators...>::value_type      value_type;
+        typedef typename iterator<Iterators...>::difference_type difference_type;
+
+        difference_type const n = last - first;
+        for (difference_type i = 1; i < n; ++i)
+        {
+            value_type value = * (first + i);
+
+            // Insert after the rows with the same key.
+            difference_type lo = 0, hi = i;
+            while (lo < hi)
+            {
+                difference_type const mid = lo + (hi - lo) / 2;
+                if (comp(value.template get<I>(), * (first + mid).template get<I>()))
+                    hi = mid;
+                else
+                    lo = mid + 1;
+            }
+
+            for (difference_type j = i; j > lo; --j) * (first + j) = * (first + (j - 1));
+            * (first + lo) = std::move(value);
+        }
+    }
+
+    //! Sort a joint range according to the first column in a constant expression (see above).
+    template<typename... Iterators, typename Compare = less>
+    JOINT_CONSTEXPR void constexpr_sort(iterator<Iterators...> first, iterator<Iterators...> last,
+                                        Compare comp = Compare())
+    {
+        constexpr_sort_by<0>(first, last, comp);
+    }
+
+    namespace detail
+    {
+
+        //! The order of the keys found before sorting.
+        enum class presortedness
+        {
+            sorted,         // non-descending
+            reversed,       // strictly descending
+            nearly_sorted,  // few descents
+            few_unique,     // few distinct keys in a sample
+            random
+        };
+
+        //! Maximal number of descents per row of a nearly sorted range (as a divisor of the number of rows).
+        constexpr std::size_t nearly_sorted_ratio = 64;
+
+        //! Number of the keys sampled to estimate the number of distinct keys.
+        constexpr std::size_t distinct_sample = 128;
+
+        //! Maximal number of distinct keys in the sample of a range with few distinct keys.
+        constexpr std::size_t few_unique = 16;
+
+        //! Find the order of the keys.
+        //!
+        //! The descents (and ascents) of the neighbouring keys are counted in a single pass, which stops as soon as
+        //! there are too many of them for a nearly sorted range (so that it costs only a fraction of the comparisons
+        //! on random keys). Otherwise, the distinct keys of an evenly spaced sample are counted.
+        template<size_t I, typename... Iterators, typename Compare>
+        presortedness find_presortedness(iterator<Iterators...> first, std::size_t n, Compare & comp)
+        {
+            typedef typename std::tuple_element<I, std::tuple<Iterators...>>::type key_iterator;
+            typedef typename std::iterator_traits<key_iterator>::value_type        key_type;
+
+            auto              keys  = first.template get<I>();
+            std::size_t const limit = n / nearly_sorted_ratio;
+
+            std::size_t descents = 0, ascents = 0, i = 1;
+            for (; i < n && (descents <= limit || ascents == 0); ++i)
+            {
+                bool descent = comp(keys[i], keys[i - 1]);
+                descents += descent;
+                ascents  += !descent;
+            }
+
+            if (i == n)
+            {
+                if (descents == 0) return presortedness::sorted;
+                if (ascents == 0) return presortedness::reversed;
+                if (descents <= limit) return presortedness::nearly_sorted;
+            }
+
+            std::vector<key_type> sample;
+            sample.reserve(distinct_sample);
+            for (std::size_t k = 0; k < distinct_sample; ++k)
+                sample.push_back(keys[chunk_begin(k, distinct_sample, n)]);
+            std::sort(sample.begin(), sample.end(), comp);
+
+            std::size_t distinct = 1;
+            for (std::size_t k = 1; k < sample.size(); ++k) distinct += comp(sample[k - 1], sample[k]);
+
+            return distinct <= few_unique ? presortedness::few_unique : presortedness::random;
+        }
+
+        //! Sort the rows by a quicksort with the three-way partitioning (efficient for few distinct keys).
+        //!
+        //! Each partitioning step puts all the keys equal to the pivot (median of three) into their final positions
+        //! and the rows are moved column by column. The smaller part is sorted recursively; if the recursion gets
+        //! too deep (on an adversarial input), the rest is left to `stable_sort_by<I>()`.
+        template<size_t I, typename... Iterators, typename Compare>
+        void three_way_quicksort(iterator<Iterators...> first, std::size_t n, Compare & comp, std::size_t depth,
+                                 memory_resource * resource)
+        {
+            typedef typename std::tuple_element<I, std::tuple<Iterators...>>::type key_iterator;
+            typedef typename std::iterator_traits<key_iterator>::value_type        key_type;
+
+            while (n > max_insertion_size)
+            {
+                if (depth-- == 0)
+                {
+                    stable_sort_by<I>(first, first + n, comp, resource);
+                    return;
+                }
+
+                auto             keys = first.template get<I>();
+                key_type const & a = keys[0], & b = keys[n / 2], & c = keys[n - 1];
+                key_type const   pivot = comp(a, b) ? (comp(b, c) ? b : (comp(a, c) ? c : a))
+                                                    : (comp(a, c) ? a : (comp(b, c) ? c : b));
+
+                auto less_than_pivot = [&](key_type const & key) { return comp(key, pivot); };
+                auto not_above_pivot = [&](key_type const & key) { return !comp(pivot, key); };
+
+                iterator<Iterators...> last = first + n;
+                std::size_t const      m1   = partition_by<I>(seq, first, last, less_than_pivot, resource) - first;
+                iterator<Iterators...> rest = first + m1;
+                std::size_t const      m2   = partition_by<I>(seq, rest, last, not_above_pivot, resource) - first;
+
+                if (m1 < n - m2)
+                {
+                    three_way_quicksort<I>(first, m1, comp, depth, resource);
+                    first = first + m2;
+                    n    -= m2;
+                }
+                else
+                {
+                    three_way_quicksort<I>(first + m2, n - m2, comp, depth, resource);
+                    n = m1;
+                }
+            }
+
+            binary_insertion_sort<I>(first, n, 1, comp);
+        }
+
+        //! Number of the rows of a block of the partitioning of the pattern-defeating quicksort.
+        constexpr std::size_t pdq_block_size = 64;
+
+        //! Segments smaller than this are sorted by the insertion sort.
+        constexpr std::size_t pdq_insertion_size = 24;
+
+        //! Segments larger than this take the pivot as the median of three medians of three (Tukey's ninther).
+        constexpr std::size_t pdq_ninther_size = 128;
+
+        //! Maximal number of the rows moved by the insertion sort of a partition found already partitioned.
+        constexpr std::size_t pdq_partial_insertion_limit = 8;
+
+        //! Swap the rows `i` and `j` (column by column).
+        template<typename... Iterators>
+        void swap_rows(iterator<Iterators...> first, std::size_t i, std::size_t j)
+        {
+            iterator<Iterators...> other = first;
+            std::iter_swap(first + i, other + j);
+        }
+
+        //! Sort the rows `a`, `b` and `c` by their keys.
+        template<size_t I, typename... Iterators, typename Compare>
+        void sort3(iterator<Iterators...> first, std::size_t a, std::size_t b, std::size_t c, Compare & comp)
+        {
+            auto keys = first.template get<I>();
+            if (comp(keys[b], keys[a])) swap_rows(first, a, b);
+            if (comp(keys[c], keys[b])) swap_rows(first, b, c);
+            if (comp(keys[b], keys[a])) swap_rows(first, a, b);
+        }
+
+        //! Move the rows of the recorded offsets of a block across the partition (in a single column).
+        //!
+        //! The `i`-th row from the left `base_l + offsets_l[i]` (not less than the pivot) is exchanged with the
+        //! `i`-th row from the right `base_r - offsets_r[i]` (less than the pivot). Unless the numbers of the rows
+        //! on both sides were equal, the rows are moved in a single cycle (one move per entry instead of three).
+        struct offset_swapper
+        {
+            std::size_t           base_l;
+            std::size_t           base_r;
+            unsigned char const * offsets_l;
+            unsigned char const * offsets_r;
+            std::size_t           num;
+            bool                  use_swaps;
+
+            template<typename I> void operator()(I column)
+            {
+                typedef typename std::iterator_traits<I>::value_type value_type;
+
+                if (use_swaps)
+                {
+                    for (std::size_t i = 0; i < num; ++i)
+                        std::iter_swap(column + (base_l + offsets_l[i]), column + (base_r - offsets_r[i]));
+                }
+                else if (num > 0)
+                {
+                    I l = column + (base_l + offsets_l[0]), r = column + (base_r - offsets_r[0]);
+
+                    value_type value = std::move(* l);
+                    * l = std::move(* r);
+                    for (std::size_t i = 1; i < num; ++i)
+                    {
+                        l   = column + (base_l + offsets_l[i]);
+                        * r = std::move(* l);
+                        r   = column + (base_r - offsets_r[i]);
+                        * l = std::move(* r);
+                    }
+                    * r = std::move(value);
+                }
+            }
+        };
+
+        //! Partition the rows by the pivot (the key of the first row) into the rows less than it and the rest.
+        //!
+        //! The rows are scanned by blocks from both ends: the comparisons with the pivot are recorded into two
+        //! small offset buffers without branching (BlockQuicksort), so mispredicted comparisons do not cost
+        //! anything. Then the misplaced rows are moved across the partition column by column (see
+        //! `offset_swapper`). Returns the final position of the pivot row and whether the rows were partitioned
+        //! already. The pivot must be the median of three or more rows (some rows are not less than it).
+        template<size_t I, typename... Iterators, typename Compare>
+        std::pair<std::size_t, bool> partition_right_branchless(iterator<Iterators...> first, std::size_t n,
+                                                                Compare & comp)
+        {
+            typedef typename std::tuple_element<I, std::tuple<Iterators...>>::type key_iterator;
+            typedef typename std::iterator_traits<key_iterator>::value_type        key_type;
+
+            auto           keys  = first.template get<I>();
+            key_type const pivot = keys[0];
+
+            // Find the first rows on both ends which are not on their side.
+            std::size_t f = 0, l = n;
+            while (comp(keys[++f], pivot)) { }
+            if (f == 1)
+                while (f < l && !comp(keys[--l], pivot)) { }
+            else
+                while (!comp(keys[--l], pivot)) { }
+
+            bool const already_partitioned = f >= l;
+            if (!already_partitioned)
+            {
+                swap_rows(first, f, l);
+                ++f;
+
+                auto iterators = first.iterators();
+
+                unsigned char offsets_l[pdq_block_size], offsets_r[pdq_block_size];
+                std::size_t   base_l = f, base_r = l, num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+                while (f < l)
+                {
+                    // Fill the empty offset buffers from the unknown rows (halving them for the last blocks).
+                    std::size_t const unknown     = l - f;
+                    std::size_t const left_split  = num_l == 0 ? (num_r == 0 ? unknown / 2 : unknown) : 0;
+                    std::size_t const right_split = num_r == 0 ? unknown - left_split : 0;
+
+                    std::size_t const size_l = std::min(left_split, pdq_block_size);
+                    for (std::size_t i = 0; i < size_l; ++i)
+                    {
+                        offsets_l[num_l] = static_cast<unsigned char>(i);
+                        num_l += !comp(keys[f++], pivot);
+                    }
+
+                    std::size_t const size_r = std::min(right_split, pdq_block_size);
+                    for (std::size_t i = 0; i < size_r; ++i)
+                    {
+                        offsets_r[num_r] = static_cast<unsigned char>(i + 1);
+                        num_r += comp(keys[--l], pivot);
+                    }
+
+                    std::size_t const num = std::min(num_l, num_r);
+                    for_each_one_tuple(iterators, offset_swapper{base_l, base_r, offsets_l + start_l,
+                                                                 offsets_r + start_r, num, num_l == num_r});
+                    num_l   -= num;
+                    num_r   -= num;
+                    start_l += num;
+                    start_r += num;
+
+                    if (num_l == 0)
+                    {
+                        start_l = 0;
+                        base_l  = f;
+                    }
+                    if (num_r == 0)
+                    {
+                        start_r = 0;
+                        base_r  = l;
+                    }
+                }
+
+                // The rest of one of the buffers is moved to the middle.
+                if (num_l > 0)
+                {
+                    while (num_l-- > 0) swap_rows(first, base_l + offsets_l[start_l + num_l], --l);
+                    f = l;
+                }
+                if (num_r > 0)
+                {
+                    while (num_r-- > 0) swap_rows(first, base_r - offsets_r[start_r + num_r], f++);
+                    l = f;
+                }
+            }
+
+            std::size_t const pivot_position = f - 1;
+            swap_rows(first, 0, pivot_position);
+            return std::make_pair(pivot_position, already_partitioned);
+        }
+
+        //! Partition the rows by the pivot (the key of the first row) into the rows not greater than it and the
+        //! rest and return the final position of the pivot row (used when the pivot equals the key preceding the
+        //! rows, so that the equal keys are not partitioned again).
+        template<size_t I, typename... Iterators, typename Compare>
+        std::size_t partition_left(iterator<Iterators...> first, std::size_t n, Compare & comp)
+        {
+            typedef typename std::tuple_element<I, std::tuple<Iterators...>>::type key_iterator;
+            typedef typename std::iterator_traits<key_iterator>::value_type        key_type;
+
+            auto           keys  = first.template get<I>();
+            key_type const pivot = keys[0];
+
+            std::size_t f = 0, l = n;
+            while (comp(pivot, keys[--l])) { }
+            if (l + 1 == n)
+                while (f < l && !comp(pivot, keys[++f])) { }
+            else
+                while (!comp(pivot, keys[++f])) { }
+
+            while (f < l)
+            {
+                swap_rows(first, f, l);
+                while (comp(pivot, keys[--l])) { }
+                while (!comp(pivot, keys[++f])) { }
+            }
+
+            swap_rows(first, 0, l);
+            return l;
+        }
+
+        //! Sort the rows by the insertion sort unless more than `pdq_partial_insertion_limit` rows need to be moved
+        //! (returns whether the rows got sorted).
+        template<size_t I, typename... Iterators, typename Compare>
+        bool partial_insertion_sort(iterator<Iterators...> first, std::size_t n, Compare & comp)
+        {
+            auto        keys      = first.template get<I>();
+            auto        iterators = first.iterators();
+            std::size_t moved     = 0;
+
+            for (std::size_t i = 1; i < n; ++i)
+            {
+                if (!comp(keys[i], keys[i - 1])) continue;
+
+                std::size_t j = i - 1;
+                while (j > 0 && comp(keys[i], keys[j - 1])) --j;
+                for_each_one_tuple(iterators, entry_shifter{j, i});
+
+                moved += i - j;
+                if (moved > pdq_partial_insertion_limit) return false;
+            }
+            return true;
+        }
+
+        //! Sort the rows by the pattern-defeating quicksort (pdqsort) on the key column.
+        //!
+        //! The pivot is the median of three (or the ninther), the partitioning is branchless (see
+        //! `partition_right_branchless()`). The patterns are defeated as follows: a partition found partitioned
+        //! already is finished by the partial insertion sort (sorted and nearly sorted segments take linear time),
+        //! a pivot equal to the key preceding the segment puts all the equal keys in place by `partition_left()`
+        //! and a highly unbalanced partition shuffles a few rows of both parts. After `bad_allowed` unbalanced
+        //! partitions (an adversarial input), the rest is left to `stable_sort_by<I>()`.
+        template<size_t I, typename... Iterators, typename Compare>
+        void pdqsort(iterator<Iterators...> first, std::size_t n, Compare & comp, std::size_t bad_allowed,
+                     bool leftmost, memory_resource * resource)
+        {
+            while (true)
+            {
+                if (n < pdq_insertion_size)
+                {
+                    binary_insertion_sort<I>(first, n, 1, comp);
+                    return;
+                }
+
+                std::size_t const half = n / 2;
+                if (n > pdq_ninther_size)
+                {
+                    sort3<I>(first, 0, half, n - 1, comp);
+                    sort3<I>(first, 1, half - 1, n - 2, comp);
+                    sort3<I>(first, 2, half + 1, n - 3, comp);
+                    sort3<I>(first, half - 1, half, half + 1, comp);
+                    swap_rows(first, 0, half);
+                }
+                else
+                    sort3<I>(first, half, 0, n - 1, comp);
+
+                // The key preceding the segment (of its parent partition) is not greater than any key of it.
+                auto keys = first.template get<I>();
+                if (!leftmost && !comp(keys[-1], keys[0]))
+                {
+                    std::size_t const position = partition_left<I>(first, n, comp) + 1;
+                    first = first + position;
+                    n    -= position;
+                    continue;
+                }
+
+                auto const        partition = partition_right_branchless<I>(first, n, comp);
+                std::size_t const pivot     = partition.first;
+                std::size_t const l_size    = pivot, r_size = n - pivot - 1;
+
+                if (l_size < n / 8 || r_size < n / 8)
+                {
+                    if (--bad_allowed == 0)
+                    {
+                        stable_sort_by<I>(first, first + n, comp, resource);
+                        return;
+                    }
+
+                    if (l_size >= pdq_insertion_size)
+                    {
+                        swap_rows(first, 0, l_size / 4);
+                        swap_rows(first, pivot - 1, pivot - l_size / 4);
+                        if (l_size > pdq_ninther_size)
+                        {
+                            swap_rows(first, 1, l_size / 4 + 1);
+                            swap_rows(first, 2, l_size / 4 + 2);
+                            swap_rows(first, pivot - 2, pivot - (l_size / 4 + 1));
+                            swap_rows(first, pivot - 3, pivot - (l_size / 4 + 2));
+                        }
+                    }
+                    if (r_size >= pdq_insertion_size)
+                    {
+                        swap_rows(first, pivot + 1, pivot + 1 + r_size / 4);
+                        swap_rows(first, n - 1, n - r_size / 4);
+                        if (r_size > pdq_ninther_size)
+                        {
+                            swap_rows(first, pivot + 2, pivot + 2 + r_size / 4);
+                            swap_rows(first, pivot + 3, pivot + 3 + r_size / 4);
+                            swap_rows(first, n - 2, n - (1 + r_size / 4));
+                            swap_rows(first, n - 3, n - (2 + r_size / 4));
+                        }
+                    }
+                }
+                else if (partition.second && partial_insertion_sort<I>(first, l_size, comp)
+                         && partial_insertion_sort<I>(first + (pivot + 1), r_size, comp))
+                    return;
+
+                pdqsort<I>(first, l_size, comp, bad_allowed, leftmost, resource);
+                first    = first + (pivot + 1);
+                n        = r_size;
+                leftmost = false;
+            }
+        }
+
+        //! Maximal number of the buckets (distinct key values) of the counting sort.
+        constexpr std::size_t max_counting_buckets = std::size_t(1) << 16;
+
+        //! Check whether the keys are integers (or enumerations) in their natural order (suitable for the counting
+        //! sort).
+        template<typename KeyIterator, typename Compare,
+                 typename K = typename std::iterator_traits<KeyIterator>::value_type>
+        struct is_counting_key
+                : std::integral_constant<bool,
+                                         (std::is_integral<K>::value || std::is_enum<K>::value)
+                                         && (std::is_same<Compare, less>::value
+                                             || std::is_same<Compare, std::less<K>>::value)>
+        {
+        };
+
+        //! Rank of an integer key (the differences of ranks are the differences of the keys modulo 2^64).
+        template<typename K>
+        typename std::enable_if<std::is_integral<K>::value, std::uint64_t>::type key_rank(K key)
+        {
+            return static_cast<std::uint64_t>(key);
+        }
+
+        //! Rank of an enumeration key (see above).
+        template<typename K>
+        typename std::enable_if<std::is_enum<K>::value, std::uint64_t>::type key_rank(K key)
+        {
+            return static_cast<std::uint64_t>(static_cast<typename std::underlying_type<K>::type>(key));
+        }
+
+        //! Report a key outside of the declared range of a counting sort (asserting in the debug builds).
+        inline void key_out_of_range(char const * message)
+        {
+            assert(!"The keys must be within the declared range [min, max].");
+            throw std::out_of_range(message);
+        }
+
+        //! Number of the buckets of the keys within `[min, max]` (checking the range).
+        template<typename Key>
+        std::size_t counting_buckets(Key min, Key max)
+        {
+            if (max < min) key_out_of_range("joint: the range of the keys is empty (max < min)");
+
+            std::uint64_t const span = key_rank(max) - key_rank(min);
+            if (span >= static_cast<std::uint64_t>(static_cast<std::size_t>(-1)))
+                key_out_of_range("joint: the range of the keys is too large");
+            return static_cast<std::size_t>(span) + 1;
+        }
+
+        //! Count the keys of each bucket into `offsets[1, buckets]` and turn the counts into the bucket offsets.
+        //!
+        //! A key outside of the buckets is reported by `key_out_of_range()` before anything is moved. Returns false
+        //! if all the keys are in a single bucket (so that the rows are sorted already).
+        template<typename KeyIterator, typename Offsets>
+        bool bucket_offsets(KeyIterator keys, std::size_t n, std::uint64_t min, Offsets & offsets)
+        {
+            std::size_t const buckets = offsets.size() - 1;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                std::uint64_t const k = key_rank(keys[i]) - min;
+                if (k >= buckets) key_out_of_range("joint: a key is out of the declared range [min, max]");
+                ++offsets[k + 1];
+            }
+
+            for (std::size_t b = 1; b <= buckets; ++b)
+            {
+                if (offsets[b] == n) return false;
+                offsets[b] += offsets[b - 1];
+            }
+            return true;
+        }
+
+        //! Sort the rows by the counting sort of the integer keys of the ranks `[min, min + buckets)`.
+        //!
+        //! A histogram of the keys is turned into the bucket offsets by a prefix sum and the row indices are
+        //! scattered into the buckets, then each column is gathered through a single column buffer by `permute()`.
+        //! The sort is stable and it costs two passes over the keys and two moves of each entry.
+        template<size_t I, typename... Iterators>
+        void counting_sort(iterator<Iterators...> first, std::size_t n, std::uint64_t min, std::size_t buckets,
+                           memory_resource * resource)
+        {
+            auto keys = first.template get<I>();
+
+            scratch_vector<std::size_t> offsets(buckets + 1, 0, scratch_allocator<std::size_t>(resource));
+            {
+                phase_timer timer(phase::key_extraction, n);
+                if (!bucket_offsets(keys, n, min, offsets)) return;
+            }
+
+            scratch_vector<std::size_t> order(n, 0, scratch_allocator<std::size_t>(resource));
+            {
+                phase_timer timer(phase::sort, n);
+                for (std::size_t i = 0; i < n; ++i) order[offsets[key_rank(keys[i]) - min]++] = i;
+            }
+
+            permute(first, first + n, order.begin(), resource);
+        }
+
+        //! Sort the rows by the American flag sort (an in-place counting sort) of the keys of the ranks
+        //! `[min, min + buckets)`.
+        //!
+        //! After the histogram pass, the buckets are filled in turn: the row at the cursor of the current bucket is
+        //! either in its bucket already or it is swapped to the cursor of its own (later) bucket. Every row is thus
+        //! swapped at most once, no buffers but the bucket offsets are needed. The sort is not stable.
+        template<size_t I, typename... Iterators>
+        void american_flag_sort(iterator<Iterators...> first, std::size_t n, std::uint64_t min, std::size_t buckets,
+                                memory_resource * resource)
+        {
+            auto keys = first.template get<I>();
+
+            scratch_vector<std::size_t> offsets(buckets + 1, 0, scratch_allocator<std::size_t>(resource));
+            {
+                phase_timer timer(phase::key_extraction, n);
+                if (!bucket_offsets(keys, n, min, offsets)) return;
+            }
+
+            phase_timer timer(phase::sort, n, n * row_bytes<Iterators...>::value);
+
+            scratch_vector<std::size_t> next(offsets.begin(), offsets.end() - 1,
+                                             scratch_allocator<std::size_t>(resource));
+            for (std::size_t b = 0; b + 1 < buckets; ++b)
+            {
+                while (next[b] < offsets[b + 1])
+                {
+                    std::size_t const k = key_rank(keys[next[b]]) - min;
+                    if (k == b)
+                    {
+                        ++next[b];
+                        continue;
+                    }
+                    iterator<Iterators...> from = first, to = first;
+                    swap(* (from + next[b]), * (to + next[k]++));
+                }
+            }
+        }
+
+        //! Find the ranks of the least and the greatest key.
+        template<typename KeyIterator>
+        std::pair<std::uint64_t, std::uint64_t> key_rank_range(KeyIterator keys, std::size_t n)
+        {
+            typedef typename std::iterator_traits<KeyIterator>::value_type key_type;
+
+            key_type min = keys[0], max = keys[0];
+            for (std::size_t i = 1; i < n; ++i)
+            {
+                key_type const & key = keys[i];
+                if (key < min) min = key;
+                if (max < key) max = key;
+            }
+            return std::make_pair(key_rank(min), key_rank(max));
+        }
+
+        //! Sort by the counting sort if the keys span at most `max_counting_buckets` values (and not more than
+        //! the number of rows, so that the histogram is not more expensive than the sort itself).
+        template<size_t I, typename... Iterators>
+        bool try_counting_sort(iterator<Iterators...> first, std::size_t n, memory_resource * resource,
+                               std::true_type)
+        {
+            auto const range = key_rank_range(first.template get<I>(), n);
+
+            std::uint64_t const span = range.second - range.first;
+            if (span >= max_counting_buckets || span >= n) return false;
+
+            counting_sort<I>(first, n, range.first, static_cast<std::size_t>(span) + 1, resource);
+            return true;
+        }
+
+        //! Keys of other types are not sorted by the counting sort.
+        template<size_t I, typename... Iterators>
+        bool try_counting_sort(iterator<Iterators...>, std::size_t, memory_resource *, std::false_type)
+        {
+            return false;
+        }
+
+        //! Sort by a general key column according to the order of the keys found in advance.
+        template<size_t I, typename... Iterators, typename Compare>
+        void sort_by_impl(iterator<Iterators...> first, iterator<Iterators...> last, Compare & comp,
+                          memory_resource * resource, std::false_type)
+        {
+            typedef typename std::tuple_element<I, std::tuple<Iterators...>>::type key_iterator;
+
+            std::size_t const n = last - first;
+
+            switch (find_presortedness<I>(first, n, comp))
+            {
+                case presortedness::sorted:
+                    break;
+
+                case presortedness::reversed:
+                {
+                    auto iterators = first.iterators();
+                    for_each_one_tuple(iterators, range_reverser{n});
+                    break;
+                }
+
+                case presortedness::few_unique:
+                {
+                    if (try_counting_sort<I>(first, n, resource, is_counting_key<key_iterator, Compare>())) break;
+
+                    phase_timer timer(phase::sort, n);
+                    std::size_t depth = 0;
+                    for (std::size_t m = n; m > 1; m /= 2) depth += 2;
+                    three_way_quicksort<I>(first, n, comp, depth, resource);
+                    break;
+                }
+
+                case presortedness::random:
+                {
+                    if (try_counting_sort<I>(first, n, resource, is_counting_key<key_iterator, Compare>())) break;
+
+                    phase_timer timer(phase::sort, n);
+                    std::size_t bad_allowed = 1;
+                    for (std::size_t m = n; m > 1; m /= 2) ++bad_allowed;
+                    pdqsort<I>(first, n, comp, bad_allowed, true, resource);
+                    break;
+                }
+
+                case presortedness::nearly_sorted:
+                    stable_sort_by<I>(first, last, comp, resource);
+                    break;
+            }
+        }
+
+    }
+
+    //! Sort a joint range by the counting sort of the I-th column of integer keys within `[min, max]`.
+    //!
+    //! This is meant for the keys of a small declared range (e.g., codes of a status) for which a histogram is
+    //! cheaper than the comparisons: the row indices are scattered into the buckets of the keys and the columns are
+    //! gathered one by one through a buffer from `resource` (see `detail::counting_sort()`). The sort is stable.
+    //! `sort_by<I>()` uses it on its own for integer keys spanning less values than there are rows.
+    //!
+    //! Precondition: `min <= max` and all the keys are within `[min, max]`. Otherwise, `std::out_of_range` is
+    //! thrown (the debug builds assert) and the range is left unchanged.
+    template<size_t I, typename... Iterators, typename Key>
+    void counting_sort_by(iterator<Iterators...> first, iterator<Iterators...> last, Key min, Key max,
+                          memory_resource * resource = default_resource())
+    {
+        std::size_t const buckets = detail::counting_buckets(min, max);
+        if (last - first < 2) return;
+        detail::counting_sort<I>(first, last - first, detail::key_rank(min), buckets, resource);
+    }
+
+    //! Sort a joint range by the counting sort of the first column (see above).
+    template<typename... Iterators, typename Key>
+    void counting_sort(iterator<Iterators...> first, iterator<Iterators...> last, Key min, Key max,
+                       memory_resource * resource = default_resource())
+    {
+        counting_sort_by<0>(first, last, min, max, resource);
+    }
+
+    //! Sort a joint range in place by the American flag sort of the I-th column of integer keys within
+    //! `[min, max]`.
+    //!
+    //! Unlike `counting_sort_by<I>()`, no column buffers are needed (only the offsets of the buckets), the rows
+    //! are swapped into their buckets instead. The sort is not stable. The keys must be within `[min, max]` (see
+    //! above).
+    template<size_t I, typename... Iterators, typename Key>
+    void american_flag_sort_by(iterator<Iterators...> first, iterator<Iterators...> last, Key min, Key max,
+                               memory_resource * resource = default_resource())
+    {
+        std::size_t const buckets = detail::counting_buckets(min, max);
+        if (last - first < 2) return;
+        detail::american_flag_sort<I>(first, last - first, detail::key_rank(min), buckets, resource);
+    }
+
+    //! Sort a joint range in place by the American flag sort of the first column (see above).
+    template<typename... Iterators, typename Key>
+    void american_flag_sort(iterator<Iterators...> first, iterator<Iterators...> last, Key min, Key max,
+                            memory_resource * resource = default_resource())
+    {
+        american_flag_sort_by<0>(first, last, min, max, resource);
+    }
+
+    //! Sort independently each segment of a joint range according to the I-th column.
+    //!
+    //! The segments are given by the offsets `[offsets_first, offsets_last)` (relative to `first`), the `k`-th
+    //! segment being `[offsets_first[k], offsets_first[k + 1])`, i.e., there is one more offset than segments (as in
+    //! the compressed sparse row format). The segments are distributed over the tasks in chunks of roughly the same
+    //! number of rows and each segment is sorted by a kernel suited for its size: tiny segments by sorting networks,
+    //! medium ones by the insertion sort and the large ones by `stable_sort_by<I>()`. The sort is not stable for
+    //! segments of up to `detail::max_network_size` rows.
+    template<size_t I, typename Policy, typename... Iterators, typename OffsetIterator, typename Compare = less>
+    void segmented_sort_by(Policy const & policy, iterator<Iterators...> first, iterator<Iterators...> last,
+                           OffsetIterator offsets_first, OffsetIterator offsets_last, Compare comp = Compare(),
+                           memory_resource * resource = default_resource())
+    {
+        std::size_t const segments = offsets_last - offsets_first;
+        if (segments < 2 || first == last) return;
+
+        std::size_t const begin  = offsets_first[0];
+        std::size_t const rows   = static_cast<std::size_t>(offsets_first[segments - 1]) - begin;
+        std::size_t const chunks = detail::chunk_count(policy, rows);
+
+        // The memory of the large segments is taken from per-task arenas sharing the same upstream.
+        synchronized_resource upstream(resource);
+
+        detail::for_each_chunk(policy, chunks, [&](std::size_t c)
+        {
+            // The chunk takes the segments starting in its part of the rows.
+            auto segment_of = [&](std::size_t chunk) -> std::size_t
+            {
+                std::size_t row = begin + detail::chunk_begin(chunk, chunks, rows);
+                return std::lower_bound(offsets_first, offsets_first + (segments - 1), row) - offsets_first;
+            };
+
+            Compare       compare(comp);
+            scratch_arena arena(0, & upstream);
+
+            for (std::size_t k = segment_of(c), e = segment_of(c + 1); k < e; ++k)
+            {
+                std::size_t from = offsets_first[k], size = static_cast<std::size_t>(offsets_first[k + 1]) - from;
+                auto        it   = first + from;
+
+                if (size <= detail::max_network_size)
+                    detail::network_sort<I>(it, size, compare);
+                else if (size <= detail::max_insertion_size)
+                    detail::binary_insertion_sort<I>(it, size, 1, compare);
+                else
+                    stable_sort_by<I>(it, it + size, compare, & arena);
+            }
+        });
+    }
+
+    //! Sort independently each segment of a joint range in parallel (see above).
+    template<size_t I, typename... Iterators, typename OffsetIterator, typename Compare = less>
+    void segmented_sort_by(iterator<Iterators...> first, iterator<Iterators...> last,
+                           OffsetIterator offsets_first, OffsetIterator offsets_last, Compare comp = Compare(),
+                           memory_resource * resource = default_resource())
+    {
+        segmented_sort_by<I>(par, first, last, offsets_first, offsets_last, comp, resource);
+    }
+
+    //! Sort independently each segment of a joint range according to the first column (see above).
+    template<typename Policy, typename... Iterators, typename OffsetIterator, typename Compare = less>
+    void segmented_sort(Policy const & policy, iterator<Iterators...> first, iterator<Iterators...> last,
+                        OffsetIterator offsets_first, OffsetIterator offsets_last, Compare comp = Compare(),
+                        memory_resource * resource = default_resource())
+    {
+        segmented_sort_by<0>(policy, first, last, offsets_first, offsets_last, comp, resource);
+    }
+
+    //! Sort independently each segment of a joint range according to the first column in parallel (see above).
+    template<typename... Iterators, typename OffsetIterator, typename Compare = less>
+    void segmented_sort(iterator<Iterators...> first, iterator<Iterators...> last,
+                        OffsetIterator offsets_first, OffsetIterator offsets_last, Compare comp = Compare(),
+                        memory_resource * resource = default_resource())
+    {
+        segmented_sort_by<0>(par, first, last, offsets_first, offsets_last, comp, resource);
+    }
+
+} // namespace joint
+
+#endif //JOINT_SORT_HPP
@@ -0,0 +1,239 @@
+//
+// Joint ranges known to be sorted (the order is carried by the type).
+//
+
+#ifndef JOINT_SORTED_RANGE_HPP
+#define JOINT_SORTED_RANGE_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "joint_iterator.hpp"
+#include "joint_merge.hpp"
+#include "joint_scratch.hpp"
+
+namespace joint
+{
+
+    //! The order of a sorted range: by the `I`-th column according to the comparator (which takes the keys).
+    template<size_t I, typename Compare = less>
+    struct order_by
+    {
+        static constexpr size_t key = I;
+        typedef Compare         compare;
+    };
+
+    template<size_t I, typename Compare>
+    constexpr size_t order_by<I, Compare>::key;
+
+    //! A joint range sorted according to the `Order` (see `order_by`).
+    //!
+    //! It is returned by the sorts (and by `assume_sorted_by<I>()` for the ranges sorted by other means) and taken
+    //! by the algorithms needing sorted input, so they neither check nor sort it again: the searches gallop on the
+    //! key column, `unique()` and `for_each_group()` walk the runs of equal keys and `merge()` and `merge_join()`
+    //! (in `joint_join.hpp`) take the key columns and the comparator from the types of the ranges. The range does
+    //! not own the rows: modifying their keys through the iterators breaks the order.
+    template<typename Order, typename... Iterators>
+    class sorted_range
+    {
+        public:
+            typedef joint::iterator<Iterators...>                              iterator;
+            typedef Order                                                      order;
+            typedef typename Order::compare                                    key_compare;
+            typedef typename std::tuple_element<Order::key, std::tuple<Iterators...>>::type
+                                                                               key_iterator;
+            typedef typename std::iterator_traits<key_iterator>::value_type    key_type;
+            typedef std::size_t                                                size_type;
+
+            //! The number of the key column.
+            static constexpr size_t key = Order::key;
+
+        public:
+            sorted_range(iterator first, iterator last, key_compare comp = key_compare())
+                    : m_first(first), m_last(last), m_comp(comp) { }
+
+            iterator begin() const { return m_first; }
+
+            iterator end() const { return m_last; }
+
+            size_type size() const { return m_last - m_first; }
+
+            bool empty() const { return m_first == m_last; }
+
+            key_compare key_comp() const { return m_comp; }
+
+            //! The sorted key column.
+            key_iterator keys() const { return m_first.template get<key>(); }
+
+            //! The first row whose key is not less than the given one.
+            //!
+            //! The searches gallop with a local copy of the comparator: the member of an empty comparator type is
+            //! never written (its copies copy no bytes), and GCC warns about passing it by reference.
+            iterator lower_bound(key_type const & k) const
+            {
+                key_compare comp = m_comp;
+                return at(detail::gallop_lower(keys(), size(), k, comp));
+            }
+
+            //! The first row whose key is greater than the given one.
+            iterator upper_bound(key_type const & k) const
+            {
+                key_compare comp = m_comp;
+                return at(detail::gallop_upper(keys(), size(), k, comp));
+            }
+
+            //! The rows whose keys are equal to the given one.
+            sorted_range equal_range(key_type const & k) const
+            {
+                key_compare       comp = m_comp;
+                std::size_t const b    = detail::gallop_lower(keys(), size(), k, comp);
+                std::size_t const e    = b + detail::gallop_upper(keys() + b, size() - b, k, comp);
+                return sorted_range(at(b), at(e), comp);
+            }
+
+            //! Check whether a row has the given key.
+            bool contains(key_type const & k) const
+            {
+                key_compare       comp = m_comp;
+                std::size_t const b    = detail::gallop_lower(keys(), size(), k, comp);
+                return b < size() && !comp(k, keys()[b]);
+            }
+
+        private:
+            iterator at(std::size_t i) const
+            {
+                iterator it = m_first;
+                return it + i;
+            }
+
+            iterator    m_first;
+            iterator    m_last;
+            key_compare m_comp;
+    };
+
+    template<typename Order, typename... Iterators>
+    constexpr size_t sorted_range<Order, Iterators...>::key;
+
+    //! A joint range sorted by the `I`-th column according to the comparator.
+    template<size_t I, typename Compare, typename... Iterators>
+    using sorted_range_by = sorted_range<order_by<I, Compare>, Iterators...>;
+
+    //! Take a joint range known to be sorted by the I-th column (checked by an assertion only).
+    template<size_t I, typename... Iterators, typename Compare = less>
+    sorted_range_by<I, Compare, Iterators...> assume_sorted_by(iterator<Iterators...> first,
+                                                               iterator<Iterators...> last, Compare comp = Compare())
+    {
+        assert(std::is_sorted(first.template get<I>(), last.template get<I>(), comp));
+        return sorted_range_by<I, Compare, Iterators...>(first, last, comp);
+    }
+
+    //! Take a joint range known to be sorted by the first column (see above).
+    template<typename... Iterators, typename Compare = less>
+    sorted_range_by<0, Compare, Iterators...> assume_sorted(iterator<Iterators...> first, iterator<Iterators...> last,
+                                                            Compare comp = Compare())
+    {
+        return assume_sorted_by<0>(first, last, comp);
+    }
+
+    namespace detail
+    {
+
+        //! Move the entry of a column from the row `from` to the row `to`.
+        struct entry_mover
+        {
+            std::size_t from;
+            std::size_t to;
+
+            template<typename I> void operator()(I column) { column[to] = std::move(column[from]); }
+        };
+
+    }
+
+    //! Remove all but the first row of each run of rows with equal keys of a sorted range.
+    //!
+    //! The runs are skipped by galloping on the key column and the kept rows are moved forward column by column.
+    //! Returns the sorted range of the kept rows (the rows past it are left in a valid but unspecified state).
+    template<typename Order, typename... Iterators>
+    sorted_range<Order, Iterators...> unique(sorted_range<Order, Iterators...> const & range)
+    {
+        typename sorted_range<Order, Iterators...>::key_compare comp = range.key_comp();
+
+        auto              keys      = range.keys();
+        auto              iterators = range.begin().iterators();
+        std::size_t const n         = range.size();
+
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < n; ++kept)
+        {
+            std::size_t const run = detail::gallop_upper(keys + i, n - i, keys[i], comp);
+            if (kept != i) detail::for_each_one_tuple(iterators, detail::entry_mover{i, kept});
+            i += run;
+        }
+
+        auto first = range.begin();
+        return sorted_range<Order, Iterators...>(first, first + kept, comp);
+    }
+
+    //! Call `f(group)` for each run of rows with equal keys of a sorted range (in the order of the keys).
+    //!
+    //! The groups are found by galloping on the key column (no hashing and no sorting) and passed as sorted ranges.
+    template<typename Order, typename... Iterators, typename F>
+    F for_each_group(sorted_range<Order, Iterators...> const & range, F f)
+    {
+        typename sorted_range<Order, Iterators...>::key_compare comp = range.key_comp();
+
+        auto              keys = range.keys();
+        auto              it   = range.begin();
+        std::size_t const n    = range.size();
+
+        for (std::size_t i = 0; i < n;)
+        {
+            std::size_t const run = detail::gallop_upper(keys + i, n - i, keys[i], comp);
+
+            auto first = it, last = it;
+            f(sorted_range<Order, Iterators...>(first + i, last + (i + run), comp));
+            i += run;
+        }
+        return f;
+    }
+
+    //! Merge two ranges sorted in the same order into the output range (see `kway_merge_by<I>()`).
+    //!
+    //! The rows of the inputs are copied (see `merge_move()` to move them instead). The merge is stable (equal keys
+    //! are taken from the left range first). Returns the sorted output range.
+    template<typename Order, typename... L, typename... Out>
+    sorted_range<Order, Out...> merge(sorted_range<Order, L...> const & left, sorted_range<Order, L...> const & right,
+                                      iterator<Out...> output, memory_resource * resource = default_resource())
+    {
+        std::pair<iterator<L...>, iterator<L...>> const ranges[] = {std::make_pair(left.begin(), left.end()),
+                                                                    std::make_pair(right.begin(), right.end())};
+
+        iterator<Out...> const last = detail::kway_merge_rows<Order::key, false>(ranges, ranges + 2, output,
+                                                                                 left.key_comp(), resource);
+        return sorted_range<Order, Out...>(output, last, left.key_comp());
+    }
+
+    //! Merge two ranges sorted in the same order into the output range moving their rows (see `merge()`).
+    //!
+    //! The rows of the inputs are left moved-from (valid but unspecified, e.g., empty strings), only the output
+    //! range is sorted afterwards.
+    template<typename Order, typename... L, typename... Out>
+    sorted_range<Order, Out...> merge_move(sorted_range<Order, L...> & left, sorted_range<Order, L...> & right,
+                                           iterator<Out...> output, memory_resource * resource = default_resource())
+    {
+        std::pair<iterator<L...>, iterator<L...>> const ranges[] = {std::make_pair(left.begin(), left.end()),
+                                                                    std::make_pair(right.begin(), right.end())};
+
+        iterator<Out...> const last = detail::kway_merge_rows<Order::key, true>(ranges, ranges + 2, output,
+                                                                                left.key_comp(), resource);
+        return sorted_range<Order, Out...>(output, last, left.key_comp());
+    }
+
+} // namespace joint
+
+#endif //JOINT_SORTED_RANGE_HPP
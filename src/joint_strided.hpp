@@ -0,0 +1,334 @@
+//
+// Strided and tiled (array of structures of arrays) columns usable in joint ranges.
+//
+
+#ifndef JOINT_STRIDED_HPP
+#define JOINT_STRIDED_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "joint_iterator.hpp"
+
+namespace joint
+{
+
+    //! A random access iterator over the entries of a column interleaved with other data.
+    //!
+    //! The `i`-th entry lies `(i / Block) * stride + (i % Block) * sizeof(T)` bytes past the first one: with
+    //! `Block = 1` the entries are `stride` bytes apart (e.g., a member of an array of structures, see
+    //! `member_iterator()`), otherwise they come in runs of `Block` consecutive entries whose starts are `stride`
+    //! bytes apart (e.g., a column of the tiles of `aosoa`). The references are ordinary references, hence the
+    //! column can take part in joint ranges (e.g., `joint::make_joint(keys.begin(), tiles.get<0>().begin())`).
+    template<typename T, std::size_t Block = 1>
+    class strided_iterator
+    {
+            static_assert(Block > 0, "The block must not be empty.");
+
+            typedef typename std::conditional<std::is_const<T>::value, char const, char>::type byte;
+
+        public:
+            typedef std::random_access_iterator_tag        iterator_category;
+            typedef typename std::remove_cv<T>::type       value_type;
+            typedef std::ptrdiff_t                         difference_type;
+            typedef T                                    * pointer;
+            typedef T                                    & reference;
+
+            strided_iterator()
+                    : m_base(nullptr), m_stride(0), m_i(0) { }
+
+            //! Iterator to the `i`-th entry of the column whose first entry is `* first`.
+            strided_iterator(T * first, std::ptrdiff_t stride, difference_type i = 0)
+                    : m_base(reinterpret_cast<byte *>(first)), m_stride(stride), m_i(i) { }
+
+            //! Conversion of a mutable iterator to a constant one.
+            template<typename U, typename = typename std::enable_if<std::is_same<U const, T>::value>::type>
+            strided_iterator(strided_iterator<U, Block> const & other)
+                    : m_base(reinterpret_cast<byte *>(other.first())), m_stride(other.stride()),
+                      m_i(other.index()) { }
+
+            reference operator*() const { return at(m_i); }
+            pointer operator->() const { return & at(m_i); }
+            reference operator[](difference_type n) const { return at(m_i + n); }
+
+            strided_iterator & operator++() { ++m_i; return * this; }
+            strided_iterator & operator--() { --m_i; return * this; }
+            strided_iterator operator++(int) { strided_iterator it(* this); ++m_i; return it; }
+            strided_iterator operator--(int) { strided_iterator it(* this); --m_i; return it; }
+
+            strided_iterator & operator+=(difference_type n) { m_i += n; return * this; }
+            strided_iterator & operator-=(difference_type n) { m_i -= n; return * this; }
+            strided_iterator operator+(difference_type n) const { return strided_iterator(first(), m_stride, m_i + n); }
+            strided_iterator operator-(difference_type n) const { return strided_iterator(first(), m_stride, m_i - n); }
+            friend strided_iterator operator+(difference_type n, strided_iterator it) { return it + n; }
+
+            difference_type operator-(strided_iterator const & other) const { return m_i - other.m_i; }
+
+            bool operator==(strided_iterator const & other) const { return m_i == other.m_i; }
+            bool operator!=(strided_iterator const & other) const { return m_i != other.m_i; }
+            bool operator<(strided_iterator const & other) const { return m_i < other.m_i; }
+            bool operator>(strided_iterator const & other) const { return m_i > other.m_i; }
+            bool operator<=(strided_iterator const & other) const { return m_i <= other.m_i; }
+            bool operator>=(strided_iterator const & other) const { return m_i >= other.m_i; }
+
+            //! The first entry of the column.
+            T * first() const { return reinterpret_cast<T *>(m_base); }
+
+            //! Number of bytes between the starts of two consecutive blocks.
+            std::ptrdiff_t stride() const { return m_stride; }
+
+            //! The index of the entry in the column.
+            difference_type index() const { return m_i; }
+
+        private:
+            reference at(difference_type i) const
+            {
+                // The dereferenced entries follow the first one, the unsigned division by a power of two is a shift.
+                std::size_t const j = static_cast<std::size_t>(i);
+                return * reinterpret_cast<T *>(m_base + static_cast<std::ptrdiff_t>(j / Block) * m_stride
+                                               + (j % Block) * sizeof(T));
+            }
+
+            byte            * m_base;
+            std::ptrdiff_t    m_stride;
+            difference_type   m_i;
+    };
+
+    //! Iterator over a member of the structures of an array starting at `first` (which must not be past the end).
+    template<typename S, typename M>
+    strided_iterator<M> member_iterator(S * first, M S::* member)
+    {
+        return strided_iterator<M>(std::addressof(first->*member), sizeof(S));
+    }
+
+    //! Iterator over a member of the constant structures of an array (see above).
+    template<typename S, typename M>
+    strided_iterator<M const> member_iterator(S const * first, M S::* member)
+    {
+        return strided_iterator<M const>(std::addressof(first->*member), sizeof(S));
+    }
+
+    //! Joint range over the given members of the structures in `[first, last)` (nothing is copied out).
+    //!
+    //! The algorithms on the range move the given members only, the other members stay in place. E.g., sorting
+    //! `joint::make_joint_members(v.data(), v.data() + v.size(), & S::key, & S::value)` sorts the keys with their
+    //! values in place of `v`.
+    template<typename S, typename... Ms>
+    std::pair<iterator<strided_iterator<Ms>...>, iterator<strided_iterator<Ms>...>>
+    make_joint_members(S * first, S * last, Ms S::*... members)
+    {
+        iterator<strided_iterator<Ms>...> begin = first == last
+                ? iterator<strided_iterator<Ms>...>(std::make_tuple(strided_iterator<Ms>(nullptr, sizeof(S))...))
+                : make_joint(member_iterator(first, members)...);
+
+        iterator<strided_iterator<Ms>...> end = begin;
+        return std::make_pair(begin, end + (last - first));
+    }
+
+    //! A view of a strided column: the range of `size()` entries starting at `begin()`.
+    template<typename T, std::size_t Block = 1>
+    class strided_column
+    {
+        public:
+            typedef strided_iterator<T, Block>                   iterator;
+            typedef typename iterator::value_type                value_type;
+            typedef typename iterator::reference                 reference;
+            typedef std::size_t                                  size_type;
+
+            strided_column(iterator first, size_type n)
+                    : m_first(first), m_size(n) { }
+
+            iterator begin() const { return m_first; }
+
+            iterator end() const { return m_first + static_cast<std::ptrdiff_t>(m_size); }
+
+            size_type size() const { return m_size; }
+
+            bool empty() const { return m_size == 0; }
+
+            reference operator[](size_type i) const { return m_first[static_cast<std::ptrdiff_t>(i)]; }
+
+        private:
+            iterator  m_first;
+            size_type m_size;
+    };
+
+    namespace detail
+    {
+
+        //! Reset the entries of the tiles from the `first`-th one to the `last`-th one to the default values.
+        struct tile_resetter
+        {
+            std::size_t first;
+            std::size_t last;
+
+            template<typename T> void operator()(T & tile)
+            {
+                for (std::size_t i = first; i < last; ++i) tile[i] = typename T::value_type();
+            }
+        };
+
+    }
+
+    //! A container of equally long columns stored in tiles of `N` rows (an array of structures of arrays).
+    //!
+    //! Each tile holds `N` consecutive entries of each column, so the entries of a column are contiguous within a
+    //! tile and the columns of a row lie in the same tile. A scan of a column reads whole cache lines of it (unlike
+    //! an array of structures) while a row gathered by a sort or a join touches a single tile (unlike separate
+    //! columns), which suits the cold payload of rows whose hot keys are kept in a packed vector:
+    //!
+    //!     joint::make_joint(keys.begin(), payload.get<0>().begin(), payload.get<1>().begin())
+    //!
+    //! The columns are traversed by `strided_iterator<T, N>` (see `get<I>()`), the rows by joint iterators as for
+    //! `columns`. A power of two `N` keeps the indexing to shifts and masks.
+    template<std::size_t N, typename... Ts>
+    class aosoa
+    {
+            static_assert(N > 0, "The tiles must not be empty.");
+
+            template<size_t I>
+            using column_type = typename std::tuple_element<I, std::tuple<Ts...>>::type;
+
+        public:
+            typedef std::tuple<std::array<Ts, N>...>                    tile_type;
+            typedef joint::iterator<strided_iterator<Ts, N>...>          iterator;
+            typedef joint::iterator<strided_iterator<Ts const, N>...>    const_iterator;
+            typedef typename iterator::value_type                        value_type;
+            typedef typename iterator::reference                         reference;
+            typedef std::size_t                                          size_type;
+
+            //! Number of rows of a tile.
+            static constexpr size_type tile_rows = N;
+
+        public:
+
+            //! Create empty columns.
+            aosoa()
+                    : m_size(0) { }
+
+            //! Create `n` default initialized rows.
+            explicit aosoa(size_type n)
+                    : m_size(0)
+            {
+                resize(n);
+            }
+
+            //! Number of rows.
+            size_type size() const { return m_size; }
+
+            //! Check whether there are no rows.
+            bool empty() const { return m_size == 0; }
+
+            //! Reserve the storage for `n` rows.
+            void reserve(size_type n) { m_tiles.reserve(tile_count(n)); }
+
+            //! Resize to `n` rows (the new rows are default initialized).
+            void resize(size_type n)
+            {
+                // The entries past the last row are kept default initialized, so that growing does not reset them.
+                if (n < m_size && n % N != 0)
+                {
+                    size_type const last = std::min<size_type>(N, m_size - n / N * N);
+                    detail::for_each_one_tuple(m_tiles[n / N], detail::tile_resetter{n % N, last});
+                }
+                m_tiles.resize(tile_count(n));
+                m_size = n;
+            }
+
+            //! Remove all the rows.
+            void clear()
+            {
+                m_tiles.clear();
+                m_size = 0;
+            }
+
+            //! Append a row given by one value per column.
+            template<typename... Args>
+            void emplace_back(Args &&... args)
+            {
+                static_assert(sizeof...(Args) == sizeof...(Ts), "One value per column is required.");
+                if (m_size % N == 0) m_tiles.emplace_back();
+                emplace_back_impl(detail::generate_sequence<sizeof...(Ts)>(), std::forward<Args>(args)...);
+                ++m_size;
+            }
+
+            //! Joint iterator to the first row.
+            iterator begin() { return make_iterator(detail::generate_sequence<sizeof...(Ts)>(), 0); }
+
+            //! Joint iterator past the last row.
+            iterator end() { return make_iterator(detail::generate_sequence<sizeof...(Ts)>(), m_size); }
+
+            //! Joint iterator to the first row.
+            const_iterator begin() const { return make_iterator(detail::generate_sequence<sizeof...(Ts)>(), 0); }
+
+            //! Joint iterator past the last row.
+            const_iterator end() const { return make_iterator(detail::generate_sequence<sizeof...(Ts)>(), m_size); }
+
+            //! Reference to the `i`-th row.
+            reference operator[](size_type i) { return * (begin() + i); }
+
+            //! Get the I-th column.
+            template<size_t I>
+            strided_column<column_type<I>, N> get()
+            {
+                return strided_column<column_type<I>, N>(column_begin<I, column_type<I>>(), m_size);
+            }
+
+            //! Get the I-th column.
+            template<size_t I>
+            strided_column<column_type<I> const, N> get() const
+            {
+                return strided_column<column_type<I> const, N>(column_begin<I, column_type<I> const>(), m_size);
+            }
+
+            //! The tiles.
+            std::vector<tile_type> const & tiles() const { return m_tiles; }
+
+        private:
+            static size_type tile_count(size_type n) { return (n + N - 1) / N; }
+
+            template<size_t I, typename T>
+            strided_iterator<T, N> column_begin() const
+            {
+                T * first = m_tiles.empty() ? nullptr : const_cast<T *>(std::get<I>(m_tiles.front()).data());
+                return strided_iterator<T, N>(first, sizeof(tile_type));
+            }
+
+            template<size_t... Is>
+            iterator make_iterator(detail::sequence<Is...>, size_type i)
+            {
+                return iterator(std::make_tuple(column_begin<Is, Ts>() + static_cast<std::ptrdiff_t>(i)...));
+            }
+
+            template<size_t... Is>
+            const_iterator make_iterator(detail::sequence<Is...>, size_type i) const
+            {
+                return const_iterator(std::make_tuple(column_begin<Is, Ts const>()
+                                                      + static_cast<std::ptrdiff_t>(i)...));
+            }
+
+            template<typename... Args, size_t... Is>
+            void emplace_back_impl(detail::sequence<Is...>, Args &&... args)
+            {
+                tile_type & tile = m_tiles.back();
+                auto l = {(std::get<Is>(tile)[m_size % N] = column_type<Is>(std::forward<Args>(args)), 0)...};
+                (void) l;
+            }
+
+            std::vector<tile_type> m_tiles;
+            size_type              m_size;
+    };
+
+    template<std::size_t N, typename... Ts>
+    constexpr typename aosoa<N, Ts...>::size_type aosoa<N, Ts...>::tile_rows;
+
+} // namespace joint
+
+#endif //JOINT_STRIDED_HPP
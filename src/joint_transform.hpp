@@ -0,0 +1,212 @@
+//
+// Element-wise algorithms (for_each_row, transform_rows, transform_reduce_rows) on joint ranges.
+//
+
+#ifndef JOINT_TRANSFORM_HPP
+#define JOINT_TRANSFORM_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "joint_iterator.hpp"
+#include "joint_parallel.hpp"
+
+namespace joint
+{
+
+    namespace detail
+    {
+
+        //! The cursor of a contiguous column is a raw pointer (so that the loops over the rows can be vectorized).
+        template<typename I>
+        typename std::enable_if<is_contiguous_iterator<I>::value, typename std::iterator_traits<I>::pointer>::type
+        column_cursor(I it)
+        {
+            return std::addressof(* it);
+        }
+
+        //! The cursor of other columns is the iterator itself.
+        template<typename I>
+        typename std::enable_if<!is_contiguous_iterator<I>::value, I>::type column_cursor(I it)
+        {
+            return it;
+        }
+
+        //! The tuple of the cursors of the columns.
+        template<typename... Iterators>
+        struct cursors_of
+        {
+            typedef std::tuple<decltype(column_cursor(std::declval<Iterators>()))...> type;
+        };
+
+        template<typename... Iterators, size_t... Is>
+        typename cursors_of<Iterators...>::type make_cursors_impl(std::tuple<Iterators...> const & t,
+                                                                  sequence<Is...>)
+        {
+            return typename cursors_of<Iterators...>::type(column_cursor(std::get<Is>(t))...);
+        }
+
+        template<typename... Iterators>
+        typename cursors_of<Iterators...>::type make_cursors(std::tuple<Iterators...> const & t)
+        {
+            return make_cursors_impl(t, generate_sequence<sizeof...(Iterators)>());
+        }
+
+    }
+
+    //! A row of a joint range passed to the functions of the element-wise algorithms.
+    //!
+    //! Unlike the reference wrapper, it holds no pointer per column: it refers to the cursors of the columns
+    //! shared by all the rows of a chunk (raw pointers for contiguous columns) and the index of the row.
+    template<typename... Cursors>
+    class row_view
+    {
+        public:
+            row_view(std::tuple<Cursors...> const & cursors, std::size_t i)
+                    : m_cursors(cursors), m_i(i) { }
+
+            //! The I-th column value of the row.
+            template<size_t I>
+            auto get() const -> decltype(std::get<I>(std::declval<std::tuple<Cursors...> const &>())[0])
+            {
+                return std::get<I>(m_cursors)[m_i];
+            }
+
+        private:
+            std::tuple<Cursors...> const & m_cursors;
+            std::size_t                    m_i;
+    };
+
+    //! The row view type of a joint iterator (for the parameters of the functions), e.g.,
+    //!
+    //!     typedef joint::row_of<decltype(begin)>::type row;
+    //!     joint::for_each_row(begin, end, [](row r) { r.get<1>() = 2 * r.get<0>(); });
+    template<typename Iterator>
+    struct row_of;
+
+    template<typename... Iterators>
+    struct row_of<iterator<Iterators...>>
+    {
+        typedef row_view<decltype(detail::column_cursor(std::declval<Iterators>()))...> type;
+    };
+
+    namespace detail
+    {
+
+        //! Execute `f(c, b, cursors, n)` for each chunk `c` of the range (of `n` rows from the row `b`).
+        template<typename Policy, typename... Iterators, typename F>
+        void for_each_row_chunk(Policy const & policy, iterator<Iterators...> first, std::size_t n, F f)
+        {
+            std::size_t const chunks = chunk_count(policy, n);
+            for_each_chunk(policy, chunks, [&](std::size_t c)
+            {
+                std::size_t const b = chunk_begin(c, chunks, n), e = chunk_begin(c + 1, chunks, n);
+                if (b == e) return;
+
+                iterator<Iterators...> it = first;
+                it += b;
+                auto const cursors = make_cursors(it.iterators());
+                f(c, b, cursors, e - b);
+            });
+        }
+
+    }
+
+    //! Call `f(row)` for each row of the range (see `row_view`).
+    //!
+    //! The range is split into chunks executed as separate tasks according to the policy, hence `f` must be safe
+    //! to call concurrently for different rows. The algorithms here are not named after the standard ones, so that
+    //! the unqualified `for_each()`, `transform()`, ... on joint ranges still call the standard algorithms.
+    template<typename Policy, typename... Iterators, typename F>
+    void for_each_row(Policy const & policy, iterator<Iterators...> first, iterator<Iterators...> last, F f)
+    {
+        typedef typename row_of<iterator<Iterators...>>::type   row;
+        typedef typename detail::cursors_of<Iterators...>::type cursors;
+
+        detail::for_each_row_chunk(policy, first, last - first,
+                                   [&](std::size_t, std::size_t, cursors const & columns, std::size_t n)
+                                   {
+                                       for (std::size_t i = 0; i < n; ++i) f(row(columns, i));
+                                   });
+    }
+
+    //! Call `f(row)` for each row of the range in parallel (see above).
+    template<typename... Iterators, typename F>
+    void for_each_row(iterator<Iterators...> first, iterator<Iterators...> last, F f)
+    {
+        joint::for_each_row(par, first, last, f);
+    }
+
+    //! Store `f(row)` for each row of the range to the output range (of random access).
+    template<typename Policy, typename... Iterators, typename OutputIterator, typename F>
+    OutputIterator transform_rows(Policy const & policy, iterator<Iterators...> first, iterator<Iterators...> last,
+                                  OutputIterator output, F f)
+    {
+        typedef typename row_of<iterator<Iterators...>>::type   row;
+        typedef typename detail::cursors_of<Iterators...>::type cursors;
+
+        std::size_t const n = last - first;
+        detail::for_each_row_chunk(policy, first, n,
+                                   [&](std::size_t, std::size_t b, cursors const & columns, std::size_t m)
+                                   {
+                                       auto out = detail::column_cursor(output + b);
+                                       for (std::size_t i = 0; i < m; ++i) out[i] = f(row(columns, i));
+                                   });
+        return output + n;
+    }
+
+    //! Store `f(row)` for each row of the range to the output range in parallel (see above).
+    template<typename... Iterators, typename OutputIterator, typename F>
+    OutputIterator transform_rows(iterator<Iterators...> first, iterator<Iterators...> last, OutputIterator output, F f)
+    {
+        return joint::transform_rows(par, first, last, output, f);
+    }
+
+    //! Reduce `transform(row)` of the rows of the range by `reduce` starting from `init`.
+    //!
+    //! Each chunk of the range is reduced separately and the results of the chunks are reduced in their order
+    //! afterwards, hence `reduce` must be associative (the result does not depend on the number of threads only
+    //! if it is commutative as well).
+    template<typename Policy, typename... Iterators, typename T, typename Reduce, typename Transform>
+    T transform_reduce_rows(Policy const & policy, iterator<Iterators...> first, iterator<Iterators...> last,
+                            T init, Reduce reduce, Transform transform)
+    {
+        typedef typename row_of<iterator<Iterators...>>::type   row;
+        typedef typename detail::cursors_of<Iterators...>::type cursors;
+
+        std::size_t const n      = last - first;
+        std::size_t const chunks = detail::chunk_count(policy, n);
+
+        std::vector<T>             partials(chunks, init);
+        std::vector<unsigned char> done(chunks, 0);
+        detail::for_each_row_chunk(policy, first, n,
+                                   [&](std::size_t c, std::size_t, cursors const & columns, std::size_t m)
+                                   {
+                                       T value = transform(row(columns, 0));
+                                       for (std::size_t i = 1; i < m; ++i)
+                                           value = reduce(value, transform(row(columns, i)));
+                                       partials[c] = std::move(value);
+                                       done[c]     = 1;
+                                   });
+
+        for (std::size_t c = 0; c < chunks; ++c)
+            if (done[c]) init = reduce(init, partials[c]);
+        return init;
+    }
+
+    //! Reduce `transform(row)` of the rows of the range in parallel (see above).
+    template<typename... Iterators, typename T, typename Reduce, typename Transform>
+    T transform_reduce_rows(iterator<Iterators...> first, iterator<Iterators...> last, T init, Reduce reduce,
+                            Transform transform)
+    {
+        return joint::transform_reduce_rows(par, first, last, init, reduce, transform);
+    }
+
+} // namespace joint
+
+#endif //JOINT_TRANSFORM_HPP
@@ -8,6 +8,7 @@
 #include <sstream>
 #include <random>
 #include <algorithm>
+#include <memory>
 
 #include "joint_iterator.hpp"
 
@@ -158,3 +159,34 @@ TEST_F(TestAlgorithm, PartialSort)
 
     EXPECT_TRUE(std::is_sorted(vector.begin(), vector.end()));
 }
+
+TEST(TestAlgorithmMoveOnly, Sort)
+{
+    // Neither default constructible nor copyable column.
+    struct key
+    {
+        explicit key(int v) : value(v) { }
+        int value;
+    };
+
+    std::vector<key>                  keys;
+    std::vector<std::unique_ptr<int>> values;
+    for (int i = 0; i < 128; ++i)
+    {
+        keys.push_back(key((i * 37) % 128));
+        values.emplace_back(new int((i * 37) % 128));
+    }
+
+    auto first = joint::make_joint(keys.begin(), values.begin());
+    auto last  = joint::make_joint(keys.end(), values.end());
+    typedef decltype(first)::reference reference;
+
+    std::sort(first, last, [](reference const & a, reference const & b) { return a.get<0>().value < b.get<0>().value; });
+
+    for (int i = 0; i < 128; ++i)
+    {
+        EXPECT_EQ(i, keys[i].value);
+        ASSERT_TRUE(values[i] != nullptr);
+        EXPECT_EQ(i, * values[i]);
+    }
+}
@@ -0,0 +1,161 @@
+//
+// Tests of the concurrent appending of rows.
+//
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "joint_concurrent.hpp"
+#include "joint_sort.hpp"
+
+namespace
+{
+
+    // An element counting the live instances, the construction throws once the limit is reached.
+    struct Tracked
+    {
+        static std::atomic<long> live;
+        static std::atomic<long> limit;
+
+        Tracked()
+        {
+            if (limit-- <= 0) throw std::runtime_error("limit");
+            ++live;
+        }
+
+        ~Tracked() { --live; }
+    };
+
+    std::atomic<long> Tracked::live(0);
+    std::atomic<long> Tracked::limit(0);
+
+    // Upstream resource counting the live allocations.
+    class CountingResource : public joint::memory_resource
+    {
+        public:
+            long live = 0;
+
+        private:
+            void * do_allocate(size_t bytes, size_t alignment) override
+            {
+                ++live;
+                return joint::new_delete_resource()->allocate(bytes, alignment);
+            }
+
+            void do_deallocate(void * p, size_t bytes, size_t alignment) override
+            {
+                --live;
+                joint::new_delete_resource()->deallocate(p, bytes, alignment);
+            }
+    };
+
+}
+
+TEST(TestConcurrent, Producers)
+{
+    unsigned const producers = 8;
+    long const     rows      = 20000;
+
+    joint::concurrent_columns<long, int, std::string> columns(producers * rows);
+    EXPECT_EQ(producers * rows, columns.capacity());
+
+    std::vector<std::thread> threads;
+    for (unsigned p = 0; p < producers; ++p)
+        threads.emplace_back([&columns, p, rows]()
+        {
+            for (long i = 0; i < rows; i += 100)
+            {
+                // Single rows and batches of rows interleaved.
+                if (i % 200 == 0)
+                {
+                    for (long j = i; j < i + 100; ++j)
+                        columns.push_back(j * producers + p, static_cast<int>(p), std::to_string(j));
+                }
+                else
+                {
+                    std::size_t const first = columns.claim(100);
+                    for (long j = 0; j < 100; ++j)
+                    {
+                        columns.data<0>()[first + j]      = (i + j) * producers + p;
+                        columns.data<1>()[first + j]      = static_cast<int>(p);
+                        columns.at(first + j).get<2>()[0] = std::to_string(i + j);
+                    }
+                }
+            }
+        });
+    for (auto & thread : threads) thread.join();
+
+    EXPECT_EQ(producers * rows, columns.seal());
+    EXPECT_TRUE(columns.sealed());
+
+    joint::sort(columns.begin(), columns.end());
+    for (std::size_t i = 0; i < columns.size(); ++i)
+    {
+        ASSERT_EQ(static_cast<long>(i), columns.data<0>()[i]);
+        EXPECT_EQ(static_cast<int>(i % producers), columns.data<1>()[i]);
+        EXPECT_EQ(std::to_string(i / producers), columns.data<2>()[i]);
+    }
+}
+
+TEST(TestConcurrent, Capacity)
+{
+    std::vector<long> a = {1, 2, 3, 4, 5}, b = {5, 4, 3, 2, 1};
+
+    joint::concurrent_columns<long, long> columns(joint::seq, 12);
+    EXPECT_EQ(0u, columns.append(joint::make_joint(a.begin(), b.begin()), joint::make_joint(a.end(), b.end())));
+    EXPECT_EQ(5u, columns.push_back(6, 0));
+    EXPECT_EQ(columns.npos, columns.claim(7));
+    EXPECT_EQ(columns.npos, columns.push_back(7, 0));
+
+    // The rows of the claims not fitting are not counted.
+    ASSERT_EQ(6u, columns.seal());
+    std::vector<long> keys(columns.data<0>(), columns.data<0>() + columns.size());
+    EXPECT_EQ(std::vector<long>({1, 2, 3, 4, 5, 6}), keys);
+
+    auto const & sealed = columns;
+    EXPECT_EQ(6, sealed.end() - sealed.begin());
+    EXPECT_EQ(5, sealed.begin().get<1>()[0]);
+}
+
+TEST(TestConcurrent, ThrowingConstructor)
+{
+    std::size_t const capacity = 500000;
+
+    // The construction fails early, late and not at all.
+    for (long limit : {100000L, 700000L, 2000000L})
+    {
+        CountingResource resource;
+        Tracked::limit = limit;
+        try
+        {
+            joint::concurrent_columns<Tracked, std::string, Tracked> columns(joint::par, capacity, & resource);
+            EXPECT_EQ(2 * static_cast<long>(capacity), Tracked::live.load());
+        }
+        catch (std::runtime_error const &)
+        {
+            EXPECT_LT(limit, 2 * static_cast<long>(capacity));
+        }
+        EXPECT_EQ(0, Tracked::live.load());
+        EXPECT_EQ(0, resource.live);
+
+        Tracked::limit = limit;
+        EXPECT_EQ(limit < static_cast<long>(capacity), [&]() -> bool
+        {
+            try
+            {
+                joint::concurrent_columns<Tracked> columns(joint::seq, capacity, & resource);
+                return false;
+            }
+            catch (std::runtime_error const &)
+            {
+                return true;
+            }
+        }());
+        EXPECT_EQ(0, Tracked::live.load());
+        EXPECT_EQ(0, resource.live);
+    }
+}
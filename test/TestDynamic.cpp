@@ -0,0 +1,183 @@
+//
+// Tests of the joint ranges of columns with runtime types.
+//
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "joint_dynamic.hpp"
+
+class TestDynamic : public ::testing::Test
+{
+    protected:
+        // An entry of an odd size (moved by memcpy of 3 bytes).
+        struct rgb
+        {
+            unsigned char r, g, b;
+        };
+
+        static size_t const size = 10000;
+
+        joint::dynamic_columns table;
+        std::vector<int>       keys;
+
+        virtual void SetUp()
+        {
+            table.add_column<int>();
+            table.add_column<std::string>();
+            table.add_column<double>();
+            table.add_column<rgb>();
+
+            std::default_random_engine         generator(0);
+            std::uniform_int_distribution<int> distribution(0, 1000);
+
+            for (size_t i = 0; i < size; ++i)
+            {
+                int key = distribution(generator);
+                keys.push_back(key);
+                table.column(0).push_back(key);
+                table.column(1).push_back(std::to_string(key));
+                table.column(2).push_back(key * 0.5);
+                table.column(3).push_back(rgb{static_cast<unsigned char>(key), 0,
+                                              static_cast<unsigned char>(key >> 8)});
+            }
+        }
+
+        // Rows are consistent if all the columns still belong to the key.
+        bool consistent(joint::dynamic_columns & t)
+        {
+            for (size_t i = 0; i < t.size(); ++i)
+            {
+                int key = t[i].get<int>(0);
+                if (t[i].get<std::string>(1) != std::to_string(key)) return false;
+                if (t[i].get<double>(2) != key * 0.5) return false;
+                if (t[i].get<rgb>(3).r != static_cast<unsigned char>(key)) return false;
+                if (t[i].get<rgb>(3).b != static_cast<unsigned char>(key >> 8)) return false;
+            }
+            return true;
+        }
+};
+
+TEST_F(TestDynamic, SortBy)
+{
+    joint::sort_by(table.begin(), table.end(), 0);
+
+    std::sort(keys.begin(), keys.end());
+    EXPECT_TRUE(std::equal(keys.begin(), keys.end(), table.column(0).data<int>()));
+    EXPECT_TRUE(consistent(table));
+}
+
+TEST_F(TestDynamic, SortByComparator)
+{
+    joint::sort_by<std::string>(table.begin() + 100, table.end(), 1, std::greater<std::string>());
+
+    auto strings = table.column(1).data<std::string>();
+    EXPECT_TRUE(std::is_sorted(strings + 100, strings + size, std::greater<std::string>()));
+    EXPECT_EQ(keys[0], table[0].get<int>(0));
+    EXPECT_TRUE(consistent(table));
+}
+
+TEST_F(TestDynamic, PermuteAndGather)
+{
+    std::vector<size_t> permutation(size);
+    for (size_t i = 0; i < size; ++i) permutation[i] = size - 1 - i;
+
+    joint::permute(table.begin(), table.end(), permutation.begin());
+    for (size_t i = 0; i < size; ++i) EXPECT_EQ(keys[size - 1 - i], table[i].get<int>(0));
+    EXPECT_TRUE(consistent(table));
+
+    std::vector<size_t>    indices = {5, 0, 5, 42};
+    joint::dynamic_columns output;
+    joint::gather(table.begin(), indices.begin(), indices.size(), output);
+
+    ASSERT_EQ(4u, output.size());
+    ASSERT_EQ(table.types(), output.types());
+    for (size_t k = 0; k < indices.size(); ++k) EXPECT_EQ(table[indices[k]].get<int>(0), output[k].get<int>(0));
+    EXPECT_TRUE(consistent(output));
+}
+
+namespace
+{
+
+    // An entry counting the live instances, whose moves throw once the limit of the moves is reached.
+    struct ThrowingMove
+    {
+        static long live;
+        static long moves;
+
+        explicit ThrowingMove(int v) : value(v) { ++live; }
+        ThrowingMove(ThrowingMove const & other) : value(other.value) { ++live; }
+        ThrowingMove(ThrowingMove && other) : value(other.value)
+        {
+            if (moves-- == 0) throw std::runtime_error("move");
+            ++live;
+        }
+        ThrowingMove & operator=(ThrowingMove const &) = default;
+        ThrowingMove & operator=(ThrowingMove &&) = default;
+        ~ThrowingMove() { --live; }
+
+        int value;
+    };
+
+    long ThrowingMove::live  = 0;
+    long ThrowingMove::moves = -1;
+
+    // Upstream resource counting the live allocations.
+    class CountingResource : public joint::memory_resource
+    {
+        public:
+            long live = 0;
+
+        private:
+            void * do_allocate(size_t bytes, size_t alignment) override
+            {
+                ++live;
+                return joint::new_delete_resource()->allocate(bytes, alignment);
+            }
+
+            void do_deallocate(void * p, size_t bytes, size_t alignment) override
+            {
+                --live;
+                joint::new_delete_resource()->deallocate(p, bytes, alignment);
+            }
+    };
+
+}
+
+TEST_F(TestDynamic, ThrowingMove)
+{
+    CountingResource resource;
+    {
+        joint::dynamic_columns table(& resource);
+        table.add_column<ThrowingMove>();
+        for (int i = 0; i < 16; ++i) table.column(0).push_back(ThrowingMove(i));
+        EXPECT_EQ(16, ThrowingMove::live);
+
+        // The storage grows and a move fails: the column keeps its entries and its storage.
+        ThrowingMove::moves = 5;
+        EXPECT_THROW(table.column(0).push_back(ThrowingMove(16)), std::runtime_error);
+        ThrowingMove::moves = -1;
+        EXPECT_EQ(16u, table.size());
+        EXPECT_EQ(16, ThrowingMove::live);
+        EXPECT_EQ(1, resource.live);
+
+        // The permutation fails while filling its buffer: the buffered entries and the buffer are released.
+        std::vector<size_t> permutation(16);
+        for (size_t i = 0; i < 16; ++i) permutation[i] = 15 - i;
+        ThrowingMove::moves = 10;
+        EXPECT_THROW(joint::permute(table.begin(), table.end(), permutation.begin(), & resource), std::runtime_error);
+        ThrowingMove::moves = -1;
+        EXPECT_EQ(16, ThrowingMove::live);
+        EXPECT_EQ(1, resource.live);
+
+        joint::permute(table.begin(), table.end(), permutation.begin(), & resource);
+        for (int i = 0; i < 16; ++i) EXPECT_EQ(15 - i, table[i].get<ThrowingMove>(0).value);
+    }
+    EXPECT_EQ(0, ThrowingMove::live);
+    EXPECT_EQ(0, resource.live);
+}
@@ -0,0 +1,134 @@
+//
+// Tests of the huge page backed memory.
+//
+
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "joint_columns.hpp"
+#include "joint_huge_pages.hpp"
+#include "joint_join.hpp"
+#include "joint_permutation.hpp"
+#include "joint_sort.hpp"
+
+TEST(TestHugePages, AllocateAndDeallocate)
+{
+    joint::huge_page_resource resource;
+
+    std::size_t const sizes[] = {1, 4096, (std::size_t(2) << 20) - 1, std::size_t(2) << 20, std::size_t(5) << 20};
+    for (std::size_t bytes : sizes)
+    {
+        auto * p = static_cast<unsigned char *>(resource.allocate(bytes));
+        ASSERT_NE(nullptr, p);
+        EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(p) % alignof(std::max_align_t));
+
+        for (std::size_t i = 0; i < bytes; i += 1000) p[i] = static_cast<unsigned char>(i);
+        p[bytes - 1] = 42;
+        for (std::size_t i = 0; i + 1 < bytes; i += 1000) ASSERT_EQ(static_cast<unsigned char>(i), p[i]);
+        EXPECT_EQ(42, p[bytes - 1]);
+
+#ifdef JOINT_HAS_HUGE_PAGES
+        // The large allocations are mapped whole huge pages, aligned to them.
+        if (bytes >= (std::size_t(2) << 20))
+        {
+            EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(p) % (std::size_t(2) << 20));
+            EXPECT_EQ((bytes + (std::size_t(2) << 20) - 1) / (std::size_t(2) << 20) * (std::size_t(2) << 20),
+                      resource.mapped_bytes());
+        }
+        else
+        {
+            EXPECT_EQ(0u, resource.mapped_bytes());
+        }
+#endif
+
+        resource.deallocate(p, bytes);
+        EXPECT_EQ(0u, resource.mapped_bytes());
+    }
+}
+
+TEST(TestHugePages, Prefault)
+{
+    joint::huge_page_resource sequential(joint::seq), parallel(joint::par);
+
+    for (joint::memory_resource * resource : {static_cast<joint::memory_resource *>(& sequential),
+                                              static_cast<joint::memory_resource *>(& parallel)})
+    {
+        std::size_t const bytes = std::size_t(9) << 20;
+        auto * p = static_cast<std::uint64_t *>(resource->allocate(bytes, alignof(std::uint64_t)));
+
+        // The prefaulted memory of a fresh mapping reads as zeros.
+        for (std::size_t i = 0; i < bytes / sizeof(std::uint64_t); i += 509) ASSERT_EQ(0u, p[i]);
+
+        resource->deallocate(p, bytes, alignof(std::uint64_t));
+    }
+}
+
+#if defined(__GLIBCXX__) || defined(_LIBCPP_VERSION)
+// The columns in the huge pages take the raw pointer paths of the algorithms (e.g., the bytewise relocation).
+typedef joint::resource_columns<int, std::string>::vectors_type       resource_vectors;
+typedef std::tuple_element<1, resource_vectors>::type                resource_vector;
+typedef std::vector<bool, joint::scratch_allocator<bool>>::iterator  resource_bit_iterator;
+
+static_assert(joint::detail::is_contiguous_iterator<resource_vector::iterator>::value, "Contiguous columns.");
+static_assert(joint::detail::is_contiguous_iterator<resource_vector::const_iterator>::value, "Contiguous columns.");
+static_assert(!joint::detail::is_contiguous_iterator<resource_bit_iterator>::value, "Packed bits.");
+#endif
+
+TEST(TestHugePages, ResourceColumns)
+{
+    joint::huge_page_resource resource(joint::par);
+
+    std::size_t const                   n = 1000000;
+    joint::resource_columns<int, long>  data(n, & resource);
+    std::default_random_engine          generator(0);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        data.get<0>()[i] = static_cast<int>(generator() % 1000000);
+        data.get<1>()[i] = data.get<0>()[i] * 3L;
+    }
+    EXPECT_GT(resource.mapped_bytes(), n * (sizeof(int) + sizeof(long)) - 1);
+
+    joint::sort(data.begin(), data.end(), joint::less(), & resource);
+
+    EXPECT_TRUE(std::is_sorted(data.get<0>().begin(), data.get<0>().end()));
+    for (std::size_t i = 0; i < n; ++i) ASSERT_EQ(data.get<0>()[i] * 3L, data.get<1>()[i]);
+
+    // Reverse the rows by a permutation gathered through the huge pages.
+    std::vector<std::size_t> permutation(n);
+    for (std::size_t i = 0; i < n; ++i) permutation[i] = n - 1 - i;
+    joint::permute(data.begin(), data.end(), permutation.begin(), & resource);
+    EXPECT_TRUE(std::is_sorted(data.get<0>().rbegin(), data.get<0>().rend()));
+
+    // The outputs of the joins and filters may be resource columns as well.
+    joint::resource_columns<int, long, int, long> joined(& resource);
+    std::size_t matches = joint::hash_join<0, 0>(data.begin(), data.begin() + 1000, data.begin(), data.begin() + 1000,
+                                                 joined, & resource);
+    EXPECT_LE(1000u, matches);
+    EXPECT_EQ(matches, joined.size());
+    for (std::size_t i = 0; i < matches; ++i) ASSERT_EQ(joined.get<0>()[i], joined.get<2>()[i]);
+}
+
+TEST(TestHugePages, DefaultResource)
+{
+    joint::huge_page_resource resource;
+
+    joint::memory_resource * previous = joint::set_default_resource(& resource);
+    EXPECT_EQ(joint::new_delete_resource(), previous);
+    EXPECT_EQ(& resource, joint::default_resource());
+
+    {
+        joint::scratch_vector<long> scratch(1000000, 7);
+        EXPECT_EQ(7, scratch.back());
+#ifdef JOINT_HAS_HUGE_PAGES
+        EXPECT_LT(0u, resource.mapped_bytes());
+#endif
+    }
+    EXPECT_EQ(0u, resource.mapped_bytes());
+
+    EXPECT_EQ(& resource, joint::set_default_resource(nullptr));
+    EXPECT_EQ(joint::new_delete_resource(), joint::default_resource());
+}
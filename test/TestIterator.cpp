@@ -3,6 +3,7 @@
 //
 
 #include <gtest/gtest.h>
+#include <memory>
 #include <vector>
 #include <string>
 
@@ -110,3 +111,29 @@ TEST_F(TestIterator, Wrappers)
     EXPECT_EQ(10, r1.get<1>());
     EXPECT_EQ(10, *begin.get<1>());
 }
+
+TEST_F(TestIterator, NoexceptAndRelocatable)
+{
+    typedef joint::iterator<std::vector<int>::iterator, std::vector<std::unique_ptr<int>>::iterator> unique_iterator;
+
+    static_assert(std::is_nothrow_move_constructible<value_type>::value, "Values must be moved without throwing.");
+    static_assert(std::is_nothrow_move_assignable<value_type>::value, "Values must be moved without throwing.");
+    static_assert(noexcept(swap(std::declval<reference>(), std::declval<reference>())),
+                  "Rows must be swapped without throwing.");
+    static_assert(std::is_nothrow_constructible<unique_iterator::value_type, unique_iterator::reference &&>::value,
+                  "Move-only values must be taken from references without throwing.");
+
+    static_assert(joint::is_trivially_relocatable<joint::iterator<int *, double *>::value_type>::value,
+                  "Trivially copyable values are relocatable.");
+    static_assert(joint::is_trivially_relocatable<unique_iterator::value_type>::value,
+                  "Unique pointers are relocatable.");
+    static_assert(!joint::is_trivially_relocatable<value_type>::value, "Strings are not known to be relocatable.");
+
+    // The growth of a vector of values moves them (the strings would be copied if the move could throw).
+    std::vector<value_type> values;
+    for (int i = 0; i < 10; ++i) values.push_back(std::make_tuple(std::string(100, 'a' + i), i));
+    char const * data = values[0].get<0>().c_str();
+    values.reserve(4 * values.capacity());
+    EXPECT_EQ(data, values[0].get<0>().c_str());
+    EXPECT_EQ(std::string(100, 'j'), values[9].get<0>());
+}
@@ -0,0 +1,149 @@
+//
+// Tests of the joins of joint ranges.
+//
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "joint_join.hpp"
+
+class TestJoin : public ::testing::Test
+{
+    protected:
+        typedef joint::columns<int, std::string> left_columns;
+        typedef joint::columns<long, int>        right_columns;
+
+        left_columns  left;
+        right_columns right;
+
+        void fill(std::size_t n_left, std::size_t n_right, int keys)
+        {
+            std::default_random_engine         generator(0);
+            std::uniform_int_distribution<int> distribution(0, keys);
+
+            for (std::size_t i = 0; i < n_left; ++i)
+            {
+                int key = distribution(generator);
+                left.emplace_back(key, std::to_string(key));
+            }
+            for (std::size_t i = 0; i < n_right; ++i)
+            {
+                int key = distribution(generator);
+                right.emplace_back(static_cast<long>(i), key);
+            }
+        }
+
+        // All the matching pairs of the left and right row indices (sorted).
+        std::vector<std::pair<std::size_t, std::size_t>> expected()
+        {
+            std::multimap<int, std::size_t> index;
+            for (std::size_t i = 0; i < left.size(); ++i) index.emplace(left.get<0>()[i], i);
+
+            std::vector<std::pair<std::size_t, std::size_t>> pairs;
+            for (std::size_t j = 0; j < right.size(); ++j)
+            {
+                auto range = index.equal_range(right.get<1>()[j]);
+                for (auto it = range.first; it != range.second; ++it) pairs.emplace_back(it->second, j);
+            }
+            std::sort(pairs.begin(), pairs.end());
+            return pairs;
+        }
+
+        template<typename Policy>
+        std::vector<std::pair<std::size_t, std::size_t>> join(Policy const & policy)
+        {
+            joint::columns<std::size_t, std::size_t> output;
+            std::size_t n = joint::hash_join_indices<0, 1>(policy, left.begin(), left.end(),
+                                                           right.begin(), right.end(), output);
+            EXPECT_EQ(n, output.size());
+
+            std::vector<std::pair<std::size_t, std::size_t>> pairs;
+            for (std::size_t i = 0; i < output.size(); ++i)
+                pairs.emplace_back(output.get<0>()[i], output.get<1>()[i]);
+            std::sort(pairs.begin(), pairs.end());
+            return pairs;
+        }
+};
+
+TEST_F(TestJoin, IndicesSequential)
+{
+    fill(1000, 3000, 500);
+    EXPECT_EQ(expected(), join(joint::seq));
+}
+
+TEST_F(TestJoin, IndicesParallel)
+{
+    // Large enough to be partitioned, the left side is the probe side.
+    fill(200000, 50000, 100000);
+    EXPECT_EQ(expected(), join(joint::par));
+}
+
+TEST_F(TestJoin, Gather)
+{
+    fill(5000, 20000, 10000);
+
+    joint::columns<int, std::string, long, int> output;
+    std::size_t n = joint::hash_join<0, 1>(left.begin(), left.end(), right.begin(), right.end(), output);
+
+    EXPECT_EQ(expected().size(), n);
+    ASSERT_EQ(n, output.size());
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        EXPECT_EQ(output.get<0>()[i], output.get<3>()[i]);
+        EXPECT_EQ(std::to_string(output.get<0>()[i]), output.get<1>()[i]);
+        EXPECT_EQ(output.get<3>()[i], right.get<1>()[output.get<2>()[i]]);
+    }
+}
+
+TEST_F(TestJoin, HeavyDuplicates)
+{
+    // Almost all the build rows share a key (a single slot with a chain, not a long probe sequence).
+    for (std::size_t i = 0; i < 80000; ++i)
+    {
+        int key = i % 1000 == 0 ? static_cast<int>(i) : 7;
+        left.emplace_back(key, std::to_string(key));
+    }
+    for (std::size_t j = 0; j < 100000; ++j) right.emplace_back(static_cast<long>(j), static_cast<int>(j));
+
+    auto pairs = join(joint::par);
+    EXPECT_EQ(expected(), pairs);
+    EXPECT_EQ(80000u, pairs.size());
+}
+
+TEST_F(TestJoin, Empty)
+{
+    fill(0, 100, 10);
+    EXPECT_TRUE(join(joint::par).empty());
+}
+
+TEST(TestMergeJoin, Run)
+{
+    joint::columns<int, std::string> left(std::vector<int>{1, 2, 2, 3, 5, 7, 7, 9},
+                                          std::vector<std::string>{"a", "b", "c", "d", "e", "f", "g", "h"});
+    joint::columns<long, int>        right(std::vector<long>{10, 20, 21, 22, 40, 70, 80},
+                                           std::vector<int>{1, 2, 2, 2, 4, 7, 8});
+
+    joint::columns<std::size_t, std::size_t> indices;
+    std::size_t n = joint::merge_join_indices<0, 1>(left.begin(), left.end(), right.begin(), right.end(), indices);
+    EXPECT_EQ(9u, n);
+
+    std::vector<std::size_t> left_rows  = {0, 1, 1, 1, 2, 2, 2, 5, 6};
+    std::vector<std::size_t> right_rows = {0, 1, 2, 3, 1, 2, 3, 5, 5};
+    EXPECT_EQ(left_rows, indices.get<0>());
+    EXPECT_EQ(right_rows, indices.get<1>());
+
+    joint::columns<int, std::string, long, int> output;
+    n = joint::merge_join<0, 1>(left.begin(), left.end(), right.begin(), right.end(), output);
+    EXPECT_EQ(9u, n);
+    for (std::size_t i = 0; i < output.size(); ++i)
+    {
+        EXPECT_EQ(left.get<1>()[left_rows[i]], output.get<1>()[i]);
+        EXPECT_EQ(right.get<0>()[right_rows[i]], output.get<2>()[i]);
+        EXPECT_EQ(output.get<0>()[i], output.get<3>()[i]);
+    }
+}
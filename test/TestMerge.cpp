@@ -0,0 +1,149 @@
+//
+// Tests of the merging of joint ranges.
+//
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+
+#include "joint_merge.hpp"
+#include "joint_columns.hpp"
+
+class TestMerge : public ::testing::Test
+{
+    protected:
+        typedef joint::columns<int, std::string> columns;
+
+        // Create two sorted runs of the given sizes; the strings record the original positions.
+        columns createRuns(size_t size1, size_t size2)
+        {
+            std::default_random_engine         generator(0);
+            std::uniform_int_distribution<int> distribution(0, 64);
+
+            columns data;
+            for (size_t i = 0; i < size1 + size2; ++i) data.emplace_back(distribution(generator), "");
+
+            std::sort(data.get<0>().begin(), data.get<0>().begin() + size1);
+            std::sort(data.get<0>().begin() + size1, data.get<0>().end());
+            for (size_t i = 0; i < data.size(); ++i) data.get<1>()[i] = std::to_string(i);
+
+            return data;
+        }
+
+        // Check that the merge is sorted and stable.
+        void checkMerged(columns const & merged, columns const & original)
+        {
+            std::vector<std::pair<int, int>> expected;
+            for (size_t i = 0; i < original.size(); ++i)
+                expected.push_back(std::make_pair(original.get<0>()[i], static_cast<int>(i)));
+            std::stable_sort(expected.begin(), expected.end(),
+                             [](std::pair<int, int> const & a, std::pair<int, int> const & b)
+                             { return a.first < b.first; });
+
+            ASSERT_EQ(expected.size(), merged.size());
+            for (size_t i = 0; i < merged.size(); ++i)
+            {
+                EXPECT_EQ(expected[i].first, merged.get<0>()[i]);
+                EXPECT_EQ(std::to_string(expected[i].second), merged.get<1>()[i]);
+            }
+        }
+};
+
+TEST_F(TestMerge, InplaceMerge)
+{
+    for (size_t size1 : {0, 1, 10, 100, 333})
+    {
+        for (size_t size2 : {0, 1, 10, 100, 333})
+        {
+            auto original = createRuns(size1, size2);
+            auto data     = original;
+
+            joint::inplace_merge(data.begin(), data.begin() + size1, data.end());
+
+            checkMerged(data, original);
+        }
+    }
+}
+
+TEST_F(TestMerge, InplaceMergeRelocatable)
+{
+    for (size_t size1 : {1, 100, 333})
+    {
+        for (size_t size2 : {1, 100, 333})
+        {
+            auto original = createRuns(size1, size2);
+
+            // The unique pointers are relocated bytewise by the merge.
+            std::vector<int>                  keys(original.get<0>());
+            std::vector<std::unique_ptr<int>> pointers;
+            for (size_t i = 0; i < keys.size(); ++i) pointers.emplace_back(new int(static_cast<int>(i)));
+
+            auto begin = joint::make_joint(keys.begin(), pointers.begin());
+            joint::inplace_merge(begin, begin + size1, joint::make_joint(keys.end(), pointers.end()));
+
+            EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+            for (size_t i = 0; i < keys.size(); ++i)
+            {
+                ASSERT_TRUE(pointers[i] != nullptr);
+                EXPECT_EQ(original.get<0>()[* pointers[i]], keys[i]);
+                if (i > 0 && keys[i - 1] == keys[i])
+                {
+                    EXPECT_LT(* pointers[i - 1], * pointers[i]);
+                }
+            }
+        }
+    }
+}
+
+TEST_F(TestMerge, InplaceMergeWithArena)
+{
+    joint::scratch_arena arena;
+
+    for (int k = 0; k < 4; ++k)
+    {
+        auto original = createRuns(200 + k, 100);
+        auto data     = original;
+
+        joint::inplace_merge(data.begin(), data.begin() + 200 + k, data.end(), joint::less(), & arena);
+
+        checkMerged(data, original);
+    }
+
+    EXPECT_EQ(1u, arena.blocks());
+}
+
+TEST_F(TestMerge, KwayMerge)
+{
+    for (size_t k : {1, 3, 16, 64})
+    {
+        // Consecutive sorted shards of various sizes (some of them empty).
+        std::default_random_engine         generator(k);
+        std::uniform_int_distribution<int> distribution(0, 64);
+        std::uniform_int_distribution<int> sizes(0, 200);
+
+        columns                  original;
+        std::vector<std::size_t> offsets(1, 0);
+        for (size_t r = 0; r < k; ++r)
+        {
+            size_t size = r % 5 == 4 ? 0 : sizes(generator);
+            for (size_t i = 0; i < size; ++i) original.emplace_back(distribution(generator), "");
+            std::sort(original.get<0>().begin() + offsets.back(), original.get<0>().end());
+            offsets.push_back(original.size());
+        }
+        for (size_t i = 0; i < original.size(); ++i) original.get<1>()[i] = std::to_string(i);
+
+        auto data = original;
+        std::vector<std::pair<columns::iterator, columns::iterator>> ranges;
+        for (size_t r = 0; r < k; ++r) ranges.emplace_back(data.begin() + offsets[r], data.begin() + offsets[r + 1]);
+
+        columns merged(data.size());
+        auto    end = joint::kway_merge(ranges.begin(), ranges.end(), merged.begin());
+
+        EXPECT_TRUE(end == merged.end());
+        checkMerged(merged, original);
+    }
+}
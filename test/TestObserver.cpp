@@ -0,0 +1,132 @@
+//
+// Tests of the observers of the phases of the algorithms.
+//
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "joint_observer.hpp"
+#include "joint_sort.hpp"
+
+namespace
+{
+
+    std::vector<joint::phase> phases(joint::phase_recorder const & recorder)
+    {
+        std::vector<joint::phase> result;
+        for (auto & report : recorder.reports()) result.push_back(report.phase);
+        return result;
+    }
+
+}
+
+TEST(TestObserver, SortPhases)
+{
+    std::vector<std::string> keys;
+    std::vector<int>         values;
+    for (int i = 0; i < 1000; ++i)
+    {
+        keys.push_back(std::to_string((i * 7919) % 1000));
+        values.push_back(i);
+    }
+
+    joint::phase_recorder recorder;
+    {
+        joint::observe_scope scope(recorder);
+        joint::sort(joint::make_joint(keys.begin(), values.begin()), joint::make_joint(keys.end(), values.end()));
+    }
+
+    std::vector<joint::phase> expected = {joint::phase::key_extraction, joint::phase::sort,
+                                          joint::phase::permutation};
+    EXPECT_EQ(expected, phases(recorder));
+    for (auto & report : recorder.reports())
+    {
+        EXPECT_EQ(1000u, report.elements);
+        EXPECT_LE(0.0, report.seconds);
+        EXPECT_FALSE(report.has_counters);
+    }
+    EXPECT_EQ(1000 * (sizeof(std::string) + sizeof(int)), recorder.reports().back().bytes);
+
+    // Nothing is reported out of the scope.
+    recorder.clear();
+    joint::stable_sort(joint::make_joint(values.begin(), keys.begin()), joint::make_joint(values.end(), keys.end()));
+    EXPECT_TRUE(recorder.reports().empty());
+}
+
+TEST(TestObserver, NestedScopes)
+{
+    std::vector<int> a = {3, 1, 2}, b = {1, 2, 3};
+
+    joint::phase_recorder outer, inner;
+    joint::observe_scope  scope(outer);
+    {
+        joint::observe_scope nested(inner);
+        joint::stable_sort(joint::make_joint(a.begin(), b.begin()), joint::make_joint(a.end(), b.end()));
+    }
+    {
+        joint::phase_timer timer(joint::phase::gather, 3, 24);
+    }
+
+    ASSERT_EQ(1u, inner.reports().size());
+    EXPECT_EQ(joint::phase::sort, inner.reports()[0].phase);
+    ASSERT_EQ(1u, outer.reports().size());
+    EXPECT_EQ(joint::phase::gather, outer.reports()[0].phase);
+    EXPECT_EQ(24u, outer.reports()[0].bytes);
+
+    std::ostringstream out;
+    out << outer.reports()[0];
+    EXPECT_EQ(0u, out.str().find("gather: "));
+}
+
+TEST(TestObserver, HardwareCounters)
+{
+    // The counters may not be available (e.g., in a container), the phases are reported anyway.
+    joint::phase_recorder recorder(true);
+    bool const            available = recorder.counters()->available();
+
+    std::vector<int> a(100000), b(100000);
+    for (int i = 0; i < 100000; ++i) a[i] = (i * 7919) % 100000;
+    {
+        joint::observe_scope scope(recorder);
+        joint::stable_sort(joint::make_joint(a.begin(), b.begin()), joint::make_joint(a.end(), b.end()));
+    }
+
+    ASSERT_EQ(1u, recorder.reports().size());
+    EXPECT_EQ(available, recorder.reports()[0].has_counters);
+    if (recorder.counters()->available(joint::hardware_counters::cycles))
+    {
+        EXPECT_LT(0u, recorder.reports()[0].counters.cycles);
+    }
+}
+
+TEST(TestObserver, MultiplexedCounters)
+{
+    joint::counter_values start, end;
+    start.cycles       = 100;
+    start.llc_misses   = 10;
+    start.time_enabled = 1000;
+    start.time_running = 1000;
+    end.cycles         = 1100;
+    end.llc_misses     = 60;
+    end.time_enabled   = 5000;
+    end.time_running   = 3000;
+
+    // The group counted half of the time of the phase, the counts are doubled.
+    joint::counter_values const phase = end.since(start);
+    EXPECT_TRUE(phase.multiplexed());
+    EXPECT_EQ(2000u, phase.cycles);
+    EXPECT_EQ(100u, phase.llc_misses);
+    EXPECT_EQ(0u, phase.branch_misses);
+
+    joint::phase_report report{joint::phase::sort, 0.5, 10, 0, true, phase};
+    std::ostringstream  out;
+    out << report;
+    EXPECT_NE(std::string::npos, out.str().find("scaled from 50% of the time"));
+
+    // A group which did not count at all gives no estimates.
+    end.time_running = 1000;
+    EXPECT_EQ(0u, end.since(start).cycles);
+    EXPECT_FALSE(start.since(start).multiplexed());
+}
@@ -0,0 +1,211 @@
+//
+// Tests of the bit-packed columns.
+//
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "joint_packed.hpp"
+#include "joint_sort.hpp"
+
+namespace
+{
+
+    std::vector<long> random_values(std::size_t n, long base, unsigned bits, unsigned seed)
+    {
+        std::mt19937_64                         random(seed);
+        std::uniform_int_distribution<uint64_t> distribution(0, bits == 0 ? 0 : (~uint64_t(0) >> (64 - bits)));
+
+        std::vector<long> values;
+        for (std::size_t i = 0; i < n; ++i) values.push_back(base + static_cast<long>(distribution(random)));
+        return values;
+    }
+
+}
+
+TEST(TestPacked, EncodeAndGet)
+{
+    for (unsigned bits : {0u, 1u, 20u, 37u, 63u})
+    {
+        std::vector<long> const values = random_values(1000, -12345, bits, bits);
+
+        auto const packed = joint::packed_column<long>::encode(values.begin(), values.end());
+
+        EXPECT_LE(packed.bits(), bits);
+        EXPECT_EQ(values.size(), packed.size());
+        EXPECT_EQ((values.size() * packed.bits() + 63) / 64 * 8, packed.bytes());
+        EXPECT_TRUE(std::equal(values.begin(), values.end(), packed.begin()));
+    }
+}
+
+TEST(TestPacked, FullWidth)
+{
+    std::vector<uint64_t> const values{0, ~uint64_t(0), 12345, uint64_t(1) << 63};
+
+    auto const packed = joint::packed_column<uint64_t>::encode(values.begin(), values.end());
+
+    EXPECT_EQ(64u, packed.bits());
+    EXPECT_TRUE(std::equal(values.begin(), values.end(), packed.begin()));
+}
+
+TEST(TestPacked, SetAndResize)
+{
+    joint::packed_column<int> packed(100, 7);
+    packed.resize(20);
+
+    for (int i = 0; i < 20; ++i) EXPECT_EQ(100, packed[i]);
+
+    for (int i = 0; i < 20; ++i) packed[i] = 100 + 6 * i;
+    for (int i = 0; i < 20; ++i) EXPECT_EQ(100 + 6 * i, packed.get(i));
+
+    EXPECT_TRUE(packed.fits(227));
+    EXPECT_FALSE(packed.fits(228));
+    EXPECT_FALSE(packed.fits(99));
+
+    packed.resize(5);
+    packed.resize(10);
+    for (int i = 0; i < 5; ++i) EXPECT_EQ(100 + 6 * i, packed.get(i));
+    for (int i = 5; i < 10; ++i) EXPECT_EQ(100, packed.get(i));
+
+    swap(packed[0], packed[1]);
+    EXPECT_EQ(106, packed.get(0));
+    EXPECT_EQ(100, packed.get(1));
+}
+
+TEST(TestPacked, NegativeValues)
+{
+    // The default column takes all the values, the negative ones included.
+    joint::packed_column<int> packed;
+    EXPECT_EQ(32u, packed.bits());
+    for (int value : {-1, 0, 1, std::numeric_limits<int>::min(), std::numeric_limits<int>::max()})
+        EXPECT_TRUE(packed.fits(value));
+
+    std::vector<int> const values{-1, 5, std::numeric_limits<int>::min(), 0, -100, std::numeric_limits<int>::max()};
+    for (int value : values) packed.push_back(value);
+    EXPECT_TRUE(std::equal(values.begin(), values.end(), packed.begin()));
+
+    // The codes keep the order of the values.
+    std::vector<int> sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<int> payload(values.size());
+    for (std::size_t i = 0; i < payload.size(); ++i) payload[i] = static_cast<int>(i);
+    joint::sort(joint::make_joint(packed.begin(), payload.begin()), joint::make_joint(packed.end(), payload.end()));
+    EXPECT_TRUE(std::equal(sorted.begin(), sorted.end(), packed.begin()));
+    for (std::size_t i = 0; i < payload.size(); ++i) EXPECT_EQ(packed.get(i), values[payload[i]]);
+    EXPECT_EQ(1, packed.lower_bound(-100) - packed.begin());
+    EXPECT_EQ(3, packed.upper_bound(-1) - packed.begin());
+
+    auto const encoded = joint::packed_column<long>::encode(values.begin(), values.end());
+    EXPECT_TRUE(std::equal(values.begin(), values.end(), encoded.begin()));
+}
+
+TEST(TestPacked, Bounds)
+{
+    std::vector<int> values{5, 7, 7, 7, 9, 12, 12, 40};
+
+    auto const packed = joint::packed_column<int>::encode(values.begin(), values.end());
+
+    for (int value = 0; value < 45; ++value)
+    {
+        EXPECT_EQ(std::lower_bound(values.begin(), values.end(), value) - values.begin(),
+                  packed.lower_bound(value) - packed.begin());
+        EXPECT_EQ(std::upper_bound(values.begin(), values.end(), value) - values.begin(),
+                  packed.upper_bound(value) - packed.begin());
+    }
+}
+
+TEST(TestPacked, SortByPackedKeys)
+{
+    for (unsigned bits : {3u, 20u, 37u})
+    {
+        std::vector<long> const values = random_values(10000, 1000, bits, bits);
+
+        auto packed = joint::packed_column<long>::encode(values.begin(), values.end());
+        std::vector<std::size_t> rows;
+        for (std::size_t i = 0; i < values.size(); ++i) rows.push_back(i);
+
+        joint::sort(joint::make_joint(packed.begin(), rows.begin()), joint::make_joint(packed.end(), rows.end()));
+
+        EXPECT_TRUE(std::is_sorted(packed.begin(), packed.end()));
+        for (std::size_t i = 0; i < rows.size(); ++i)
+        {
+            EXPECT_EQ(values[rows[i]], packed.get(i));
+            if (i > 0 && packed.get(i - 1) == packed.get(i))
+            {
+                EXPECT_LT(rows[i - 1], rows[i]);
+            }
+        }
+    }
+}
+
+TEST(TestPacked, SortPackedPayload)
+{
+    std::vector<int>  keys{5, 3, 9, 1, 3, 0};
+    std::vector<long> values{50, 30, 90, 10, 31, 0};
+
+    auto packed = joint::packed_column<long>::encode(values.begin(), values.end());
+
+    joint::stable_sort(joint::make_joint(keys.begin(), packed.begin()), joint::make_joint(keys.end(), packed.end()));
+
+    EXPECT_EQ((std::vector<int>{0, 1, 3, 3, 5, 9}), keys);
+    EXPECT_EQ((std::vector<long>{0, 10, 30, 31, 50, 90}), std::vector<long>(packed.begin(), packed.end()));
+}
+
+TEST(TestPacked, SortLargePackedPayload)
+{
+    std::vector<long> const values = random_values(5000, 0, 24, 7);
+
+    std::vector<int> keys;
+    for (std::size_t i = 0; i < values.size(); ++i) keys.push_back(static_cast<int>(values[i] % 97));
+
+    auto packed = joint::packed_column<long>::encode(values.begin(), values.end());
+
+    std::vector<int>  expected_keys = keys;
+    std::vector<long> expected      = values;
+    std::stable_sort(joint::make_joint(expected_keys.begin(), expected.begin()),
+                     joint::make_joint(expected_keys.end(), expected.end()));
+
+    joint::stable_sort(joint::make_joint(keys.begin(), packed.begin()), joint::make_joint(keys.end(), packed.end()));
+
+    EXPECT_EQ(expected_keys, keys);
+    EXPECT_EQ(expected, std::vector<long>(packed.begin(), packed.end()));
+}
+
+TEST(TestPacked, SortPackedPayloadUnstable)
+{
+    std::vector<long> const values = random_values(5000, -100, 24, 9);
+
+    // The keys are distinct, so that the unstable sorts give a unique order.
+    std::vector<int> keys;
+    for (std::size_t i = 0; i < values.size(); ++i) keys.push_back(static_cast<int>((i * 7919) % values.size()));
+
+    std::vector<int>  expected_keys = keys;
+    std::vector<long> expected      = values;
+    std::sort(joint::make_joint(expected_keys.begin(), expected.begin()),
+              joint::make_joint(expected_keys.end(), expected.end()));
+
+    {
+        std::vector<int> sorted_keys = keys;
+        auto             packed      = joint::packed_column<long>::encode(values.begin(), values.end());
+
+        joint::sort(joint::make_joint(sorted_keys.begin(), packed.begin()),
+                    joint::make_joint(sorted_keys.end(), packed.end()));
+
+        EXPECT_EQ(expected_keys, sorted_keys);
+        EXPECT_EQ(expected, std::vector<long>(packed.begin(), packed.end()));
+    }
+    {
+        std::vector<int> sorted_keys = keys;
+        auto             packed      = joint::packed_column<long>::encode(values.begin(), values.end());
+
+        std::sort(joint::make_joint(sorted_keys.begin(), packed.begin()),
+                  joint::make_joint(sorted_keys.end(), packed.end()));
+
+        EXPECT_EQ(expected_keys, sorted_keys);
+        EXPECT_EQ(expected, std::vector<long>(packed.begin(), packed.end()));
+    }
+}
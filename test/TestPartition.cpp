@@ -0,0 +1,198 @@
+//
+// Tests of the partitioning and filtering of joint ranges.
+//
+
+#include <gtest/gtest.h>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+
+#include "joint_partition.hpp"
+
+class TestPartition : public ::testing::Test
+{
+    protected:
+        typedef joint::columns<int, std::string> columns;
+
+        static size_t const size = 100000;
+
+        columns data;
+
+        virtual void SetUp()
+        {
+            std::default_random_engine         generator(0);
+            std::uniform_int_distribution<int> distribution(0, 1024);
+
+            data.reserve(size);
+            for (size_t i = 0; i < size; ++i)
+            {
+                int number = distribution(generator);
+                data.emplace_back(number, std::to_string(number) + "/" + std::to_string(i));
+            }
+        }
+
+        static bool isEven(int i) { return i % 2 == 0; }
+
+        // Rows are consistent if the string column still belongs to the number.
+        bool consistent(columns const & c)
+        {
+            for (size_t i = 0; i < c.size(); ++i)
+                if (c.get<1>()[i].substr(0, c.get<1>()[i].find('/')) != std::to_string(c.get<0>()[i])) return false;
+            return true;
+        }
+
+        // Expected result of a stable partition.
+        std::vector<std::string> stablePartitioned()
+        {
+            std::vector<std::string> expected;
+            for (size_t i = 0; i < size; ++i) if (isEven(data.get<0>()[i])) expected.push_back(data.get<1>()[i]);
+            for (size_t i = 0; i < size; ++i) if (!isEven(data.get<0>()[i])) expected.push_back(data.get<1>()[i]);
+            return expected;
+        }
+};
+
+TEST_F(TestPartition, PartitionBy)
+{
+    auto count = std::count_if(data.get<0>().begin(), data.get<0>().end(), isEven);
+
+    joint::thread_pool pool(4);
+    auto middle = joint::partition_by<0>(joint::parallel_policy(&pool), data.begin(), data.end(), isEven);
+
+    EXPECT_EQ(count, middle - data.begin());
+    EXPECT_TRUE(std::is_partitioned(data.get<0>().begin(), data.get<0>().end(), isEven));
+    EXPECT_TRUE(consistent(data));
+}
+
+TEST_F(TestPartition, StablePartitionBy)
+{
+    auto expected = stablePartitioned();
+
+    joint::thread_pool pool(4);
+    auto middle = joint::stable_partition_by<0>(joint::parallel_policy(&pool), data.begin(), data.end(), isEven);
+
+    EXPECT_TRUE(std::is_partitioned(data.get<0>().begin(), data.get<0>().end(), isEven));
+    EXPECT_TRUE(std::all_of(data.get<0>().begin(), data.get<0>().begin() + (middle - data.begin()), isEven));
+    EXPECT_EQ(expected, data.get<1>());
+    EXPECT_TRUE(consistent(data));
+}
+
+TEST_F(TestPartition, StablePartitionBySequential)
+{
+    auto expected = stablePartitioned();
+
+    joint::stable_partition_by<0>(joint::seq, data.begin(), data.end(), isEven);
+
+    EXPECT_EQ(expected, data.get<1>());
+}
+
+TEST_F(TestPartition, Filter)
+{
+    auto     original = data;
+    columns  output;
+
+    auto count = joint::filter<0>(data.begin(), data.end(), isEven, output);
+
+    EXPECT_EQ(output.size(), count);
+    EXPECT_TRUE(std::all_of(output.get<0>().begin(), output.get<0>().end(), isEven));
+    EXPECT_TRUE(consistent(output));
+
+    auto expected = stablePartitioned();
+    expected.resize(count);
+    EXPECT_EQ(expected, output.get<1>());
+    EXPECT_EQ(original.get<1>(), data.get<1>());
+}
+
+TEST_F(TestPartition, Empty)
+{
+    columns empty;
+    auto middle = joint::partition_by<0>(empty.begin(), empty.end(), isEven);
+    EXPECT_TRUE(middle == empty.begin());
+    middle = joint::stable_partition_by<0>(empty.begin(), empty.end(), isEven);
+    EXPECT_TRUE(middle == empty.begin());
+}
+
+TEST_F(TestPartition, StablePartitionByNotDefaultConstructible)
+{
+    struct entry
+    {
+        explicit entry(int v) : value(v) { }
+        int value;
+    };
+
+    std::vector<int>   keys;
+    std::vector<entry> entries;
+    for (int i = 0; i < 1000; ++i)
+    {
+        keys.push_back(i);
+        entries.push_back(entry(i));
+    }
+
+    auto middle = joint::stable_partition_by<0>(joint::make_joint(keys.begin(), entries.begin()),
+                                                joint::make_joint(keys.end(), entries.end()),
+                                                [](int i) { return i % 3 == 0; });
+
+    EXPECT_EQ(334, middle - joint::make_joint(keys.begin(), entries.begin()));
+    for (std::size_t i = 0; i < keys.size(); ++i) EXPECT_EQ(keys[i], entries[i].value);
+    EXPECT_TRUE(std::is_sorted(keys.begin(), keys.begin() + 334));
+    EXPECT_TRUE(std::is_sorted(keys.begin() + 334, keys.end()));
+}
+
+namespace
+{
+
+    // An entry counting the live instances, whose moves may throw (once the limit of the moves is reached).
+    struct ThrowingMove
+    {
+        static long live;
+        static long moves;
+
+        explicit ThrowingMove(int v) : value(v) { ++live; }
+        ThrowingMove(ThrowingMove const & other) : value(other.value) { ++live; }
+        ThrowingMove(ThrowingMove && other) : value(other.value)
+        {
+            if (moves-- == 0) throw std::runtime_error("move");
+            ++live;
+        }
+        ThrowingMove & operator=(ThrowingMove const &) = default;
+        ThrowingMove & operator=(ThrowingMove &&) = default;
+        ~ThrowingMove() { --live; }
+
+        int value;
+    };
+
+    long ThrowingMove::live  = 0;
+    long ThrowingMove::moves = -1;
+
+}
+
+TEST_F(TestPartition, StablePartitionByThrowingMove)
+{
+    {
+        std::vector<int>          keys;
+        std::vector<ThrowingMove> entries;
+        entries.reserve(1000);
+        for (int i = 0; i < 1000; ++i)
+        {
+            keys.push_back(i);
+            entries.push_back(ThrowingMove(i));
+        }
+        auto const first = joint::make_joint(keys.begin(), entries.begin());
+        auto const last  = joint::make_joint(keys.end(), entries.end());
+
+        auto middle = joint::stable_partition_by<0>(first, last, [](int i) { return i % 3 == 0; });
+        EXPECT_EQ(334, middle - first);
+        for (std::size_t i = 0; i < keys.size(); ++i) EXPECT_EQ(keys[i], entries[i].value);
+        EXPECT_TRUE(std::is_sorted(keys.begin(), keys.begin() + 334));
+        EXPECT_EQ(1000, ThrowingMove::live);
+
+        // A move failing in the middle leaves no buffered entries behind.
+        ThrowingMove::moves = 500;
+        EXPECT_THROW(joint::stable_partition_by<0>(first, last, [](int i) { return i % 2 == 0; }),
+                     std::runtime_error);
+        ThrowingMove::moves = -1;
+        EXPECT_EQ(1000, ThrowingMove::live);
+    }
+    EXPECT_EQ(0, ThrowingMove::live);
+}
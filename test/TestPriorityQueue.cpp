@@ -0,0 +1,86 @@
+//
+// Tests of the priority queue of joint rows.
+//
+
+#include <gtest/gtest.h>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "joint_priority_queue.hpp"
+
+TEST(TestPriorityQueue, PushPop)
+{
+    joint::priority_queue<int, std::string, long> queue;
+    std::priority_queue<std::pair<int, long>>     expected;
+
+    std::default_random_engine         generator(0);
+    std::uniform_int_distribution<int> distribution(0, 1000);
+
+    for (long i = 0; i < 20000; ++i)
+    {
+        // Pushes and pops interleaved, so that the slots are reused.
+        if (distribution(generator) % 3 != 0 || queue.empty())
+        {
+            int key = distribution(generator);
+            queue.push(key, std::to_string(key), i);
+            expected.push(std::make_pair(key, i));
+        }
+        else
+        {
+            ASSERT_EQ(expected.top().first, queue.top_key());
+            EXPECT_EQ(std::to_string(queue.top_key()), queue.top<0>());
+            expected.pop();
+            queue.pop();
+        }
+        ASSERT_EQ(expected.size(), queue.size());
+    }
+
+    while (!queue.empty())
+    {
+        ASSERT_EQ(expected.top().first, queue.top_key());
+        EXPECT_EQ(std::to_string(queue.top_key()), queue.top_payload().get<0>());
+        expected.pop();
+        queue.pop();
+    }
+}
+
+TEST(TestPriorityQueue, Greater)
+{
+    joint::basic_priority_queue<std::greater<int>, int, std::string> queue;
+    for (int i : {5, 2, 4, 1, 3}) queue.push(i, std::to_string(i));
+
+    for (int i = 1; i <= 5; ++i)
+    {
+        ASSERT_FALSE(queue.empty());
+        EXPECT_EQ(i, queue.top_key());
+        EXPECT_EQ(std::to_string(i), queue.top<0>());
+        queue.pop();
+    }
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(TestPriorityQueue, ReleasePayload)
+{
+    // The payloads of the popped rows are released, not kept until their slots are reused.
+    auto                                                          resource = std::make_shared<int>(42);
+    joint::priority_queue<int, std::shared_ptr<int>, std::string> queue;
+    for (int i = 0; i < 100; ++i) queue.push(i, resource, std::string(1000, 'x'));
+    EXPECT_EQ(101, resource.use_count());
+
+    for (int i = 0; i < 60; ++i) queue.pop();
+    EXPECT_EQ(41, resource.use_count());
+    EXPECT_EQ(39, queue.top_key());
+    EXPECT_EQ(42, * queue.top<0>());
+
+    queue.push(1000, resource, "y");
+    EXPECT_EQ(42, resource.use_count());
+    EXPECT_EQ("y", queue.top<1>());
+
+    while (!queue.empty()) queue.pop();
+    EXPECT_EQ(1, resource.use_count());
+}
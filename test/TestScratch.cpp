@@ -0,0 +1,144 @@
+//
+// Tests of the scratch memory used by the joint algorithms.
+//
+
+#include <gtest/gtest.h>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <cstring>
+
+#include "joint_scratch.hpp"
+#include "joint_partition.hpp"
+
+// Upstream resource counting the allocations.
+class CountingResource : public joint::memory_resource
+{
+    public:
+        size_t allocations = 0;
+        size_t live        = 0;
+
+    private:
+        void * do_allocate(size_t bytes, size_t alignment) override
+        {
+            ++allocations;
+            ++live;
+            return joint::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void * p, size_t bytes, size_t alignment) override
+        {
+            --live;
+            joint::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+};
+
+TEST(TestScratch, Alignment)
+{
+    joint::scratch_arena arena;
+
+    void * p1 = arena.allocate(3, 1);
+    void * p2 = arena.allocate(8, 8);
+    void * p3 = arena.allocate(64, 64);
+
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(p2) % 8);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(p3) % 64);
+
+    arena.deallocate(p3, 64, 64);
+    arena.deallocate(p2, 8, 8);
+    arena.deallocate(p1, 3, 1);
+}
+
+TEST(TestScratch, OverAlignedNewDelete)
+{
+    struct alignas(64) line
+    {
+        char bytes[64];
+    };
+
+    joint::memory_resource * resource = joint::new_delete_resource();
+    for (std::size_t alignment : {std::size_t(16), std::size_t(64), std::size_t(256), std::size_t(4096)})
+    {
+        std::vector<void *> blocks;
+        for (std::size_t bytes = 1; bytes < 1000; bytes = 3 * bytes + 1)
+        {
+            blocks.push_back(resource->allocate(bytes, alignment));
+            EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(blocks.back()) % alignment);
+            std::memset(blocks.back(), 0xff, bytes);
+        }
+        std::size_t bytes = 1;
+        for (void * p : blocks)
+        {
+            resource->deallocate(p, bytes, alignment);
+            bytes = 3 * bytes + 1;
+        }
+    }
+
+    // The over-aligned entries of a scratch vector.
+    joint::scratch_vector<line> lines{joint::scratch_allocator<line>(resource)};
+    for (int i = 0; i < 100; ++i)
+    {
+        lines.push_back(line());
+        ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(lines.data()) % 64);
+    }
+}
+
+TEST(TestScratch, Reuse)
+{
+    CountingResource     upstream;
+    joint::scratch_arena arena(0, & upstream);
+
+    for (int k = 0; k < 4; ++k)
+    {
+        joint::scratch_vector<int> v1{joint::scratch_allocator<int>(& arena)};
+        joint::scratch_vector<double> v2{joint::scratch_allocator<double>(& arena)};
+        for (int i = 0; i < 10000; ++i)
+        {
+            v1.push_back(i);
+            v2.push_back(i);
+        }
+        EXPECT_EQ(9999, v1.back());
+    }
+
+    // The blocks are merged after the first round and reused afterwards.
+    EXPECT_EQ(1u, arena.blocks());
+    auto allocations = upstream.allocations;
+    {
+        joint::scratch_vector<int> v{joint::scratch_allocator<int>(& arena)};
+        v.resize(10000);
+    }
+    EXPECT_EQ(allocations, upstream.allocations);
+
+    arena.release();
+    EXPECT_EQ(0u, upstream.live);
+}
+
+TEST(TestScratch, PartitionWithArena)
+{
+    CountingResource     upstream;
+    joint::scratch_arena arena(0, & upstream);
+
+    std::default_random_engine         generator(0);
+    std::uniform_int_distribution<int> distribution(0, 1024);
+
+    for (int k = 0; k < 8; ++k)
+    {
+        joint::columns<int, std::string> data;
+        for (int i = 0; i < 1000; ++i)
+        {
+            int number = distribution(generator);
+            data.emplace_back(number, std::to_string(number));
+        }
+
+        auto odd = [](int i) { return i % 2 != 0; };
+        auto middle = joint::stable_partition_by<0>(joint::seq, data.begin(), data.end(), odd, & arena);
+
+        EXPECT_TRUE(std::is_partitioned(data.get<0>().begin(), data.get<0>().end(), odd));
+        EXPECT_EQ(std::count_if(data.get<0>().begin(), data.get<0>().end(), odd), middle - data.begin());
+        for (size_t i = 0; i < data.size(); ++i) EXPECT_EQ(std::to_string(data.get<0>()[i]), data.get<1>()[i]);
+    }
+
+    // After the first call, the arena does not need any more memory.
+    EXPECT_LE(upstream.allocations, 4u);
+}
@@ -0,0 +1,151 @@
+//
+// Tests of the random shuffling and sampling of joint ranges.
+//
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "joint_shuffle.hpp"
+
+namespace
+{
+
+    // Keys 0, ..., n - 1 with the payloads recording them.
+    void create(std::size_t n, std::vector<int> & keys, std::vector<std::string> & strings)
+    {
+        keys.clear();
+        strings.clear();
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            keys.push_back(static_cast<int>(i));
+            strings.push_back(std::to_string(i));
+        }
+    }
+
+}
+
+TEST(TestShuffle, ShuffleKeepsRowsAligned)
+{
+    for (std::size_t n : {0, 1, 2, 1000, 70000, 1000000})
+    {
+        std::vector<int>         keys;
+        std::vector<std::string> strings;
+        create(n, keys, strings);
+
+        std::mt19937_64 generator(n);
+        joint::shuffle(joint::make_joint(keys.begin(), strings.begin()), joint::make_joint(keys.end(), strings.end()),
+                       generator);
+
+        for (std::size_t i = 0; i < n; ++i) ASSERT_EQ(std::to_string(keys[i]), strings[i]);
+
+        std::size_t fixed = 0;
+        for (std::size_t i = 0; i < n; ++i) fixed += keys[i] == static_cast<int>(i);
+        if (n >= 1000)
+        {
+            EXPECT_LT(fixed, 20u);
+        }
+
+        std::sort(keys.begin(), keys.end());
+        for (std::size_t i = 0; i < n; ++i) ASSERT_EQ(static_cast<int>(i), keys[i]);
+    }
+}
+
+TEST(TestShuffle, ShuffleReproducible)
+{
+    std::size_t const n = 300000;
+
+    std::vector<int>  sequential(n), parallel(n);
+    std::vector<long> payload(n);
+    for (std::size_t i = 0; i < n; ++i) sequential[i] = parallel[i] = static_cast<int>(i);
+
+    std::mt19937 first_generator(42), second_generator(42);
+    joint::shuffle(joint::seq, joint::make_joint(sequential.begin()), joint::make_joint(sequential.end()),
+                   first_generator);
+    joint::shuffle(joint::par, joint::make_joint(parallel.begin(), payload.begin()),
+                   joint::make_joint(parallel.end(), payload.end()), second_generator);
+
+    EXPECT_EQ(sequential, parallel);
+
+    // Each position takes each row with the same probability (roughly).
+    std::vector<std::size_t> first_rows(10, 0);
+    for (unsigned seed = 0; seed < 10000; ++seed)
+    {
+        std::vector<int> small{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+        std::mt19937     generator(seed);
+        joint::shuffle(joint::make_joint(small.begin()), joint::make_joint(small.end()), generator);
+        ++first_rows[small[0]];
+    }
+    for (std::size_t count : first_rows)
+    {
+        EXPECT_GT(count, 850u);
+        EXPECT_LT(count, 1150u);
+    }
+}
+
+TEST(TestShuffle, ShuffleMoveOnly)
+{
+    std::size_t const n = 100000;
+
+    std::vector<std::unique_ptr<int>> pointers;
+    std::vector<int>                  keys;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        pointers.emplace_back(new int(static_cast<int>(i)));
+        keys.push_back(static_cast<int>(i));
+    }
+
+    std::mt19937 generator(1);
+    joint::shuffle(joint::make_joint(keys.begin(), pointers.begin()), joint::make_joint(keys.end(), pointers.end()),
+                   generator);
+
+    for (std::size_t i = 0; i < n; ++i) ASSERT_EQ(keys[i], * pointers[i]);
+}
+
+TEST(TestShuffle, Sample)
+{
+    std::vector<int>         keys;
+    std::vector<std::string> strings;
+    create(100000, keys, strings);
+
+    for (std::size_t k : {0, 1, 100, 50000, 100000, 200000})
+    {
+        std::vector<int>         sampled_keys(std::min<std::size_t>(k, keys.size()));
+        std::vector<std::string> sampled_strings(sampled_keys.size());
+
+        std::mt19937 generator(k);
+        auto         end = joint::sample(joint::make_joint(keys.begin(), strings.begin()),
+                                         joint::make_joint(keys.end(), strings.end()), k,
+                                         joint::make_joint(sampled_keys.begin(), sampled_strings.begin()),
+                                         generator);
+
+        EXPECT_TRUE(end == joint::make_joint(sampled_keys.end(), sampled_strings.end()));
+        for (std::size_t i = 0; i < sampled_keys.size(); ++i)
+        {
+            ASSERT_EQ(std::to_string(sampled_keys[i]), sampled_strings[i]);
+            if (i > 0)
+            {
+                ASSERT_LT(sampled_keys[i - 1], sampled_keys[i]);
+            }
+        }
+    }
+
+    // Each row is sampled with the same probability (roughly).
+    std::vector<std::size_t> counts(10, 0);
+    for (unsigned seed = 0; seed < 10000; ++seed)
+    {
+        std::vector<int> sampled(3);
+        std::mt19937     generator(seed);
+        joint::sample(joint::make_joint(keys.begin()), joint::make_joint(keys.begin() + 10), 3,
+                      joint::make_joint(sampled.begin()), generator);
+        for (int key : sampled) ++counts[key];
+    }
+    for (std::size_t count : counts)
+    {
+        EXPECT_GT(count, 2700u);
+        EXPECT_LT(count, 3300u);
+    }
+}
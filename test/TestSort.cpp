@@ -0,0 +1,553 @@
+//
+// Tests of the sorting of joint ranges.
+//
+
+#include <gtest/gtest.h>
+#include <array>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <deque>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+#include "joint_sort.hpp"
+#include "joint_columns.hpp"
+#include "joint_permutation.hpp"
+#include "joint_incremental_sort.hpp"
+#include "joint_maintained_sort.hpp"
+
+class TestSort : public ::testing::Test
+{
+    protected:
+        typedef joint::columns<int, std::string> columns;
+
+        // Random keys in [0, range); the strings record the original positions.
+        columns createRandom(size_t size, int range)
+        {
+            std::default_random_engine         generator(0);
+            std::uniform_int_distribution<int> distribution(0, range - 1);
+
+            columns data;
+            for (size_t i = 0; i < size; ++i) data.emplace_back(distribution(generator), std::to_string(i));
+            return data;
+        }
+
+        // Expected result of a stable sort: the strings in the order of the stably sorted keys.
+        template<typename Compare = std::less<int>>
+        std::vector<std::string> stableSorted(columns const & data, Compare comp = Compare())
+        {
+            std::vector<size_t> permutation(data.size());
+            for (size_t i = 0; i < permutation.size(); ++i) permutation[i] = i;
+            std::stable_sort(permutation.begin(), permutation.end(),
+                             [&](size_t a, size_t b) { return comp(data.get<0>()[a], data.get<0>()[b]); });
+
+            std::vector<std::string> strings;
+            for (auto i : permutation) strings.push_back(data.get<1>()[i]);
+            return strings;
+        }
+};
+
+TEST_F(TestSort, StableSortRandom)
+{
+    for (size_t size : {0, 1, 2, 31, 64, 65, 1000, 100000})
+    {
+        auto data     = createRandom(size, 100);
+        auto expected = stableSorted(data);
+
+        joint::stable_sort(data.begin(), data.end());
+
+        EXPECT_TRUE(std::is_sorted(data.get<0>().begin(), data.get<0>().end()));
+        EXPECT_EQ(expected, data.get<1>());
+    }
+}
+
+TEST_F(TestSort, StableSortPresorted)
+{
+    auto data = createRandom(100000, 1000);
+
+    // Sorted, reversed (with duplicates, so the reversal must keep them stable), and appended to sorted.
+    std::sort(data.get<0>().begin(), data.get<0>().end());
+    auto expected = stableSorted(data);
+    joint::stable_sort(data.begin(), data.end());
+    EXPECT_EQ(expected, data.get<1>());
+
+    std::reverse(data.get<0>().begin(), data.get<0>().end());
+    expected = stableSorted(data);
+    joint::stable_sort(data.begin(), data.end());
+    EXPECT_EQ(expected, data.get<1>());
+
+    auto tail = createRandom(1000, 1000);
+    for (size_t i = 0; i < tail.size(); ++i) data.emplace_back(tail.get<0>()[i], "tail" + tail.get<1>()[i]);
+    expected = stableSorted(data);
+    joint::stable_sort(data.begin(), data.end());
+    EXPECT_TRUE(std::is_sorted(data.get<0>().begin(), data.get<0>().end()));
+    EXPECT_EQ(expected, data.get<1>());
+}
+
+TEST_F(TestSort, StableSortComparator)
+{
+    auto data     = createRandom(10000, 50);
+    auto expected = stableSorted(data, std::greater<int>());
+
+    joint::stable_sort(data.begin(), data.end(), std::greater<int>());
+
+    EXPECT_TRUE(std::is_sorted(data.get<0>().rbegin(), data.get<0>().rend()));
+    EXPECT_EQ(expected, data.get<1>());
+}
+
+TEST_F(TestSort, StableSortBySecondColumn)
+{
+    auto data = createRandom(5000, 10);
+    std::vector<int> expected = data.get<0>();
+
+    joint::scratch_arena arena;
+    joint::stable_sort_by<1>(data.begin(), data.end(), joint::less(), & arena);
+
+    EXPECT_TRUE(std::is_sorted(data.get<1>().begin(), data.get<1>().end()));
+    for (size_t i = 0; i < data.size(); ++i) EXPECT_EQ(expected[std::stoul(data.get<1>()[i])], data.get<0>()[i]);
+}
+
+TEST_F(TestSort, StableSortDeque)
+{
+    auto data = createRandom(3000, 20);
+    auto expected = stableSorted(data);
+
+    // The second column is not stored contiguously.
+    std::deque<std::string> strings(data.get<1>().begin(), data.get<1>().end());
+
+    joint::stable_sort(joint::make_joint(data.get<0>().begin(), strings.begin()),
+                       joint::make_joint(data.get<0>().end(), strings.end()));
+
+    EXPECT_TRUE(std::is_sorted(data.get<0>().begin(), data.get<0>().end()));
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), strings.begin()));
+}
+
+TEST_F(TestSort, SegmentedSortNetworks)
+{
+    // The zero-one principle: a network sorting all sequences of zeros and ones sorts everything.
+    for (size_t n = 2; n <= 8; ++n)
+    {
+        for (size_t mask = 0; mask < (1u << n); ++mask)
+        {
+            std::vector<int> keys, payload;
+            for (size_t i = 0; i < n; ++i)
+            {
+                keys.push_back((mask >> i) & 1);
+                payload.push_back(keys.back() * 10);
+            }
+            std::vector<size_t> offsets = {0, n};
+
+            joint::segmented_sort(joint::make_joint(keys.begin(), payload.begin()),
+                                  joint::make_joint(keys.end(), payload.end()), offsets.begin(), offsets.end());
+
+            EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+            for (size_t i = 0; i < n; ++i) EXPECT_EQ(10 * keys[i], payload[i]);
+        }
+    }
+}
+
+TEST_F(TestSort, SegmentedSort)
+{
+    std::default_random_engine            generator(1);
+    std::uniform_int_distribution<size_t> sizes(0, 100);
+
+    std::vector<size_t> offsets = {0};
+    while (offsets.back() < 200000)
+        offsets.push_back(offsets.back() + (sizes(generator) < 95 ? sizes(generator) % 20 : sizes(generator) * 50));
+
+    auto data     = createRandom(offsets.back(), 1000);
+    auto original = data;
+
+    joint::thread_pool pool(4);
+    joint::segmented_sort(joint::parallel_policy(& pool), data.begin(), data.end(), offsets.begin(), offsets.end());
+
+    for (size_t k = 0; k + 1 < offsets.size(); ++k)
+    {
+        auto keys = data.get<0>().begin();
+        EXPECT_TRUE(std::is_sorted(keys + offsets[k], keys + offsets[k + 1]));
+
+        // The segment contains the same rows as before.
+        std::vector<std::string> before(original.get<1>().begin() + offsets[k], original.get<1>().begin() + offsets[k + 1]);
+        std::vector<std::string> after(data.get<1>().begin() + offsets[k], data.get<1>().begin() + offsets[k + 1]);
+        std::sort(before.begin(), before.end());
+        std::sort(after.begin(), after.end());
+        EXPECT_EQ(before, after);
+    }
+    for (size_t i = 0; i < data.size(); ++i)
+        EXPECT_EQ(original.get<0>()[std::stoul(data.get<1>()[i])], data.get<0>()[i]);
+}
+
+TEST_F(TestSort, SortStrings)
+{
+    std::default_random_engine         generator(2);
+    std::uniform_int_distribution<int> lengths(0, 24);
+    std::uniform_int_distribution<int> letters(0, 3);
+
+    // Short alphabet and common prefixes make a lot of ties in the prefixes (including embedded zeros).
+    std::vector<std::string> strings;
+    std::vector<int>         positions;
+    for (int i = 0; i < 20000; ++i)
+    {
+        std::string s = (i % 3 == 0) ? "common prefix longer than eight bytes " : "";
+        for (int l = lengths(generator); l > 0; --l) s += "\0ab\xff"[letters(generator)];
+        strings.push_back(s);
+        positions.push_back(i);
+    }
+
+    auto expected = strings;
+    std::stable_sort(expected.begin(), expected.end());
+
+    joint::sort(joint::make_joint(strings.begin(), positions.begin()),
+                joint::make_joint(strings.end(), positions.end()));
+
+    EXPECT_EQ(expected, strings);
+
+    // Equal strings keep their original order.
+    for (size_t i = 1; i < strings.size(); ++i)
+        EXPECT_TRUE(strings[i - 1] != strings[i] || positions[i - 1] < positions[i]);
+}
+
+TEST_F(TestSort, SortBy)
+{
+    auto data     = createRandom(10000, 100);
+    auto original = data;
+
+    joint::sort_by<1>(data.begin(), data.end());
+    EXPECT_TRUE(std::is_sorted(data.get<1>().begin(), data.get<1>().end()));
+    for (size_t i = 0; i < data.size(); ++i)
+        EXPECT_EQ(original.get<0>()[std::stoul(data.get<1>()[i])], data.get<0>()[i]);
+
+    joint::sort(data.begin(), data.end());
+    EXPECT_TRUE(std::is_sorted(data.get<0>().begin(), data.get<0>().end()));
+}
+
+TEST_F(TestSort, SortPresorted)
+{
+    // The keys are sorted (with duplicates), strictly descending, nearly sorted, with few distinct values and random.
+    std::vector<std::vector<int>> inputs(5);
+    std::default_random_engine    generator(0);
+    for (int i = 0; i < 100000; ++i)
+    {
+        inputs[0].push_back(i / 3);
+        inputs[1].push_back(100000 - i);
+        inputs[2].push_back(i % 1000 == 0 ? static_cast<int>(generator() % 100000) : i);
+        inputs[3].push_back(static_cast<int>(generator() % 5));
+        inputs[4].push_back(static_cast<int>(generator() % 100000));
+    }
+
+    for (auto & keys : inputs)
+    {
+        columns data;
+        for (size_t i = 0; i < keys.size(); ++i) data.emplace_back(keys[i], std::to_string(i));
+
+        joint::sort(data.begin(), data.end());
+
+        EXPECT_TRUE(std::is_sorted(data.get<0>().begin(), data.get<0>().end()));
+        for (size_t i = 0; i < data.size(); ++i) ASSERT_EQ(keys[std::stoul(data.get<1>()[i])], data.get<0>()[i]);
+    }
+}
+
+TEST_F(TestSort, CountingSort)
+{
+    for (size_t size : {0, 1, 2, 1000, 100000})
+    {
+        auto data = createRandom(size, 300);
+        for (auto & key : data.get<0>()) key -= 100;
+        auto expected = stableSorted(data);
+
+        joint::counting_sort(data.begin(), data.end(), -100, 199);
+
+        EXPECT_TRUE(std::is_sorted(data.get<0>().begin(), data.get<0>().end()));
+        EXPECT_EQ(expected, data.get<1>());
+    }
+}
+
+TEST_F(TestSort, AmericanFlagSort)
+{
+    for (size_t size : {0, 1, 2, 1000, 100000})
+    {
+        auto data     = createRandom(size, 200);
+        auto original = data;
+
+        joint::american_flag_sort(data.begin(), data.end(), 0, 199);
+
+        EXPECT_TRUE(std::is_sorted(data.get<0>().begin(), data.get<0>().end()));
+        for (size_t i = 0; i < data.size(); ++i)
+            ASSERT_EQ(original.get<0>()[std::stoul(data.get<1>()[i])], data.get<0>()[i]);
+    }
+}
+
+TEST_F(TestSort, CountingSortOutOfRange)
+{
+    // The declared ranges are checked before anything is moved (the debug builds assert instead of throwing).
+#ifdef NDEBUG
+#define EXPECT_REJECTED(statement) EXPECT_THROW(statement, std::out_of_range)
+#else
+#define EXPECT_REJECTED(statement) EXPECT_DEATH(statement, "declared range")
+#endif
+    auto data     = createRandom(1000, 200);
+    auto original = data;
+
+    EXPECT_REJECTED(joint::counting_sort(data.begin(), data.end(), 0, 150));
+    EXPECT_REJECTED(joint::counting_sort(data.begin(), data.end(), 10, 199));
+    EXPECT_REJECTED(joint::american_flag_sort(data.begin(), data.end(), 0, 150));
+    EXPECT_REJECTED(joint::counting_sort(data.begin(), data.end(), 199, 0));
+    EXPECT_REJECTED(joint::american_flag_sort(data.begin(), data.end(), 199, 0));
+    EXPECT_REJECTED(joint::counting_sort(data.begin(), data.end(), std::numeric_limits<long>::min(),
+                                         std::numeric_limits<long>::max()));
+#undef EXPECT_REJECTED
+
+    EXPECT_EQ(original.get<0>(), data.get<0>());
+    EXPECT_EQ(original.get<1>(), data.get<1>());
+}
+
+TEST_F(TestSort, SortSmallKeys)
+{
+    enum class status : unsigned char { open, pending, closed };
+
+    std::default_random_engine generator(0);
+    std::vector<std::uint8_t>  codes;
+    std::vector<status>        states;
+    std::vector<double>        values;
+    std::vector<size_t>        positions;
+    for (size_t i = 0; i < 50000; ++i)
+    {
+        codes.push_back(static_cast<std::uint8_t>(generator()));
+        states.push_back(static_cast<status>(generator() % 3));
+        values.push_back(static_cast<double>(generator() % 4));
+        positions.push_back(i);
+    }
+
+    // The integer keys are sorted by the counting sort (stable), the doubles by the three-way quicksort.
+    auto sorted_by = [&](std::function<bool(size_t, size_t)> less)
+    {
+        std::vector<size_t> expected(positions.size());
+        for (size_t i = 0; i < expected.size(); ++i) expected[i] = i;
+        std::stable_sort(expected.begin(), expected.end(), less);
+        return expected;
+    };
+
+    auto expected = sorted_by([&](size_t a, size_t b) { return codes[a] < codes[b]; });
+    joint::sort(joint::make_joint(codes.begin(), positions.begin()), joint::make_joint(codes.end(), positions.end()));
+    EXPECT_EQ(expected, positions);
+
+    auto original_states = states;
+    for (size_t i = 0; i < positions.size(); ++i) positions[i] = i;
+    expected = sorted_by([&](size_t a, size_t b) { return original_states[a] < original_states[b]; });
+    joint::sort(joint::make_joint(states.begin(), positions.begin()), joint::make_joint(states.end(), positions.end()));
+    EXPECT_EQ(expected, positions);
+
+    auto original_values = values;
+    for (size_t i = 0; i < positions.size(); ++i) positions[i] = i;
+    joint::sort(joint::make_joint(values.begin(), positions.begin()), joint::make_joint(values.end(), positions.end()));
+    EXPECT_TRUE(std::is_sorted(values.begin(), values.end()));
+    for (size_t i = 0; i < positions.size(); ++i) ASSERT_EQ(original_values[positions[i]], values[i]);
+}
+
+TEST_F(TestSort, SortPatterns)
+{
+    // The double keys are not sorted by the counting sort: the patterns go to the pattern-defeating quicksort.
+    std::default_random_engine    generator(0);
+    std::vector<std::vector<double>> inputs(5);
+    for (int i = 0; i < 100000; ++i)
+    {
+        inputs[0].push_back(static_cast<double>(generator() % 1000000));
+        inputs[1].push_back(i < 50000 ? i : 100000 - i);
+        inputs[2].push_back(i % 1000 + static_cast<double>(generator() % 10) / 10);
+        inputs[3].push_back(static_cast<double>(generator() % 1000));
+        inputs[4].push_back(i % 2 == 0 ? i : -i);
+    }
+    for (size_t size : {2, 3, 23, 24, 25, 129, 200})
+    {
+        inputs.push_back(std::vector<double>());
+        for (size_t i = 0; i < size; ++i) inputs.back().push_back(static_cast<double>(generator() % 50));
+    }
+
+    for (auto & keys : inputs)
+    {
+        for (bool descending : {false, true})
+        {
+            std::vector<double> values = keys;
+            std::vector<size_t> positions(keys.size());
+            for (size_t i = 0; i < positions.size(); ++i) positions[i] = i;
+
+            auto first = joint::make_joint(values.begin(), positions.begin());
+            auto last  = joint::make_joint(values.end(), positions.end());
+            if (descending)
+            {
+                joint::sort(first, last, std::greater<double>());
+                EXPECT_TRUE(std::is_sorted(values.rbegin(), values.rend()));
+            }
+            else
+            {
+                joint::sort(first, last);
+                EXPECT_TRUE(std::is_sorted(values.begin(), values.end()));
+            }
+
+            for (size_t i = 0; i < positions.size(); ++i) ASSERT_EQ(keys[positions[i]], values[i]);
+            std::sort(positions.begin(), positions.end());
+            for (size_t i = 0; i < positions.size(); ++i) ASSERT_EQ(i, positions[i]);
+        }
+    }
+}
+
+TEST_F(TestSort, Permute)
+{
+    auto data = createRandom(1000, 100);
+    auto original = data;
+
+    std::vector<size_t> permutation(data.size());
+    for (size_t i = 0; i < permutation.size(); ++i) permutation[i] = (7 * i) % permutation.size();
+
+    joint::permute(data.begin(), data.end(), permutation.begin());
+
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        EXPECT_EQ(original.get<0>()[permutation[i]], data.get<0>()[i]);
+        EXPECT_EQ(original.get<1>()[permutation[i]], data.get<1>()[i]);
+    }
+}
+
+TEST_F(TestSort, IncrementalSortTake)
+{
+    for (int range : {1, 10, 100000})
+    {
+        for (size_t k : {0, 1, 20, 1000, 100000})
+        {
+            auto original = createRandom(100000, range);
+            auto data     = original;
+            auto expected = original.get<0>();
+            std::sort(expected.begin(), expected.end());
+
+            auto sorter = joint::incremental_sort(data.begin(), data.end());
+            auto page   = sorter.take(k);
+
+            ASSERT_EQ(k, static_cast<size_t>(page - data.begin()));
+            EXPECT_TRUE(std::equal(expected.begin(), expected.begin() + k, data.get<0>().begin()));
+            for (size_t i = 0; i < data.size(); ++i)
+                ASSERT_EQ(original.get<0>()[std::stoul(data.get<1>()[i])], data.get<0>()[i]);
+        }
+    }
+}
+
+TEST_F(TestSort, IncrementalSortIterate)
+{
+    auto data     = createRandom(5000, 1000);
+    auto expected = data.get<0>();
+    std::sort(expected.begin(), expected.end(), std::greater<int>());
+
+    std::vector<int> keys;
+    for (auto row : joint::incremental_sort(data.begin(), data.end(), std::greater<int>()))
+        keys.push_back(row.get<0>());
+
+    EXPECT_EQ(expected, keys);
+    EXPECT_EQ(expected, data.get<0>());
+}
+
+TEST_F(TestSort, MaintainedSort)
+{
+    // Few (merged back), many (sorted again) and repeated updates of the keys.
+    for (size_t updates : {0, 1, 10, 100, 20000})
+    {
+        auto                       data = createRandom(100000, 1000);
+        std::vector<int>           keys = data.get<0>();  // by the original positions
+        std::default_random_engine generator(1);
+
+        auto book = joint::maintained_sort(data.begin(), data.end());
+        EXPECT_TRUE(std::is_sorted(data.get<0>().begin(), data.get<0>().end()));
+
+        for (int tick = 0; tick < 3; ++tick)
+        {
+            for (size_t u = 0; u < updates; ++u)
+            {
+                size_t const i   = generator() % data.size();
+                int const    key = static_cast<int>(generator() % 1000);
+                if (u % 2 == 0)
+                {
+                    book.update(i).get<0>() = key;
+                }
+                else
+                {
+                    data.get<0>()[i] = key;
+                    book.mark_dirty(i);
+                }
+                keys[std::stoul(data.get<1>()[i])] = key;
+            }
+            EXPECT_GE(updates, book.dirty());
+
+            auto sorted = book.sorted();
+            EXPECT_EQ(0u, book.dirty());
+            EXPECT_EQ(data.size(), sorted.size());
+            EXPECT_TRUE(std::is_sorted(data.get<0>().begin(), data.get<0>().end()));
+            for (size_t i = 0; i < data.size(); ++i)
+                ASSERT_EQ(keys[std::stoul(data.get<1>()[i])], data.get<0>()[i]);
+        }
+    }
+}
+
+#if __cplusplus >= 201703L
+namespace
+{
+
+    // A keyword table sorted at compile time.
+    struct keyword_table
+    {
+        std::array<char const *, 5> names{{"while", "do", "if", "for", "else"}};
+        std::array<int, 5>          ids{{1, 2, 3, 4, 5}};
+    };
+
+    struct c_string_less
+    {
+        constexpr bool operator()(char const * a, char const * b) const
+        {
+            for (; * a && * a == * b; ++a, ++b) { }
+            return static_cast<unsigned char>(* a) < static_cast<unsigned char>(* b);
+        }
+    };
+
+    constexpr keyword_table sorted_keywords()
+    {
+        keyword_table table;
+        joint::constexpr_sort(joint::make_joint(table.names.begin(), table.ids.begin()),
+                              joint::make_joint(table.names.end(), table.ids.end()), c_string_less());
+        return table;
+    }
+
+    constexpr int keyword_id(keyword_table table, char const * name)
+    {
+        auto const end = joint::make_joint(table.names.end(), table.ids.end());
+        auto const it  = joint::constexpr_lower_bound_by<0>(joint::make_joint(table.names.begin(), table.ids.begin()),
+                                                            end, name, c_string_less());
+        return it != end && !c_string_less()(name, * it.get<0>()) ? * it.get<1>() : 0;
+    }
+
+    constexpr keyword_table keywords = sorted_keywords();
+
+    static_assert(keywords.ids[0] == 2 && keywords.ids[4] == 1, "The table is sorted at compile time.");
+    static_assert(keyword_id(keywords, "for") == 4 && keyword_id(keywords, "goto") == 0, "The table is searched.");
+
+}
+#endif
+
+TEST_F(TestSort, ConstexprSort)
+{
+    for (size_t size : {0, 1, 2, 10, 100, 500})
+    {
+        auto data = createRandom(size, 10);
+        auto expected = stableSorted(data);
+
+        joint::constexpr_sort(data.begin(), data.end());
+
+        EXPECT_EQ(expected, data.get<1>());
+        for (int key = -1; key <= 10; ++key)
+        {
+            auto it = joint::constexpr_lower_bound_by<0>(data.begin(), data.end(), key);
+            EXPECT_EQ(std::lower_bound(data.get<0>().begin(), data.get<0>().end(), key) - data.get<0>().begin(),
+                      it - data.begin());
+        }
+    }
+}
@@ -7,10 +7,12 @@
 #include <string>
 #include <algorithm>
 #include <random>
-#include <chrono>
 #include <boost/iterator/counting_iterator.hpp>
 
 #include "joint_iterator.hpp"
+#include "joint_observer.hpp"
+#include "joint_shuffle.hpp"
+#include "joint_sort.hpp"
 
 class TestSortPerformance1 : public ::testing::Test
 {
@@ -20,7 +22,9 @@ class TestSortPerformance1 : public ::testing::Test
         typedef joint_iterator::value_type value_type;
         typedef joint_iterator::reference  reference;
 
-        typedef std::chrono::high_resolution_clock clock;
+        // The phases of the sorts (and the whole sort) with the hardware counters (if available).
+        joint::phase_recorder recorder{true};
+        joint::observe_scope  scope{recorder};
 
         std::vector<int>         numbers;
         std::vector<std::string> strings;
@@ -48,117 +52,127 @@ class TestSortPerformance1 : public ::testing::Test
                 strings.back() += strings.back();
             }
 
-            std::default_random_engine generator(0);
-            std::random_shuffle(numbers.begin(), numbers.end(), [&](size_t i) { return generator() % i; });
-
             begin = joint_iterator(std::make_tuple(numbers.begin(), strings.begin()));
             end   = joint_iterator(std::make_tuple(numbers.end(), strings.end()));
+
+            std::default_random_engine generator(0);
+            joint::shuffle(begin, end, generator);
+            recorder.clear();
+        }
+
+        // Print the phases, the last one being the whole sort.
+        void report()
+        {
+            for (auto & phase : recorder.reports()) std::cout << phase << std::endl;
+            RecordProperty("SortTime", static_cast<int>(recorder.reports().back().seconds * 1000));
         }
 };
 
 TEST_F(TestSortPerformance1, JointIteratorDefaultComparator)
 {
-    auto t1 = clock::now();
-
-    std::sort(begin, end);
+    {
+        joint::phase_timer timer(joint::phase::sort, size);
 
-    auto t2   = clock::now();
-    auto time = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
-    std::cout << "Sort time: " << time << "ms" << std::endl;
-    RecordProperty("SortTime", time);
+        std::sort(begin, end);
+    }
+    report();
 
     EXPECT_TRUE(std::is_sorted(numbers.begin(), numbers.end()));
 }
 
 TEST_F(TestSortPerformance1, JointIteratorCustomComparatorValueType)
 {
-    auto t1 = clock::now();
-
-    std::sort(begin, end, [](value_type const & a, value_type const & b) { return a.get<0>() < b.get<0>(); });
+    {
+        joint::phase_timer timer(joint::phase::sort, size);
 
-    auto t2   = clock::now();
-    auto time = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
-    std::cout << "Sort time: " << time << "ms" << std::endl;
-    RecordProperty("SortTime", time);
+        std::sort(begin, end, [](value_type const & a, value_type const & b) { return a.get<0>() < b.get<0>(); });
+    }
+    report();
 
     EXPECT_TRUE(std::is_sorted(numbers.begin(), numbers.end()));
 }
 
 TEST_F(TestSortPerformance1, JointIteratorCustomComparatorReference)
 {
-    auto t1 = clock::now();
+    {
+        joint::phase_timer timer(joint::phase::sort, size);
+
+        std::sort(begin, end, [](reference const & a, reference const & b) { return a.get<0>() < b.get<0>(); });
+    }
+    report();
+
+    EXPECT_TRUE(std::is_sorted(numbers.begin(), numbers.end()));
+}
 
-    std::sort(begin, end, [](reference const & a, reference const & b) { return a.get<0>() < b.get<0>(); });
+TEST_F(TestSortPerformance1, JointStableSort)
+{
+    {
+        joint::phase_timer timer(joint::phase::sort, size);
 
-    auto t2   = clock::now();
-    auto time = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
-    std::cout << "Sort time: " << time << "ms" << std::endl;
-    RecordProperty("SortTime", time);
+        joint::stable_sort(begin, end);
+    }
+    report();
 
     EXPECT_TRUE(std::is_sorted(numbers.begin(), numbers.end()));
 }
 
 TEST_F(TestSortPerformance1, VectorOfStructures)
 {
-    auto t1 = clock::now();
-
-    struct Aggregate
     {
-        int         number;
-        std::string string;
-    };
+        joint::phase_timer timer(joint::phase::sort, size);
+
+        struct Aggregate
+        {
+            int         number;
+            std::string string;
+        };
 
-    std::vector<Aggregate> aggregates;
-    aggregates.reserve(size);
+        std::vector<Aggregate> aggregates;
+        aggregates.reserve(size);
 
-    for (size_t i = 0; i < size; ++i)
-        aggregates.push_back(Aggregate{numbers[i], std::move(strings[i])});
+        for (size_t i = 0; i < size; ++i)
+            aggregates.push_back(Aggregate{numbers[i], std::move(strings[i])});
 
-    std::sort(aggregates.begin(), aggregates.end(),
-              [](Aggregate const & a, Aggregate const & b) { return a.number < b.number; });
+        std::sort(aggregates.begin(), aggregates.end(),
+                  [](Aggregate const & a, Aggregate const & b) { return a.number < b.number; });
 
-    for (size_t i = 0; i < size; ++i)
-    {
-        numbers[i] = aggregates[i].number;
-        strings[i] = std::move(aggregates[i].string);
+        for (size_t i = 0; i < size; ++i)
+        {
+            numbers[i] = aggregates[i].number;
+            strings[i] = std::move(aggregates[i].string);
+        }
     }
-
-    auto t2   = clock::now();
-    auto time = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
-    std::cout << "Sort time: " << time << "ms" << std::endl;
-    RecordProperty("SortTime", time);
+    report();
 
     EXPECT_TRUE(std::is_sorted(numbers.begin(), numbers.end()));
 }
 
 TEST_F(TestSortPerformance1, PermutationVector)
 {
-    auto t1 = clock::now();
-
-    std::vector<size_t> permutation(boost::counting_iterator<size_t>(0),
-                                    boost::counting_iterator<size_t>(0) + size);
+    {
+        joint::phase_timer timer(joint::phase::sort, size);
 
-    std::sort(permutation.begin(), permutation.end(),
-              [&](size_t a, size_t b) { return numbers[a] < numbers[b]; });
+        std::vector<size_t> permutation(boost::counting_iterator<size_t>(0),
+                                        boost::counting_iterator<size_t>(0) + size);
 
-    std::vector<int>         numbers;
-    std::vector<std::string> strings;
-    numbers.reserve(size);
-    strings.reserve(size);
+        std::sort(permutation.begin(), permutation.end(),
+                  [&](size_t a, size_t b) { return numbers[a] < numbers[b]; });
 
-    for (size_t i = 0; i < size; ++i)
-    {
-        numbers.push_back(this->numbers[permutation[i]]);
-        strings.push_back(std::move(this->strings[permutation[i]]));
-    }
+        std::vector<int>         numbers;
+        std::vector<std::string> strings;
+        numbers.reserve(size);
+        strings.reserve(size);
 
-    this->numbers = std::move(numbers);
-    this->strings = std::move(strings);
+        for (size_t i = 0; i < size; ++i)
+        {
+            numbers.push_back(this->numbers[permutation[i]]);
+            strings.push_back(std::move(this->strings[permutation[i]]));
+        }
 
-    auto t2   = clock::now();
-    auto time = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
-    std::cout << "Sort time: " << time << "ms" << std::endl;
-    RecordProperty("SortTime", time);
+        this->numbers = std::move(numbers);
+        this->strings = std::move(strings);
+    }
+    report();
 
     EXPECT_TRUE(std::is_sorted(numbers.begin(), numbers.end()));
 }
@@ -11,10 +11,17 @@
 #include <string>
 #include <algorithm>
 #include <random>
-#include <chrono>
 #include <boost/iterator/counting_iterator.hpp>
 
+#include "joint_columns.hpp"
+#include "joint_huge_pages.hpp"
 #include "joint_iterator.hpp"
+#include "joint_maintained_sort.hpp"
+#include "joint_observer.hpp"
+#include "joint_permutation.hpp"
+#include "joint_shuffle.hpp"
+#include "joint_sort.hpp"
+#include "joint_strided.hpp"
 
 class TestSortPerformance2 : public ::testing::Test
 {
@@ -24,7 +31,9 @@ class TestSortPerformance2 : public ::testing::Test
         typedef joint_iterator::value_type value_type;
         typedef joint_iterator::reference  reference;
 
-        typedef std::chrono::high_resolution_clock clock;
+        // The phases of the sorts (and the whole sort) with the hardware counters (if available).
+        joint::phase_recorder recorder{true};
+        joint::observe_scope  scope{recorder};
 
         std::vector<int>         numbers;
         std::vector<long> longs;
@@ -44,60 +53,104 @@ class TestSortPerformance2 : public ::testing::Test
                 longs.push_back(i);
             }
 
-            std::default_random_engine generator(0);
-            std::random_shuffle(numbers.begin(), numbers.end(), [&](size_t i) { return generator() % i; });
-
             begin = joint_iterator(std::make_tuple(numbers.begin(), longs.begin()));
             end   = joint_iterator(std::make_tuple(numbers.end(), longs.end()));
+
+            std::default_random_engine generator(0);
+            joint::shuffle(begin, end, generator);
+            recorder.clear();
+        }
+
+        // Print the phases, the last one being the whole sort.
+        void report()
+        {
+            for (auto & phase : recorder.reports()) std::cout << phase << std::endl;
+            RecordProperty("SortTime", static_cast<int>(recorder.reports().back().seconds * 1000));
         }
 };
 
 TEST_F(TestSortPerformance2, JointIteratorDefaultComparator)
 {
-    auto t1 = clock::now();
-
-    std::sort(begin, end);
+    {
+        joint::phase_timer timer(joint::phase::sort, size);
 
-    auto t2   = clock::now();
-    auto time = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
-    std::cout << "Sort time: " << time << "ms" << std::endl;
-    RecordProperty("SortTime", time);
+        std::sort(begin, end);
+    }
+    report();
 
     EXPECT_TRUE(std::is_sorted(numbers.begin(), numbers.end()));
 }
 
 TEST_F(TestSortPerformance2, JointIteratorCustomComparatorValueType)
 {
-    auto t1 = clock::now();
-
-    std::sort(begin, end, [](value_type const & a, value_type const & b) { return a.get<0>() < b.get<0>(); });
+    {
+        joint::phase_timer timer(joint::phase::sort, size);
 
-    auto t2   = clock::now();
-    auto time = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
-    std::cout << "Sort time: " << time << "ms" << std::endl;
-    RecordProperty("SortTime", time);
+        std::sort(begin, end, [](value_type const & a, value_type const & b) { return a.get<0>() < b.get<0>(); });
+    }
+    report();
 
     EXPECT_TRUE(std::is_sorted(numbers.begin(), numbers.end()));
 }
 
 TEST_F(TestSortPerformance2, JointIteratorCustomComparatorReference)
 {
-    auto t1 = clock::now();
+    {
+        joint::phase_timer timer(joint::phase::sort, size);
+
+        std::sort(begin, end, [](reference const & a, reference const & b) { return a.get<0>() < b.get<0>(); });
+    }
+    report();
+
+    EXPECT_TRUE(std::is_sorted(numbers.begin(), numbers.end()));
+}
 
-    std::sort(begin, end, [](reference const & a, reference const & b) { return a.get<0>() < b.get<0>(); });
+TEST_F(TestSortPerformance2, JointStableSort)
+{
+    {
+        joint::phase_timer timer(joint::phase::sort, size);
 
-    auto t2   = clock::now();
-    auto time = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
-    std::cout << "Sort time: " << time << "ms" << std::endl;
-    RecordProperty("SortTime", time);
+        joint::stable_sort(begin, end);
+    }
+    report();
 
     EXPECT_TRUE(std::is_sorted(numbers.begin(), numbers.end()));
 }
 
 TEST_F(TestSortPerformance2, VectorOfStructures)
 {
-    auto t1 = clock::now();
+    {
+        joint::phase_timer timer(joint::phase::sort, size);
+
+        struct Aggregate
+        {
+            int         number;
+            long        id;
+        };
+
+        std::vector<Aggregate> aggregates;
+        aggregates.reserve(size);
+
+        for (size_t i = 0; i < size; ++i)
+            aggregates.push_back(Aggregate{numbers[i], longs[i]});
 
+        std::sort(aggregates.begin(), aggregates.end(),
+        [](Aggregate const & a, Aggregate const & b) { return a.number < b.number; });
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            numbers[i] = aggregates[i].number;
+            longs[i] = aggregates[i].id;
+        }
+    }
+    report();
+
+    EXPECT_TRUE(std::is_sorted(numbers.begin(), numbers.end()));
+}
+
+TEST_F(TestSortPerformance2, StridedMembers)
+{
+    // The vector of structures sorted in place through the joint range over its members.
     struct Aggregate
     {
         int         number;
@@ -106,55 +159,113 @@ TEST_F(TestSortPerformance2, VectorOfStructures)
 
     std::vector<Aggregate> aggregates;
     aggregates.reserve(size);
-
     for (size_t i = 0; i < size; ++i)
         aggregates.push_back(Aggregate{numbers[i], longs[i]});
 
-    std::sort(aggregates.begin(), aggregates.end(),
-    [](Aggregate const & a, Aggregate const & b) { return a.number < b.number; });
+    {
+        joint::phase_timer timer(joint::phase::sort, size);
 
+        auto range = joint::make_joint_members(aggregates.data(), aggregates.data() + size, & Aggregate::number,
+                                               & Aggregate::id);
+        joint::sort(range.first, range.second);
+    }
+    report();
+
+    EXPECT_TRUE(std::is_sorted(aggregates.begin(), aggregates.end(),
+                               [](Aggregate const & a, Aggregate const & b) { return a.number < b.number; }));
+}
+
+TEST_F(TestSortPerformance2, HybridTiles)
+{
+    // The keys in a vector and the payload in tiles of 64 rows.
+    joint::aosoa<64, long> payload;
+    payload.reserve(size);
     for (size_t i = 0; i < size; ++i)
+        payload.emplace_back(longs[i]);
+
     {
-        numbers[i] = aggregates[i].number;
-        longs[i] = aggregates[i].id;
+        joint::phase_timer timer(joint::phase::sort, size);
+
+        joint::sort(joint::make_joint(numbers.begin(), payload.get<0>().begin()),
+                    joint::make_joint(numbers.end(), payload.get<0>().end()));
     }
+    report();
 
-    auto t2   = clock::now();
-    auto time = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
-    std::cout << "Sort time: " << time << "ms" << std::endl;
-    RecordProperty("SortTime", time);
+    EXPECT_TRUE(std::is_sorted(numbers.begin(), numbers.end()));
+}
+
+TEST_F(TestSortPerformance2, MaintainedSortUpdates)
+{
+    // A sorted table with 0.1% of its keys updated per tick, sorted again after each tick.
+    auto                       book = joint::maintained_sort(begin, end);
+    std::default_random_engine generator(1);
+    recorder.clear();
+
+    {
+        joint::phase_timer timer(joint::phase::sort, size);
+
+        for (int tick = 0; tick < 10; ++tick)
+        {
+            for (size_t u = 0; u < size / 1000; ++u)
+                book.update(generator() % size).get<0>() = static_cast<int>(generator() % size);
+            book.sorted();
+        }
+    }
+    report();
 
     EXPECT_TRUE(std::is_sorted(numbers.begin(), numbers.end()));
 }
 
 TEST_F(TestSortPerformance2, PermutationVector)
 {
-    auto t1 = clock::now();
+    {
+        joint::phase_timer timer(joint::phase::sort, size);
 
-    std::vector<size_t> permutation(boost::counting_iterator<size_t>(0),
-                                    boost::counting_iterator<size_t>(0) + size);
+        std::vector<size_t> permutation(boost::counting_iterator<size_t>(0),
+                                        boost::counting_iterator<size_t>(0) + size);
 
-    std::sort(permutation.begin(), permutation.end(),
-              [&](size_t a, size_t b) { return numbers[a] < numbers[b]; });
+        std::sort(permutation.begin(), permutation.end(),
+                  [&](size_t a, size_t b) { return numbers[a] < numbers[b]; });
 
-    std::vector<int> numbers;
-    std::vector<long> longs;
-    numbers.reserve(size);
-    longs.reserve(size);
+        std::vector<int> numbers;
+        std::vector<long> longs;
+        numbers.reserve(size);
+        longs.reserve(size);
 
-    for (size_t i = 0; i < size; ++i)
-    {
-        numbers.push_back(this->numbers[permutation[i]]);
-        longs.push_back(this->longs[permutation[i]]);
+        for (size_t i = 0; i < size; ++i)
+        {
+            numbers.push_back(this->numbers[permutation[i]]);
+            longs.push_back(this->longs[permutation[i]]);
+        }
+
+        this->numbers = std::move(numbers);
+        this->longs  = std::move(longs);
     }
+    report();
 
-    this->numbers = std::move(numbers);
-    this->longs  = std::move(longs);
+    EXPECT_TRUE(std::is_sorted(numbers.begin(), numbers.end()));
+}
 
-    auto t2   = clock::now();
-    auto time = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
-    std::cout << "Sort time: " << time << "ms" << std::endl;
-    RecordProperty("SortTime", time);
+TEST_F(TestSortPerformance2, PermutationHugePages)
+{
+    // The same as above with the columns and the scratch buffers of the permutation in the huge pages.
+    joint::huge_page_resource          resource(joint::par);
+    joint::resource_columns<int, long> data(std::vector<int, joint::scratch_allocator<int>>(
+                                                    numbers.begin(), numbers.end(), & resource),
+                                            std::vector<long, joint::scratch_allocator<long>>(
+                                                    longs.begin(), longs.end(), & resource));
+    {
+        joint::phase_timer timer(joint::phase::sort, size);
 
-    EXPECT_TRUE(std::is_sorted(numbers.begin(), numbers.end()));
+        std::vector<size_t> permutation(boost::counting_iterator<size_t>(0),
+                                        boost::counting_iterator<size_t>(0) + size);
+
+        auto keys = data.get<0>().begin();
+        std::sort(permutation.begin(), permutation.end(), [&](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+        joint::permute(data.begin(), data.end(), permutation.begin(), & resource);
+    }
+    report();
+
+    EXPECT_TRUE(std::is_sorted(data.get<0>().begin(), data.get<0>().end()));
 }
@@ -96,3 +96,26 @@ TEST(TestSortTrace, Run)
     std::cout << A::numCopyAssignments << " copy assignments" << std::endl;
     std::cout << A::numMoveAssignments << " move assignments" << std::endl;
 }
+
+TEST(TestSortTrace, ValueFromReference)
+{
+    std::vector<A> vector = {A(2), A(1)};
+
+    auto                         begin = joint::make_joint(vector.begin());
+    typedef decltype(begin)      iterator;
+    typedef iterator::value_type value_type;
+
+    A::numCopyConstructors = 0;
+    A::numMoveConstructors = 0;
+    A::numCopyAssignments  = 0;
+    A::numMoveAssignments  = 0;
+
+    value_type value = * begin;
+
+    // The value is constructed in place from the referenced one (no default construction and assignment).
+    EXPECT_EQ(1u, A::numCopyConstructors);
+    EXPECT_EQ(0u, A::numCopyAssignments);
+    EXPECT_EQ(0u, A::numMoveAssignments);
+    EXPECT_EQ(2, value.get<0>()());
+    EXPECT_EQ(2, vector[0]());
+}
@@ -0,0 +1,161 @@
+//
+// Tests of the sorted ranges.
+//
+
+#include <gtest/gtest.h>
+#include <functional>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "joint_join.hpp"
+#include "joint_sort.hpp"
+#include "joint_sorted_range.hpp"
+
+class TestSortedRange : public ::testing::Test
+{
+    protected:
+        typedef joint::columns<int, std::string> columns;
+
+        // Random keys in [0, range); the strings record the keys and the original positions.
+        columns createRandom(size_t size, int range, unsigned seed = 0)
+        {
+            std::default_random_engine         generator(seed);
+            std::uniform_int_distribution<int> distribution(0, range - 1);
+
+            columns data;
+            for (size_t i = 0; i < size; ++i)
+            {
+                int key = distribution(generator);
+                data.emplace_back(key, std::to_string(key) + ":" + std::to_string(i));
+            }
+            return data;
+        }
+};
+
+TEST_F(TestSortedRange, SortReturnsOrder)
+{
+    auto data   = createRandom(1000, 100);
+    auto sorted = joint::sort(data.begin(), data.end(), std::greater<int>());
+
+    static_assert(std::is_same<decltype(sorted)::order, joint::order_by<0, std::greater<int>>>::value,
+                  "The order is carried by the type.");
+    EXPECT_TRUE(sorted.begin() == data.begin());
+    EXPECT_EQ(data.size(), sorted.size());
+    EXPECT_TRUE(std::is_sorted(sorted.keys(), sorted.keys() + sorted.size(), std::greater<int>()));
+
+    auto stable = joint::stable_sort_by<1>(data.begin(), data.end());
+    static_assert(decltype(stable)::key == 1, "The key column is carried by the type.");
+    EXPECT_TRUE(std::is_sorted(data.get<1>().begin(), data.get<1>().end()));
+}
+
+TEST_F(TestSortedRange, Search)
+{
+    auto data   = createRandom(10000, 500);
+    auto sorted = joint::sort(data.begin(), data.end());
+    auto keys   = data.get<0>();
+
+    for (int key = -1; key <= 500; ++key)
+    {
+        auto lower = std::lower_bound(keys.begin(), keys.end(), key) - keys.begin();
+        auto upper = std::upper_bound(keys.begin(), keys.end(), key) - keys.begin();
+
+        EXPECT_EQ(lower, sorted.lower_bound(key) - data.begin());
+        EXPECT_EQ(upper, sorted.upper_bound(key) - data.begin());
+        EXPECT_EQ(lower != upper, sorted.contains(key));
+
+        auto equal = sorted.equal_range(key);
+        EXPECT_EQ(lower, equal.begin() - data.begin());
+        EXPECT_EQ(upper - lower, static_cast<long>(equal.size()));
+    }
+
+    joint::sorted_range_by<0, joint::less, std::vector<int>::iterator, std::vector<std::string>::iterator> empty(
+            data.begin(), data.begin());
+    EXPECT_FALSE(empty.contains(0));
+    EXPECT_TRUE(empty.lower_bound(0) == data.begin());
+}
+
+TEST_F(TestSortedRange, UniqueAndGroups)
+{
+    auto data   = createRandom(10000, 300);
+    auto sorted = joint::stable_sort(data.begin(), data.end());
+
+    std::vector<int>         group_keys;
+    std::vector<std::string> first_strings;
+    std::size_t              rows = 0;
+    joint::for_each_group(sorted, [&](decltype(sorted) const & group)
+    {
+        for (auto key = group.keys(); key != group.keys() + group.size(); ++key) EXPECT_EQ(* group.keys(), * key);
+        group_keys.push_back(* group.keys());
+        first_strings.push_back(* group.begin().get<1>());
+        rows += group.size();
+    });
+    EXPECT_EQ(data.size(), rows);
+
+    auto unique = joint::unique(sorted);
+    ASSERT_EQ(group_keys.size(), unique.size());
+    EXPECT_TRUE(std::is_sorted(unique.keys(), unique.keys() + unique.size()));
+    for (std::size_t i = 0; i < unique.size(); ++i)
+    {
+        EXPECT_EQ(group_keys[i], data.get<0>()[i]);
+        EXPECT_EQ(first_strings[i], data.get<1>()[i]);
+    }
+}
+
+TEST_F(TestSortedRange, MergeAndJoin)
+{
+    auto left  = createRandom(3000, 1000, 1);
+    auto right = createRandom(2000, 1000, 2);
+
+    auto sorted_left  = joint::sort(left.begin(), left.end());
+    auto sorted_right = joint::sort(right.begin(), right.end());
+
+    auto const left_strings = left.get<1>(), right_strings = right.get<1>();
+
+    columns merged(left.size() + right.size());
+    auto    result = joint::merge(sorted_left, sorted_right, merged.begin());
+    EXPECT_TRUE(result.end() == merged.end());
+    EXPECT_TRUE(std::is_sorted(merged.get<0>().begin(), merged.get<0>().end()));
+
+    // The inputs are copied, not moved from.
+    EXPECT_EQ(left_strings, left.get<1>());
+    EXPECT_EQ(right_strings, right.get<1>());
+    for (std::size_t i = 0; i < merged.size(); ++i)
+        ASSERT_EQ(std::to_string(merged.get<0>()[i]), merged.get<1>()[i].substr(0, merged.get<1>()[i].find(':')));
+
+    joint::columns<std::size_t, std::size_t> expected, indices;
+    joint::merge_join_indices<0, 0>(left.begin(), left.end(), right.begin(), right.end(), expected);
+    joint::merge_join_indices(sorted_left, sorted_right, indices);
+    EXPECT_EQ(expected.get<0>(), indices.get<0>());
+    EXPECT_EQ(expected.get<1>(), indices.get<1>());
+
+    joint::columns<int, std::string, int, std::string> joined;
+    EXPECT_EQ(expected.size(), joint::merge_join(sorted_left, sorted_right, joined));
+    for (std::size_t i = 0; i < joined.size(); ++i)
+    {
+        ASSERT_EQ(joined.get<0>()[i], joined.get<2>()[i]);
+        ASSERT_EQ(std::to_string(joined.get<0>()[i]), joined.get<1>()[i].substr(0, joined.get<1>()[i].find(':')));
+        ASSERT_EQ(std::to_string(joined.get<2>()[i]), joined.get<3>()[i].substr(0, joined.get<3>()[i].find(':')));
+    }
+
+    // Moving the rows leaves the inputs moved-from.
+    columns moved(left.size() + right.size());
+    joint::merge_move(sorted_left, sorted_right, moved.begin());
+    EXPECT_EQ(merged.get<0>(), moved.get<0>());
+    EXPECT_EQ(merged.get<1>(), moved.get<1>());
+}
+
+TEST_F(TestSortedRange, AssumeSorted)
+{
+    std::vector<int>    keys{1, 2, 2, 5, 8};
+    std::vector<double> values{0.1, 0.2, 0.3, 0.4, 0.5};
+
+    auto sorted = joint::assume_sorted(joint::make_joint(keys.begin(), values.begin()),
+                                       joint::make_joint(keys.end(), values.end()));
+
+    EXPECT_EQ(0.2, * sorted.lower_bound(2).get<1>());
+    EXPECT_EQ(0.4, * sorted.upper_bound(2).get<1>());
+    EXPECT_EQ(2u, sorted.equal_range(2).size());
+    EXPECT_FALSE(sorted.contains(3));
+}
@@ -0,0 +1,159 @@
+//
+// Tests of the strided and tiled columns.
+//
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "joint_join.hpp"
+#include "joint_sort.hpp"
+#include "joint_strided.hpp"
+
+namespace
+{
+
+    struct Record
+    {
+        int         key;
+        char        flag;
+        double      value;
+        std::string name;
+    };
+
+}
+
+TEST(TestStrided, StridedIterator)
+{
+    std::vector<Record> records;
+    for (int i = 0; i < 10; ++i) records.push_back(Record{9 - i, 'x', i * 0.5, std::to_string(i)});
+
+    auto keys = joint::member_iterator(records.data(), & Record::key);
+    EXPECT_EQ(9, * keys);
+    EXPECT_EQ(7, keys[2]);
+    EXPECT_EQ(0, * (keys + 9));
+    EXPECT_EQ(9, (keys + 9) - keys);
+    EXPECT_TRUE(keys < keys + 1);
+
+    keys[3] = 42;
+    EXPECT_EQ(42, records[3].key);
+
+    joint::strided_iterator<int const> constant = keys;
+    EXPECT_EQ(42, constant[3]);
+
+    std::sort(keys, keys + 10);
+    for (int i = 0; i < 10; ++i) EXPECT_EQ(i == 9 ? 42 : (i < 6 ? i : i + 1), records[i].key);
+
+    // The blocks of two entries 16 bytes apart.
+    int                                data[] = {0, 1, -1, -1, 2, 3, -1, -1, 4, 5};
+    joint::strided_iterator<int, 2>    blocked(data, 4 * sizeof(int));
+    for (int i = 0; i < 6; ++i) EXPECT_EQ(i, blocked[i]);
+}
+
+TEST(TestStrided, SortMembers)
+{
+    std::default_random_engine generator(0);
+
+    std::vector<Record> records;
+    for (int i = 0; i < 10000; ++i)
+    {
+        int key = static_cast<int>(generator() % 1000);
+        records.push_back(Record{key, 'a', key * 2.0, std::to_string(i)});
+    }
+
+    auto range = joint::make_joint_members(records.data(), records.data() + records.size(), & Record::key,
+                                           & Record::value);
+    EXPECT_EQ(static_cast<long>(records.size()), range.second - range.first);
+
+    joint::sort(range.first, range.second);
+
+    // The keys moved with their values, the other members stayed in place.
+    for (std::size_t i = 0; i < records.size(); ++i)
+    {
+        if (i > 0)
+        {
+            ASSERT_LE(records[i - 1].key, records[i].key);
+        }
+        ASSERT_EQ(records[i].key * 2.0, records[i].value);
+        ASSERT_EQ(std::to_string(i), records[i].name);
+    }
+
+    auto empty = joint::make_joint_members(records.data(), records.data(), & Record::key);
+    EXPECT_TRUE(empty.first == empty.second);
+}
+
+TEST(TestStrided, Tiles)
+{
+    joint::aosoa<4, int, std::string> tiles;
+    EXPECT_TRUE(tiles.empty());
+    EXPECT_TRUE(tiles.begin() == tiles.end());
+
+    for (int i = 0; i < 10; ++i) tiles.emplace_back(i, std::to_string(i));
+    EXPECT_EQ(10u, tiles.size());
+    EXPECT_EQ(3u, tiles.tiles().size());
+    EXPECT_EQ(10, tiles.end() - tiles.begin());
+
+    auto numbers = tiles.get<0>();
+    auto strings = tiles.get<1>();
+    for (int i = 0; i < 10; ++i)
+    {
+        EXPECT_EQ(i, numbers[i]);
+        EXPECT_EQ(std::to_string(i), strings[i]);
+        EXPECT_EQ(i, std::get<0>(tiles.tiles()[i / 4])[i % 4]);
+    }
+    EXPECT_EQ("7", * (tiles.begin() + 7).get<1>());
+
+    // The removed entries are reset, the new ones are default initialized.
+    tiles.resize(5);
+    tiles.resize(7);
+    EXPECT_EQ(4, tiles.get<0>()[4]);
+    EXPECT_EQ(0, tiles.get<0>()[5]);
+    EXPECT_EQ("", tiles.get<1>()[6]);
+
+    joint::aosoa<4, int, std::string> const & constant = tiles;
+    EXPECT_EQ("4", constant.get<1>()[4]);
+    EXPECT_EQ(7, constant.end() - constant.begin());
+
+    tiles.clear();
+    EXPECT_TRUE(tiles.empty());
+}
+
+TEST(TestStrided, HybridLayout)
+{
+    // The hot keys packed in a vector, the cold payload in tiles.
+    std::default_random_engine     generator(1);
+    std::size_t const              n = 100000;
+    std::vector<int>               keys;
+    joint::aosoa<64, long, double> payload;
+    payload.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        keys.push_back(static_cast<int>(generator() % 100000));
+        payload.emplace_back(keys.back() * 3L, keys.back() * 0.5);
+    }
+
+    auto begin = joint::make_joint(keys.begin(), payload.get<0>().begin(), payload.get<1>().begin());
+    auto end   = joint::make_joint(keys.end(), payload.get<0>().end(), payload.get<1>().end());
+
+    joint::sort(begin, end);
+
+    EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        ASSERT_EQ(keys[i] * 3L, payload.get<0>()[i]);
+        ASSERT_EQ(keys[i] * 0.5, payload.get<1>()[i]);
+    }
+
+    // The tiled rows take part in the joins as well.
+    joint::columns<int, long, double, int> joined;
+    joint::hash_join<0, 0>(begin, begin + 1000, joint::make_joint(keys.begin() + 500),
+                           joint::make_joint(keys.begin() + 1500), joined);
+    EXPECT_LE(1u, joined.size());
+    for (std::size_t i = 0; i < joined.size(); ++i)
+    {
+        ASSERT_EQ(joined.get<0>()[i], joined.get<3>()[i]);
+        ASSERT_EQ(joined.get<0>()[i] * 3L, joined.get<1>()[i]);
+    }
+}
@@ -0,0 +1,89 @@
+//
+// Tests of the element-wise algorithms on joint ranges.
+//
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <numeric>
+#include <vector>
+
+#include "joint_transform.hpp"
+
+class TestTransform : public ::testing::Test
+{
+    protected:
+        static size_t const size = 100000;
+
+        std::vector<long>   a;
+        std::vector<long>   b;
+        std::deque<double>  c;
+
+        virtual void SetUp()
+        {
+            for (size_t i = 0; i < size; ++i)
+            {
+                a.push_back(static_cast<long>(i));
+                b.push_back(static_cast<long>(i % 7));
+                c.push_back(0.0);
+            }
+        }
+};
+
+TEST_F(TestTransform, ForEach)
+{
+    auto first = joint::make_joint(a.begin(), b.begin(), c.begin());
+    auto last  = joint::make_joint(a.end(), b.end(), c.end());
+    typedef joint::row_of<decltype(first)>::type row;
+
+    joint::for_each_row(first, last, [](row r) { r.get<2>() = static_cast<double>(r.get<0>() * r.get<1>()); });
+    for (size_t i = 0; i < size; ++i) EXPECT_EQ(static_cast<double>(a[i] * b[i]), c[i]);
+
+    joint::for_each_row(joint::seq, first, last, [](row r) { r.get<1>() += 1; });
+    for (size_t i = 0; i < size; ++i) EXPECT_EQ(static_cast<long>(i % 7 + 1), b[i]);
+}
+
+TEST_F(TestTransform, Transform)
+{
+    auto first = joint::make_joint(a.begin(), b.begin());
+    auto last  = joint::make_joint(a.end(), b.end());
+    typedef joint::row_of<decltype(first)>::type row;
+
+    std::vector<long> output(size);
+    auto end = joint::transform_rows(first, last, output.begin(), [](row r) { return r.get<0>() + 2 * r.get<1>(); });
+
+    EXPECT_TRUE(end == output.end());
+    for (size_t i = 0; i < size; ++i) EXPECT_EQ(a[i] + 2 * b[i], output[i]);
+}
+
+TEST_F(TestTransform, TransformReduce)
+{
+    auto first = joint::make_joint(a.begin(), b.begin());
+    auto last  = joint::make_joint(a.end(), b.end());
+    typedef joint::row_of<decltype(first)>::type row;
+
+    long expected = std::inner_product(a.begin(), a.end(), b.begin(), 10L);
+    auto product  = [](row r) { return r.get<0>() * r.get<1>(); };
+
+    EXPECT_EQ(expected, joint::transform_reduce_rows(first, last, 10L, std::plus<long>(), product));
+    EXPECT_EQ(expected, joint::transform_reduce_rows(joint::seq, first, last, 10L, std::plus<long>(), product));
+    EXPECT_EQ(10L, joint::transform_reduce_rows(first, first, 10L, std::plus<long>(), product));
+}
+
+TEST_F(TestTransform, StandardAlgorithms)
+{
+    using namespace std;
+
+    auto first = joint::make_joint(a.begin(), b.begin());
+    auto last  = joint::make_joint(a.end(), b.end());
+
+    // The unqualified calls on joint ranges (found by the argument dependent lookup) are the standard algorithms.
+    long sum = 0;
+    for_each(first, last, [&sum](decltype(* first) r) { sum += r.get<0>() * r.get<1>(); });
+    EXPECT_EQ(std::inner_product(a.begin(), a.end(), b.begin(), 0L), sum);
+
+    std::vector<long> output(size);
+    transform(first, last, output.begin(), [](decltype(* first) r) { return r.get<0>() - r.get<1>(); });
+    for (size_t i = 0; i < size; ++i) EXPECT_EQ(a[i] - b[i], output[i]);
+}